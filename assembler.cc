@@ -0,0 +1,340 @@
+/********************************************************************************************//**
+ * @file assembler.cc
+ *
+ * class Assembler implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include "assembler.h"
+
+using namespace std;
+
+/********************************************************************************************//**
+ * @param	a	A string
+ * @param	b	Another string
+ * @return	true if a and b are equal, ignoring case
+ ************************************************************************************************/
+static bool sameName(const string& a, const string& b) {
+	if (a.size() != b.size())
+		return false;
+
+	for (size_t i = 0; i < a.size(); ++i)
+		if (tolower(a[i]) != tolower(b[i]))
+			return false;
+
+	return true;
+}
+
+/********************************************************************************************//**
+ * Split text into tokens; words, character literals, and the punctuation ':' and ','. Comments,
+ * from '#' or ';' to the end of the line, are dropped.
+ *
+ * @param	text	A source line
+ * @return	text's tokens
+ ************************************************************************************************/
+static vector<string> tokenize(const string& text) {
+	vector<string> tokens;
+
+	for (size_t i = 0; i < text.size(); ) {
+		const char c = text[i];
+		if (isspace(c))
+			++i;
+
+		else if (c == '#' || c == ';')
+			break;
+
+		else if (c == ':' || c == ',')
+			tokens.push_back(string(1, text[i++]));
+
+		else if (c == '\'') {					// 'c', or an escape, e.g., '\''
+			const size_t end = text.find('\'', i + (i + 1 < text.size() && text[i + 1] == '\\' ? 3 : 1));
+			const size_t n = end == string::npos ? text.size() - i : end - i + 1;
+			tokens.push_back(text.substr(i, n));
+			i += n;
+
+		} else {
+			size_t n = 0;
+			while (i + n < text.size() && !isspace(text[i + n]) && !strchr(":,#;'", text[i + n]))
+				++n;
+			tokens.push_back(text.substr(i, n));
+			i += n;
+		}
+	}
+
+	return tokens;
+}
+
+/********************************************************************************************//**
+ * @param	name	A mnemonic
+ * @param	op		The opcode, if found
+ * @return	true if name is a valid mnemonic
+ ************************************************************************************************/
+static bool mnemonic(const string& name, OpCode& op) {
+	for (unsigned n = 0; n <= ordinal(OpCode::HALT); ++n)
+		if (sameName(OpCodeInfo::info(static_cast<OpCode>(n)).name(), name)) {
+			op = static_cast<OpCode>(n);
+			return true;
+		}
+
+	return false;
+}
+
+/********************************************************************************************//**
+ * @param	text	A token
+ * @return	true if text is a identifier
+ ************************************************************************************************/
+static bool identifier(const string& text) {
+	if (text.empty() || !(isalpha(text[0]) || text[0] == '_'))
+		return false;
+
+	for (auto c : text)
+		if (!isalnum(c) && c != '_')
+			return false;
+
+	return true;
+}
+
+// private
+
+/********************************************************************************************//**
+ * Write a diagnostic on standard error output, incrementing the error count.
+ * @param msg The error message
+ ************************************************************************************************/
+void Assembler::error(const string& msg) {
+	cerr << fName << ": " << msg << " near line " << lineNum << endl;
+	++nErrors;
+}
+
+/********************************************************************************************//**
+ * @param		text	The operand
+ * @param[out]	value	The operands value, if a constant
+ * @param[out]	label	The label name, if text is a label reference, otherwise empty
+ * @return	false if text isn't a valid operand
+ ************************************************************************************************/
+bool Assembler::operand(const string& text, Datum& value, string& label) {
+	label.clear();
+
+	if (text.size() == 3 && text[0] == '\'' && text[2] == '\'')
+		value = Datum(text[1]);
+
+	else if (text.size() >= 4 && text[0] == '\'' && text[1] == '\\' && text.back() == '\'') {
+		const string esc = text.substr(2, text.size() - 3);	// As written by Datum's operator<<
+		if (esc == "0")				value = Datum('\0');
+		else if (esc == "t")		value = Datum('\t');
+		else if (esc == "n")		value = Datum('\n');
+		else if (esc == "r")		value = Datum('\r');
+		else if (esc == "\\")		value = Datum('\\');
+		else if (esc == "'")		value = Datum('\'');
+		else if (esc.size() == 3 && esc[0] == 'x' && isxdigit(esc[1]) && isxdigit(esc[2]))
+			value = Datum(static_cast<char>(strtoul(esc.c_str() + 1, nullptr, 16)));
+		else
+			return false;
+	}
+
+	else if (text == "true" || text == "false")
+		value = Datum(text == "true");
+
+	else if (identifier(text))
+		label = text;
+
+	else {
+		char* end = nullptr;
+		const long long n = strtoll(text.c_str(), &end, 10);
+		if (end != text.c_str() && *end == '\0' && n >= INT_MIN && n <= INT_MAX)
+			value = Datum(static_cast<int>(n));
+
+		else if (end != text.c_str() && *end == '\0')
+			value = Datum(static_cast<int64_t>(n));
+
+		else {
+			const double d = strtod(text.c_str(), &end);
+			if (end == text.c_str() || *end != '\0')
+				return false;
+			value = Datum(d);
+		}
+	}
+
+	return true;
+}
+
+/********************************************************************************************//**
+ * @param	text	The line to assemble
+ ************************************************************************************************/
+void Assembler::line(const string& text) {
+	const vector<string> tokens = tokenize(text);
+	size_t i = 0;
+
+	// Leading address, and label, prefixes
+	while (i + 1 < tokens.size() && tokens[i + 1] == ":") {
+		if (identifier(tokens[i])) {
+			if (labels.find(tokens[i]) != labels.end())
+				error("label redefined '" + tokens[i] + "'");
+			labels[tokens[i]] = instrs.size();
+
+		} else if (!isdigit(tokens[i][0])) {
+			error("expected a label or address, got '" + tokens[i] + "'");
+			return;
+		}
+		i += 2;
+	}
+
+	if (i == tokens.size())
+		return;									// Nothing else on the line
+
+	if (tokens[i] == ".global") {
+		if (i + 2 != tokens.size() || !identifier(tokens[i + 1]))
+			error("expected .global name");
+		else
+			globals[tokens[i + 1]] = lineNum;
+		return;
+	}
+
+	OpCode op;
+	if (!mnemonic(tokens[i], op)) {
+		error("unknown mnemonic '" + tokens[i] + "'");
+		return;
+	}
+	++i;
+
+	Instr instr(op);
+	string label;
+	switch (nOperands(op)) {
+	case 2:
+		if (i + 2 >= tokens.size() || tokens[i + 1] != "," || !isdigit(tokens[i].back())) {
+			error("expected level, operand");
+			return;
+		}
+		instr.level = static_cast<int8_t>(atoi(tokens[i].c_str()));
+		i += 2;
+		// fall through...
+
+	case 1:
+		if (i >= tokens.size() || !operand(tokens[i], instr.value, label)) {
+			error("expected an operand for '" + OpCodeInfo::info(op).name() + "'");
+			return;
+		}
+		++i;
+		break;
+
+	default:
+		break;
+	}
+
+	if (i != tokens.size())
+		error("unexpected '" + tokens[i] + "'");
+
+	if (!label.empty())
+		refs[instrs.size()] = make_pair(label, lineNum);
+	instrs.push_back(instr);
+}
+
+// public
+
+/********************************************************************************************//**
+ ************************************************************************************************/
+Assembler::Assembler() : lineNum{0}, nErrors{0} {
+}
+
+/********************************************************************************************//**
+ * @param	name	The source file name
+ * @return	The number of errors
+ ************************************************************************************************/
+unsigned Assembler::operator()(const string& name) {
+	fName = name;
+	lineNum = nErrors = 0;
+	instrs.clear();
+	labels.clear();
+	refs.clear();
+	globals.clear();
+
+	ifstream source(fName);
+	if (!source.is_open()) {
+		cerr << fName << ": can't open source file\n";
+		return ++nErrors;
+	}
+
+	string text;
+	while (getline(source, text)) {
+		++lineNum;
+		line(text);
+	}
+
+	for (const auto& global : globals)
+		if (labels.find(global.first) == labels.end()) {
+			lineNum = global.second;
+			error("undefined global '" + global.first + "'");
+		}
+
+	return nErrors;
+}
+
+/********************************************************************************************//**
+ * Append the assembled code onto prog, resolving label references, and patch the entry point of
+ * each subroutine with the name of a global with a jump to the global. The global takes the
+ * subroutine's name, so that later files link to the global.
+ *
+ * @param	prog	The program to link into; may be empty
+ * @param	subrs	prog's subroutine names, by entry point. The globals are added.
+ * @return	The number of errors
+ ************************************************************************************************/
+unsigned Assembler::link(InstrVector& prog, SubrMap& subrs) {
+	const size_t base = prog.size();
+
+	// Find the single subroutine named name, returning subrs.end() if there's none, or more
+	const auto find = [&subrs](const string& name) {
+		auto found = subrs.end();
+		for (auto it = subrs.begin(); it != subrs.end(); ++it)
+			if (it->second == name) {
+				if (found != subrs.end())
+					return subrs.end();
+				found = it;
+			}
+		return found;
+	};
+
+	for (size_t addr = 0; addr < instrs.size(); ++addr) {
+		Instr instr = instrs[addr];
+
+		const auto ref = refs.find(addr);
+		if (ref != refs.end()) {
+			const string& label = ref->second.first;
+			lineNum = ref->second.second;
+
+			const auto local = labels.find(label);
+			const auto subr = find(label);
+			if (local != labels.end())
+				instr.value = Datum(base + local->second);
+			else if (subr != subrs.end())
+				instr.value = Datum(subr->first);
+			else
+				error("undefined, or ambiguous, label '" + label + "'");
+		}
+
+		prog.push_back(instr);
+	}
+
+	for (const auto& global : globals) {
+		const size_t entry = base + labels[global.first];
+		const auto subr = find(global.first);
+		lineNum = global.second;
+
+		if (subr != subrs.end()) {				// The stub no longer carries the name
+			prog[subr->first] = Instr(OpCode::JUMPI, 0, Datum(entry));
+			subrs.erase(subr);
+
+		} else if (base != 0)
+			error("no single subroutine to replace with '" + global.first + "'");
+
+		subrs[entry] = global.first;
+	}
+
+	return nErrors;
+}
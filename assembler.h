@@ -0,0 +1,72 @@
+/********************************************************************************************//**
+ * @file assembler.h
+ *
+ * A P machine assembler and linker.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	ASSEMBLER_H
+#define ASSEMBLER_H
+
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "instr.h"
+
+/********************************************************************************************//**
+ * A P Machine Assembler
+ *
+ * Reads the disasm() listing syntax, with labels in place of numeric code addresses, one
+ * instruction per line:
+ *
+ *     [ address ':' ] [ label ':' ] [ mnemonic [ [ level ',' ] operand ] ] [ comment ]
+ *
+ * where a leading address, as written by disasm(), is ignored, and comments start with '#' or
+ * ';'. Operands are integers, reals, characters ('c'), true or false, or a label, which yields
+ * its code address. A label that isn't defined in the file is looked up, by name, in the
+ * subroutines of the program being linked to.
+ *
+ * The directive ".global name" makes label name a linkable routine. Linking appends the
+ * assembled code to a program, relocating it, and replaces each subroutine of the same name,
+ * by patching its entry point with a jump to the assembled routine. Thus a hot routine can be
+ * written in P, and then hand-tuned in P machine code.
+ *
+ * Errors are written on standard error output, in the same form as the compiler's.
+ ************************************************************************************************/
+class Assembler {
+public:
+	Assembler();
+	virtual ~Assembler() {}
+
+	/// Assemble a source file...
+	unsigned operator()(const std::string& fName);
+
+	/// Link the assembled code into a program...
+	unsigned link(InstrVector& prog, SubrMap& subrs);
+
+	const InstrVector& code() const			{	return instrs;	}	///< Return the assembled code
+
+private:
+	/// Code addresses, by label name
+	typedef std::map<std::string, size_t> LabelMap;
+
+	/// A reference to a label; its name, and source line number
+	typedef std::pair<std::string, unsigned> LabelRef;
+
+	std::string			fName;				///< Source file name, for error messages
+	unsigned			lineNum;			///< Current source line number
+	unsigned			nErrors;			///< Number of errors
+	InstrVector			instrs;				///< Assembled code
+	LabelMap			labels;				///< Label addresses
+	std::map<size_t, LabelRef> refs;		///< Label references, by instruction address
+	std::map<std::string, unsigned> globals;	///< Global names, and the line they were declared on
+
+	void error(const std::string& msg);		///< Write an error message
+	void line(const std::string& text);		///< Assemble a single line
+	bool operand(const std::string& text, Datum& value, std::string& label);
+};
+
+#endif
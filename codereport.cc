@@ -0,0 +1,298 @@
+/********************************************************************************************//**
+ * @file codereport.cc
+ *
+ * class CodeReport implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+
+#include "codereport.h"
+#include "external.h"
+
+using namespace std;
+
+/********************************************************************************************//**
+ * class CodeReport
+ ************************************************************************************************/
+
+// private static
+
+const char* const CodeReport::names[NCategories] = {
+	"load", "store", "arith", "cmp", "logic", "branch", "call", "check", "io", "heap", "nop", "other"
+};
+
+/********************************************************************************************//**
+ * @param	op	An operation code
+ * @return	op's category
+ ************************************************************************************************/
+CodeReport::Category CodeReport::category(OpCode op) {
+	switch (op) {
+	case OpCode::PUSH:		case OpCode::PUSHVAR:	case OpCode::EVAL:		case OpCode::DUP:
+	case OpCode::POP:
+		return Load;
+
+	case OpCode::ASSIGN:	case OpCode::COPY:
+		return Store;
+
+	case OpCode::NEG:		case OpCode::ITOR:		case OpCode::ITOR2:		case OpCode::ITOL:
+	case OpCode::ITOL2:		case OpCode::LTOI:		case OpCode::ROUND:		case OpCode::TRUNC:
+	case OpCode::ABS:		case OpCode::ATAN:		case OpCode::EXP:		case OpCode::LOG:
+	case OpCode::ODD:		case OpCode::PRED:		case OpCode::SUCC:		case OpCode::SIN:
+	case OpCode::SQR:		case OpCode::SQRT:		case OpCode::ADD:		case OpCode::SUB:
+	case OpCode::MUL:		case OpCode::DIV:		case OpCode::REM:
+		return Arith;
+
+	case OpCode::LT:		case OpCode::LTE:		case OpCode::EQU:		case OpCode::GTE:
+	case OpCode::GT:		case OpCode::NEQ:
+		return Compare;
+
+	case OpCode::BNOT:		case OpCode::BAND:		case OpCode::BOR:		case OpCode::BXOR:
+	case OpCode::SHIFTL:	case OpCode::SHIFTR:	case OpCode::OR:		case OpCode::AND:
+	case OpCode::NOT:
+		return Logic;
+
+	case OpCode::JUMP:		case OpCode::JUMPI:		case OpCode::JNEQ:		case OpCode::JNEQI:
+	case OpCode::FORPREP:	case OpCode::FORLOOP:
+		return Branch;
+
+	case OpCode::CALL:		case OpCode::CALLI:		case OpCode::CALLX:		case OpCode::ENTER:
+	case OpCode::RET:		case OpCode::RETF:
+		return Call;
+
+	case OpCode::LLIMIT:	case OpCode::ULIMIT:
+		return Check;
+
+	case OpCode::GET:		case OpCode::GETLN:		case OpCode::PUT:		case OpCode::PUTLN:
+	case OpCode::PUTS:		case OpCode::PUTSLN:
+		return IO;
+
+	case OpCode::NEW:		case OpCode::DISPOSE:
+		return Heap;
+
+	case OpCode::NOP:
+		return Nop;
+
+	default:
+		return Other;
+	}
+}
+
+/********************************************************************************************//**
+ * @param	code	The program
+ * @param	entry	The subroutine's entry point
+ * @param	end		The subroutine's end
+ *
+ * @return	The size of the subroutine's parameters, and of its result, in Datums; the operand
+ *			of its first RET, or RETF, and 1 if that's a RETF
+ ************************************************************************************************/
+pair<unsigned, unsigned> CodeReport::signature(const InstrVector& code, size_t entry, size_t end) {
+	for (size_t pc = entry; pc < end && pc < code.size(); ++pc)
+		if (code[pc].op == OpCode::RET || code[pc].op == OpCode::RETF)
+			return { code[pc].value.natural(), code[pc].op == OpCode::RETF ? 1 : 0 };
+
+	return { 0, 0 };
+}
+
+/********************************************************************************************//**
+ * Each path is followed from the entry point, tracking the stack as a list of slots, each
+ * either an integer constant, pushed by PUSH, or unknown; PUT, and PUTLN, pop the number of
+ * Datums pushed by the constant below the width, and precision. Every instruction is visited
+ * once, with the stack of the first path to reach it; the compiler leaves the stack at the same
+ * depth on every path to a join.
+ *
+ * @param	code	The program
+ * @param	subrs	Subroutine names, by entry point
+ * @param	entry	The subroutine's entry point
+ * @param	end		The subroutine's end
+ *
+ * @return	The greatest depth of the expression stack, in Datums
+ ************************************************************************************************/
+unsigned CodeReport::depth(const InstrVector& code, const SubrMap& subrs, size_t entry, size_t end) {
+	const int Unknown = -1;					// A slot that isn't a known constant count
+	typedef vector<int> Stack;				// Known, non-negative, constants, or Unknown
+
+	vector<bool> visited(end - entry, false);
+	vector<pair<size_t, Stack>> work { { entry, Stack() } };
+	size_t deepest = 0;
+
+	// Pop n slots, if there are that many
+	auto pop = [](Stack& stack, size_t n) {	stack.resize(stack.size() > n ? stack.size() - n : 0);	};
+
+	// Continue at pc with stack, if it's in the subroutine, and not already visited
+	auto branch = [&](size_t pc, const Stack& stack) {
+		if (pc >= entry && pc < end && !visited[pc - entry])
+			work.push_back({ pc, stack });
+	};
+
+	while (!work.empty()) {
+		size_t pc = work.back().first;
+		Stack stack = move(work.back().second);
+		work.pop_back();
+
+		for (bool next = true; next && pc < end && !visited[pc - entry]; ++pc) {
+			visited[pc - entry] = true;
+			const Instr& instr = code[pc];
+			const bool count = instr.value.kind() == Datum::Integer && instr.value.integer() >= 0;
+			const unsigned n = count ? instr.value.integer() : 0;
+
+			switch (instr.op) {
+			case OpCode::PUSH:
+				stack.push_back(count ? n : Unknown);
+				break;
+
+			case OpCode::PUSHVAR:	stack.push_back(Unknown);				break;
+			case OpCode::DUP:		stack.push_back(Unknown);				break;
+			case OpCode::EVAL:		pop(stack, 1);	stack.resize(stack.size() + n, Unknown);	break;
+			case OpCode::ASSIGN:	pop(stack, n + 1);						break;
+			case OpCode::POP:		pop(stack, n);							break;
+			case OpCode::COPY:		pop(stack, 2);							break;
+			case OpCode::GET:		pop(stack, 2);							break;
+			case OpCode::DISPOSE:	pop(stack, 1);							break;
+			case OpCode::ITOR2:
+			case OpCode::ITOL2:		pop(stack, 2);	stack.resize(stack.size() + 2, Unknown);	break;
+
+			case OpCode::PUT:
+			case OpCode::PUTLN: {					// (values, n, width, precision)
+				const int count = stack.size() >= 3 ? stack[stack.size() - 3] : Unknown;
+				pop(stack, 3 + (count == Unknown ? 1 : count));
+				break;
+			}
+
+			case OpCode::CALL:						// The entry point isn't known
+				pop(stack, 2);
+				break;
+
+			case OpCode::CALLI: {
+				const size_t callee = instr.value.natural();
+				const auto following = subrs.upper_bound(callee);
+				const auto sig = signature(code, callee,
+					following == subrs.end() ? code.size() : following->first);
+				pop(stack, sig.first);
+				stack.resize(stack.size() + sig.second, Unknown);
+				break;
+			}
+
+			case OpCode::CALLX:
+				if (instr.value.natural() < External::size()) {
+					const External& ext = External::at(instr.value.natural());
+					pop(stack, ext.stackSize());
+					if (ext.function())
+						stack.push_back(Unknown);
+				}
+				break;
+
+			case OpCode::JUMP:		next = false;							break;
+			case OpCode::JUMPI:		branch(instr.value.natural(), stack);	next = false;	break;
+			case OpCode::JNEQ:		next = false;							break;
+
+			case OpCode::JNEQI:
+				pop(stack, 1);
+				branch(instr.value.natural(), stack);
+				break;
+
+			case OpCode::FORPREP:					// (addr, first, limit)
+				pop(stack, 3);
+				branch(instr.value.natural(), stack);
+				stack.resize(stack.size() + 2, Unknown);
+				break;
+
+			case OpCode::FORLOOP:					// (addr, limit)
+				branch(instr.value.natural(), stack);
+				pop(stack, 2);
+				break;
+
+			case OpCode::RET:
+			case OpCode::RETF:
+			case OpCode::HALT:		next = false;							break;
+
+			case OpCode::ENTER:
+			case OpCode::LLIMIT:
+			case OpCode::ULIMIT:
+			case OpCode::PUTS:
+			case OpCode::PUTSLN:
+			case OpCode::GETLN:
+			case OpCode::NOP:
+			case OpCode::READY:
+			case OpCode::BREAK:												break;
+
+			default:								// Unary, and binary, operators
+				pop(stack, OpCodeInfo::info(instr.op).nElements());
+				stack.push_back(Unknown);
+			}
+
+			deepest = max(deepest, stack.size());
+		}
+	}
+
+	return deepest;
+}
+
+// public
+
+/********************************************************************************************//**
+ * @param	code	The program
+ * @param	subrs	Subroutine names, by entry point
+ ************************************************************************************************/
+CodeReport::CodeReport(const InstrVector& code, const SubrMap& subrs) : total{code.size()} {
+	fill(begin(totals), end(totals), 0);
+	for (const auto& instr : code)
+		++totals[category(instr.op)];
+
+	for (auto it = subrs.begin(); it != subrs.end(); ++it) {
+		const auto following = next(it);
+		const size_t entry = it->first;
+		const size_t last = min(following == subrs.end() ? code.size() : following->first, code.size());
+
+		Subr subr;
+		subr.name = it->second;
+		subr.entry = entry;
+		subr.size = last > entry ? last - entry : 0;
+		fill(begin(subr.mix), end(subr.mix), 0);
+		for (size_t pc = entry; pc < last; ++pc)
+			++subr.mix[category(code[pc].op)];
+
+		subr.params = signature(code, entry, last).first;
+		subr.locals = entry < last && code[entry].op == OpCode::ENTER ? code[entry].value.natural() : 0;
+		subr.depth = entry < last ? depth(code, subrs, entry, last) : 0;
+		routines.push_back(subr);
+	}
+}
+
+/********************************************************************************************//**
+ * Subroutines are listed largest first, followed by the totals for the whole program, which
+ * includes the code that calls the program block.
+ *
+ * @param	out		Where to write the report
+ * @param	source	The program's source file name
+ ************************************************************************************************/
+void CodeReport::report(ostream& out, const string& source) const {
+	out << "# code report: " << source << ", " << total << " instructions in "
+		<< routines.size() << " subroutines\n"
+		<< "#\n"
+		<< "#" << setw(7) << "size" << setw(7) << "params" << setw(7) << "locals" << setw(6) << "depth";
+	for (auto name : names)
+		out << setw(7) << name;
+	out << "  subroutine\n";
+
+	vector<Subr> bySize(routines);
+	stable_sort(bySize.begin(), bySize.end(),
+		[](const Subr& lhs, const Subr& rhs) { return lhs.size > rhs.size; });
+
+	for (const auto& subr : bySize) {
+		out << setw(8) << subr.size << setw(7) << subr.params << setw(7) << subr.locals
+			<< setw(6) << subr.depth;
+		for (auto n : subr.mix)
+			out << setw(7) << n;
+		out << "  " << subr.name << "\n";
+	}
+
+	out << setw(8) << total << setw(7) << "-" << setw(7) << "-" << setw(6) << "-";
+	for (auto n : totals)
+		out << setw(7) << n;
+	out << "  total\n";
+}
@@ -0,0 +1,95 @@
+/********************************************************************************************//**
+ * @file codereport.h
+ *
+ * Static code size, and instruction mix, report for P machine programs.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	CODEREPORT_H
+#define CODEREPORT_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "instr.h"
+
+/********************************************************************************************//**
+ * A Static Code Report
+ *
+ * Describes the code generated for each subroutine, without running it; its size, instruction
+ * mix, by category, the number of run-time limit checks, the sizes of its parameters, and local
+ * variables, and the greatest depth of its expression stack.
+ *
+ * Subroutines are contiguous; each runs from its entry point to the next. The local variables'
+ * size is the operand of the ENTER at the entry point, if any, i.e., the variables, as
+ * allocated by the compiler, plus any objects allocated in the frame. The parameters' size is
+ * the operand of the subroutine's RET, or RETF.
+ *
+ * The stack depth is found by following every path through the subroutine, from its entry
+ * point, tracking what each instruction pops, and pushes. It's measured in Datums above the
+ * local variables, including statement temporaries, and arguments pushed for calls, but not the
+ * activation frames of the subroutines called.
+ ************************************************************************************************/
+class CodeReport {
+public:
+	/// Analyze a program's code...
+	CodeReport(const InstrVector& code, const SubrMap& subrs);
+	virtual ~CodeReport() {}
+
+	/// Write the report...
+	void report(std::ostream& out, const std::string& source) const;
+
+private:
+	/// Instruction categories
+	enum Category {
+		Load,								///< Push constants, and variables
+		Store,								///< Assign, and copy, variables
+		Arith,								///< Arithmetic, and conversions
+		Compare,							///< Comparisons
+		Logic,								///< Logical, and bitwise, operations
+		Branch,								///< Jumps, and loops
+		Call,								///< Calls, returns, and frame allocation
+		Check,								///< Run-time limit checks
+		IO,									///< Input, and output
+		Heap,								///< New, and dispose
+		Nop,								///< Elided instructions
+		Other,								///< Everything else, e.g., halt
+		NCategories							///< Number of categories
+	};
+
+	/// A subroutine's description
+	struct Subr {
+		std::string	name;					///< The subroutine's name
+		size_t		entry;					///< Entry point
+		size_t		size;					///< Number of instructions
+		unsigned	mix[NCategories];		///< Instructions, by category
+		unsigned	params;					///< Parameters' size, in Datums
+		unsigned	locals;					///< Local variables' size, in Datums
+		unsigned	depth;					///< Greatest expression stack depth, in Datums
+	};
+
+	static const char* const names[NCategories];	///< Category column headings
+
+	std::vector<Subr>	routines;			///< Each subroutine, in address order
+	size_t				total;				///< Number of instructions in the program
+	unsigned			totals[NCategories];	///< All instructions, by category
+
+	/// Return op's category
+	static Category category(OpCode op);
+
+	/// Return the number of parameters, and the function result, of the subroutine at entry...
+	static std::pair<unsigned, unsigned> signature(	const	InstrVector&	code,
+															size_t			entry,
+															size_t			end);
+
+	/// Return the greatest expression stack depth of [entry, end)...
+	static unsigned depth(	const	InstrVector&	code,
+							const	SubrMap&		subrs,
+									size_t			entry,
+									size_t			end);
+};
+
+#endif
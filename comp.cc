@@ -8,8 +8,10 @@
  ************************************************************************************************/
 
 #include "comp.h"
+#include "external.h"
 #include "interp.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iomanip>
 #include <iostream>
@@ -27,6 +29,363 @@ using namespace rel_ops;
 
 // private:
 
+/********************************************************************************************//**
+ * Note a performance warning at the current source line, if performance warnings are enabled,
+ * and it hasn't already been noted on this line.
+ *
+ * @param	pc		Address of the first instruction concerned
+ * @param	msg		The warning, including its estimated cost
+ ************************************************************************************************/
+void PComp::perfNote(size_t pc, const string& msg) {
+	if (!perfWarn)
+		return;
+
+	for (const auto& note : perfNotes)
+		if (note.line == ts.lineNum && note.msg == msg)
+			return;
+
+	perfNotes.push_back({ ts.lineNum, pc, msg });
+}
+
+/********************************************************************************************//**
+ * Write the performance warnings, in source line order, on standard error output. Warnings
+ * aren't errors; they don't prevent the program from running.
+ ************************************************************************************************/
+void PComp::perfReport() {
+	stable_sort(perfNotes.begin(), perfNotes.end(),
+		[](const PerfNote& a, const PerfNote& b) { return a.line < b.line; });
+
+	for (const auto& note : perfNotes)
+		cerr << progName << ": performance: " << note.msg << " near line " << note.line << endl;
+}
+
+/********************************************************************************************//**
+ * Interprocedural constant, and range, propagation.
+ *
+ * A whole program pass over the emitted code. A scalar value parameter that the subroutine only
+ * reads has, on entry, one of the values passed at its call sites; a constant if every site
+ * passes the same integer constant, or else within the parameter's range, as checked by each
+ * caller. Each subroutine is specialized, in place, for what's true at all of its call sites.
+ * If the call sites pass differing constants, small subroutines are also cloned, for the most
+ * common combinations, and specialized for those constants; the sites are retargeted to the
+ * clones. Clones that don't save at least CloneSavings instructions are discarded.
+ *
+ * Specialization replaces parameter reads with constants, and removes limit checks the ranges
+ * satisfy, and then folds the resulting constant arithmetic, and checks. Instructions are
+ * replaced with NOPs, so that no code moves.
+ ************************************************************************************************/
+void PComp::propagate() {
+	map<size_t, vector<const CallSite*>> callers;	// Call sites, by subroutine entry point
+	for (const auto& site : callSites)
+		callers[(*code)[site.pc].value.natural()].push_back(&site);
+
+	for (const auto& callee : callers) {
+		const size_t entry = callee.first;
+		const size_t end = subrEnd(entry);
+		const auto& sites = callee.second;
+		const auto& args = sites.front()->args;	// Every site passes the same kinds
+
+		ParamFacts facts;						// True at every call site
+		vector<size_t> varying;					// Constant at some sites, but not all the same
+		for (size_t k = 0; k < args.size(); ++k) {
+			if (paramWritten(entry, end, args[k].offset))
+				continue;
+
+			bool constant = true, some = false;
+			int lo = args[k].value, hi = args[k].value;
+			for (const auto site : sites) {
+				const CallArg& arg = site->args[k];
+				constant = constant && arg.constant;
+				some = some || arg.constant;
+				lo = min(lo, arg.value);
+				hi = max(hi, arg.value);
+			}
+
+			if (constant)
+				facts[args[k].offset] = { Subrange(lo, hi), lo == hi };
+			else if (args[k].range != TypeDesc::maxRange)
+				facts[args[k].offset] = { args[k].range, false };
+
+			if (some && !(constant && lo == hi))
+				varying.push_back(k);
+		}
+
+		size_t n = specialize(entry, end, facts);
+		if (verbose && n > 0)
+			cout << prefix(progName) << "specialized " << subrs[entry] << ", " << n << " instructions\n";
+
+		if (varying.empty() || end - entry > CloneSize)
+			continue;
+
+		// Group the call sites by the constants they pass; non-constants are "unknown"
+		typedef vector<pair<bool, int>> Key;
+		map<Key, vector<const CallSite*>> groups;
+		for (const auto site : sites) {
+			Key key;
+			for (auto k : varying)
+				key.push_back({ site->args[k].constant, site->args[k].value });
+			if (any_of(key.begin(), key.end(), [](const pair<bool,int>& p) { return p.first; }))
+				groups[key].push_back(site);
+		}
+
+		vector<pair<Key, vector<const CallSite*>>> order(groups.begin(), groups.end());
+		stable_sort(order.begin(), order.end(),
+			[](const pair<Key, vector<const CallSite*>>& a, const pair<Key, vector<const CallSite*>>& b)
+			{	return a.second.size() > b.second.size();	});
+		if (order.size() > MaxClones)
+			order.resize(MaxClones);
+
+		unsigned nclones = 0;
+		for (const auto& group : order) {
+			ParamFacts cfacts = facts;
+			for (size_t i = 0; i < varying.size(); ++i)
+				if (group.first[i].first) {
+					const int value = group.first[i].second;
+					cfacts[args[varying[i]].offset] = { Subrange(value, value), true };
+				}
+
+			const size_t at = cloneSubr(entry, end);
+			n = specialize(at, code->size(), cfacts);
+			if (n < CloneSavings) {				// Not worth it...
+				code->resize(at);
+				indextbl.resize(at);
+				continue;
+			}
+
+			subrs[at] = subrs[entry] + "'" + to_string(++nclones);
+			for (const auto site : group.second)
+				(*code)[site->pc].value = at;
+
+			if (verbose)
+				cout << prefix(progName) << "cloned " << subrs[entry] << " at " << at << " for "
+					 << group.second.size() << " call sites, specializing " << n << " instructions\n";
+		}
+	}
+}
+
+/********************************************************************************************//**
+ * Subroutines are contiguous; each ends where the next, by address, starts.
+ *
+ * @param	entry	A subroutine entry point
+ * @return	The address following the subroutine's last instruction
+ ************************************************************************************************/
+size_t PComp::subrEnd(size_t entry) const {
+	const auto next = subrs.upper_bound(entry);
+	return next != subrs.end() ? next->first : code->size();
+}
+
+/********************************************************************************************//**
+ * @return	The subroutine entry points, and the target of every jump
+ ************************************************************************************************/
+set<size_t> PComp::jumpTargets() const {
+	set<size_t> targets;
+	for (const auto& subr : subrs)
+		targets.insert(subr.first);
+
+	for (const auto& instr : *code)
+		switch (instr.op) {
+		case OpCode::JUMPI:
+		case OpCode::JNEQI:
+		case OpCode::FORPREP:
+		case OpCode::FORLOOP:
+		case OpCode::CALLI:
+			targets.insert(instr.value.natural());
+			break;
+
+		default:	;
+		}
+
+	return targets;
+}
+
+/********************************************************************************************//**
+ * A parameter is read, by value, via "pushvar 0,offset; eval 1" in its own subroutine, and via
+ * "pushvar hops,offset; eval 1" in those nested within it. Any other reference, e.g., passing it
+ * by reference, or assigning to it, may change its value. References from outside the subroutine
+ * with a non-zero level might be to the parameter; if not, this is merely conservative.
+ *
+ * @param	entry	The subroutine's entry point
+ * @param	end		The subroutine's end
+ * @param	offset	The parameter's frame offset
+ *
+ * @return	true if the parameter may be written
+ ************************************************************************************************/
+bool PComp::paramWritten(size_t entry, size_t end, int offset) const {
+	for (size_t pc = 0; pc < code->size(); ++pc) {
+		const Instr& instr = (*code)[pc];
+		if (instr.op != OpCode::PUSHVAR || instr.value.integer() != offset)
+			continue;
+
+		const bool inside = pc >= entry && pc < end;
+		if (inside != (instr.level == 0))
+			continue;							// Someone else's variable
+
+		if (pc + 1 == code->size()									||
+				(*code)[pc + 1].op != OpCode::EVAL					||
+				(*code)[pc + 1].value.integer() != 1)
+			return true;
+	}
+
+	return false;
+}
+
+/********************************************************************************************//**
+ * Jumps within the subroutine are relocated, while calls, including recursive calls to the
+ * original, are not. The source index is copied along with the code.
+ *
+ * @param	entry	The subroutine's entry point
+ * @param	end		The subroutine's end
+ *
+ * @return	The clone's entry point
+ ************************************************************************************************/
+size_t PComp::cloneSubr(size_t entry, size_t end) {
+	const size_t at = code->size();
+	for (size_t pc = entry; pc < end; ++pc) {
+		Instr instr = (*code)[pc];
+		switch (instr.op) {
+		case OpCode::JUMPI:
+		case OpCode::JNEQI:
+		case OpCode::FORPREP:
+		case OpCode::FORLOOP:
+			if (instr.value.natural() >= entry && instr.value.natural() <= end)
+				instr.value = instr.value.natural() - entry + at;
+			break;
+
+		default:	;
+		}
+
+		code->push_back(instr);
+		indextbl.push_back(indextbl[pc]);
+	}
+
+	return at;
+}
+
+/********************************************************************************************//**
+ * Parameter reads are replaced with constants, and limit checks, immediately following parameter
+ * reads, that the parameter's range satisfies are removed. Then constants are folded.
+ *
+ * @param	entry	The subroutine's entry point
+ * @param	end		The subroutine's end
+ * @param	facts	What's true about the parameters on entry
+ *
+ * @return	The number of instructions removed
+ ************************************************************************************************/
+size_t PComp::specialize(size_t entry, size_t end, const ParamFacts& facts) {
+	const set<size_t> targets = jumpTargets();
+	size_t removed = 0;
+
+	for (size_t pc = entry; pc + 1 < end; ++pc) {
+		Instr& instr = (*code)[pc];
+		if (instr.op != OpCode::PUSHVAR || instr.level != 0)
+			continue;
+
+		const auto fact = facts.find(instr.value.integer());
+		if (fact == facts.end()													||
+				(*code)[pc + 1].op != OpCode::EVAL									||
+				(*code)[pc + 1].value.integer() != 1 || targets.count(pc + 1) != 0)
+			continue;
+
+		const Subrange& range = fact->second.range;
+		if (fact->second.constant) {
+			instr = Instr(OpCode::PUSH, 0, Datum(range.min()));
+			(*code)[pc + 1] = Instr(OpCode::NOP);
+			++removed;
+			continue;
+		}
+
+		for (size_t i = pc + 2; i < pc + 4 && i < end && targets.count(i) == 0; ++i) {
+			Instr& check = (*code)[i];
+			if ((check.op == OpCode::LLIMIT && range.min() >= check.value.integer())	||
+					(check.op == OpCode::ULIMIT && range.max() <= check.value.integer())) {
+				check = Instr(OpCode::NOP);
+				++removed;
+			}
+		}
+	}
+
+	return removed + fold(entry, end, targets);
+}
+
+/********************************************************************************************//**
+ * Folds, in order,
+ *
+ * - push c; llimit a, and push c; ulimit b, into push c, if c is within the limit,
+ * - push a; push b; add|sub|mul, into push a op b, if the result fits in an integer,
+ * - push 0; add|sub, and push 1; mul, into nothing,
+ *
+ * skipping NOPs, but not folding across an instruction that control may jump to.
+ *
+ * @param	entry	Start of the code to fold
+ * @param	end		End of the code to fold
+ * @param	targets	Jump targets
+ *
+ * @return	The number of instructions removed
+ ************************************************************************************************/
+size_t PComp::fold(size_t entry, size_t end, const set<size_t>& targets) {
+	// Return the next instruction after pc, skipping NOPs, or end if control may enter between
+	auto next = [&](size_t pc) {
+		for (++pc; pc < end && targets.count(pc) == 0; ++pc)
+			if ((*code)[pc].op != OpCode::NOP)
+				return pc;
+		return end;
+	};
+
+	size_t removed = 0;
+	for (bool changed = true; changed; ) {
+		changed = false;
+
+		for (size_t pc = entry; pc < end; ++pc) {
+			Instr& instr = (*code)[pc];
+			if (instr.op != OpCode::PUSH || instr.value.kind() != Datum::Integer)
+				continue;
+
+			const int value = instr.value.integer();
+			const size_t n = next(pc);
+			if (n == end)
+				continue;
+
+			Instr& second = (*code)[n];
+			if ((second.op == OpCode::LLIMIT && value >= second.value.integer())		||
+					(second.op == OpCode::ULIMIT && value <= second.value.integer())) {
+				second = Instr(OpCode::NOP);
+				++removed;
+				changed = true;
+
+			} else if ((second.op == OpCode::MUL && value == 1) ||
+					((second.op == OpCode::ADD || second.op == OpCode::SUB) && value == 0)) {
+				instr = second = Instr(OpCode::NOP);
+				removed += 2;
+				changed = true;
+
+			} else if (second.op == OpCode::PUSH && second.value.kind() == Datum::Integer) {
+				const size_t o = next(n);
+				if (o == end)
+					continue;
+
+				const int64_t lhs = value, rhs = second.value.integer();
+				int64_t result = 0;
+				switch ((*code)[o].op) {
+				case OpCode::ADD:	result = lhs + rhs;		break;
+				case OpCode::SUB:	result = lhs - rhs;		break;
+				case OpCode::MUL:	result = lhs * rhs;		break;
+				default:			continue;
+				}
+
+				if (result < numeric_limits<int>::min() || result > numeric_limits<int>::max())
+					continue;
+
+				instr.value = static_cast<int>(result);
+				second = (*code)[o] = Instr(OpCode::NOP);
+				removed += 2;
+				changed = true;
+			}
+		}
+	}
+
+	return removed;
+}
+
 /********************************************************************************************//**
  * @param	type	Type descriptor to investagate
  * @return  true if type can be treated as an Integer
@@ -35,6 +394,14 @@ bool PComp::isAnInteger(TDescPtr type) {
 	return type->tclass() == TypeDesc::Integer;
 }
 
+/********************************************************************************************//**
+ * @param	type	Type descriptor to investagate
+ * @return  true if type is a long integer
+ ************************************************************************************************/
+bool PComp::isALongInt(TDescPtr type) {
+	return type->tclass() == TypeDesc::LongInt;
+}
+
 /********************************************************************************************//**
  * @param	type	Type descriptor to investagate
  * @return  true if type can be treated as an Real
@@ -110,6 +477,7 @@ size_t PComp::emitCallI(int8_t level, size_t where) {
  * @return	Type type of the promoted type
  ************************************************************************************************/
 TDescPtr PComp::promote(TDescPtr lhs, TDescPtr rhs) {
+	const size_t pc = code->size();
 	TDescPtr type = lhs;					// Assume that lhs and rhs have the same types
 	if (lhs->tclass() == rhs->tclass())
 		;									// nothing to do
@@ -117,16 +485,27 @@ TDescPtr PComp::promote(TDescPtr lhs, TDescPtr rhs) {
 	else if ((isAnInteger(lhs) && isAnInteger(rhs)) || (isAReal(lhs) && isAReal(rhs)))
 		;									// nothing to do, again
 
-	else if (isAnInteger(lhs) && isAReal(rhs)) {
+	else if (isAnInteger(lhs) && isALongInt(rhs)) {
+		emit(OpCode::ITOL2);				// promote lhs (TOS-1) to a long integer
+		type = rhs;
+
+	} else if (isALongInt(lhs) && isAnInteger(rhs))
+		emit(OpCode::ITOL);					// promote rhs to a long integer
+
+	else if ((isAnInteger(lhs) || isALongInt(lhs)) && isAReal(rhs)) {
 		emit(OpCode::ITOR2);				// promote lhs (TOS-1) to a real
 		type = rhs;
 
-	} else if (isAReal(lhs) && isAnInteger(rhs))
+	} else if (isAReal(lhs) && (isAnInteger(rhs) || isALongInt(rhs)))
 		emit(OpCode::ITOR);					// promote rhs to a real
 	
 	else
 		error("incompatable binary types");
 
+	if (loopDepth > 0 && code->size() > pc)
+		perfNote(pc, "mixed type arithmetic in a loop; an extra "
+			+ OpCodeInfo::info((*code)[pc].op).name() + " every iteration");
+
 	return type;
 }
 
@@ -138,6 +517,7 @@ TDescPtr PComp::promote(TDescPtr lhs, TDescPtr rhs) {
  * @param	rhs	The type of the right-hand-side 
  ************************************************************************************************/
 void PComp::assignPromote (TDescPtr lhs, TDescPtr rhs) {
+	const size_t pc = code->size();
 	if (lhs->tclass() == rhs->tclass())
 		;				// nothing to do
 
@@ -148,12 +528,28 @@ void PComp::assignPromote (TDescPtr lhs, TDescPtr rhs) {
 		error("rounding real to fit in an integer");
 		emit(OpCode::ROUND);				// promote rhs to a integer	 
 
-	} else if (isAReal(lhs) && isAnInteger(rhs))
+	} else if (isALongInt(lhs) && isAReal(rhs)) {
+		error("rounding real to fit in a long integer");
+		emit(OpCode::ROUND);				// promote rhs to a long integer
+		emit(OpCode::ITOL);
+
+	} else if (isAnInteger(lhs) && isALongInt(rhs))
+		emit(OpCode::LTOI);					// demote rhs to an integer, if it fits
+
+	else if (isALongInt(lhs) && isAnInteger(rhs))
+		emit(OpCode::ITOL);					// promote rhs to a long integer
+
+	else if (isAReal(lhs) && (isAnInteger(rhs) || isALongInt(rhs)))
 		emit(OpCode::ITOR);                 // promote rhs to a real
 
 	else
 		error("incompatable assignment types");
 
+	if (loopDepth > 0 && code->size() > pc &&
+			((*code)[pc].op == OpCode::ITOR || (*code)[pc].op == OpCode::ITOL))
+		perfNote(pc, "mixed type assignment in a loop; an extra "
+			+ OpCodeInfo::info((*code)[pc].op).name() + " every iteration");
+
 	// Emit limit checks, unless range is impossible to exceed
 	if (lhs->ordinal() && lhs->range() != TypeDesc::maxRange) {
 		emit(OpCode::LLIMIT, 0, lhs->range().min());
@@ -192,6 +588,14 @@ TDescPtr PComp::identFactor(int level, const string& id, bool var) {
 			assert(!type->ref());
 			break;
 
+		case SymValue::ConstVar:
+			if (var) error("attempt to pass constant by reference!");
+			type = variable(level, it);
+			type = type->base();
+			emit(OpCode::EVAL, 0, type->size());
+			break;
+
+		case SymValue::WithField:
 		case SymValue::Variable:
 			type = variable(level, it);
 			assert(type != nullptr);
@@ -263,7 +667,7 @@ TDescPtr PComp::builtInFunc(int level)
 		type = expression(level);
 		expect(Token::CloseParen);	
 
-		if (type->tclass() != TypeDesc::Integer && type->tclass() != TypeDesc::Real)
+		if (!isAnInteger(type) && !isALongInt(type) && !isAReal(type))
 			oss << "expeced integer or real value, got: " << current();
 
 		else
@@ -274,7 +678,7 @@ TDescPtr PComp::builtInFunc(int level)
 		type = expression(level);
 		expect(Token::CloseParen);	
 
-		if (type->tclass() == TypeDesc::Integer)
+		if (isAnInteger(type) || isALongInt(type))
 			type = TypeDesc::newRealDesc();		// Always produces a real
 		else if (type->tclass() != TypeDesc::Real)
 			oss << "expeced integer, or real value, got: " << current();
@@ -285,7 +689,7 @@ TDescPtr PComp::builtInFunc(int level)
 		type = expression(level);
 		expect(Token::CloseParen);	
 
-		if (type->tclass() == TypeDesc::Integer)
+		if (isAnInteger(type) || isALongInt(type))
 			type = TypeDesc::newRealDesc();		// Always produces a real
 		else if (type->tclass() != TypeDesc::Real)
 			oss << "expeced integer, or real value, got: " << current();
@@ -296,7 +700,7 @@ TDescPtr PComp::builtInFunc(int level)
 		type = expression(level);
 		expect(Token::CloseParen);	
 
-		if (type->tclass() == TypeDesc::Integer)
+		if (isAnInteger(type) || isALongInt(type))
 			type = TypeDesc::newRealDesc();		// Always produces a real
 		else if (type->tclass() != TypeDesc::Real)
 			oss << "expeced integer, or real value, got: " << current();
@@ -307,7 +711,7 @@ TDescPtr PComp::builtInFunc(int level)
 		type = expression(level);
 		expect(Token::CloseParen);	
 
-		if (type->tclass() != TypeDesc::Integer)
+		if (!isAnInteger(type) && !isALongInt(type))
 			oss << "expeced integer value, got: " << current();
 		emit(OpCode::ODD);
 
@@ -325,7 +729,7 @@ TDescPtr PComp::builtInFunc(int level)
 		type = expression(level);
 		expect(Token::CloseParen);	
 
-		if (type->tclass() == TypeDesc::Integer)
+		if (isAnInteger(type) || isALongInt(type))
 			type = TypeDesc::newRealDesc();		// Always produces a real
 		else if (type->tclass() != TypeDesc::Real)
 			oss << "expeced integer, or real value, got: " << current();
@@ -336,7 +740,7 @@ TDescPtr PComp::builtInFunc(int level)
 		type = expression(level);
 		expect(Token::CloseParen);	
 
-		if (type->tclass() == TypeDesc::Integer)
+		if (isAnInteger(type) || isALongInt(type))
 			type = TypeDesc::newRealDesc();		// Always produces a real
 		else if (type->tclass() != TypeDesc::Real)
 			oss << "expeced integer, or real value, got: " << current();
@@ -347,7 +751,7 @@ TDescPtr PComp::builtInFunc(int level)
 		type = expression(level);
 		expect(Token::CloseParen);	
 
-		if (type->tclass() == TypeDesc::Integer)
+		if (isAnInteger(type) || isALongInt(type))
 			type = TypeDesc::newRealDesc();		// Always produces a real
 		else if (type->tclass() != TypeDesc::Real)
 			oss << "expeced integer, or real value, got: " << current();
@@ -408,6 +812,12 @@ TDescPtr PComp::factor(int level, bool var) {
 		expect(Token::IntegerNum);
 		type = TypeDesc::newIntDesc();
 
+	} else if (accept(Token::LongIntNum, false)) {
+		if (var) error("can't take reference of a literal");
+		emit(OpCode::PUSH, 0, ts.current().longint_value);
+		expect(Token::LongIntNum);
+		type = TypeDesc::newLongDesc();
+
 	} else if (accept(Token::RealNum, false)) {
 		if (var) error("can't take reference of a literal");
 		emit(OpCode::PUSH, 0, ts.current().real_value);
@@ -648,31 +1058,33 @@ TDescPtrVec	PComp::expressionList(int level) {
 /********************************************************************************************//**
  * Promote binary constant-expression  operands as necessary. 
  *
- * Converts lhs or rhs to a Real as necessary.
+ * Converts lhs or rhs to a LongInt or Real as necessary.
  *
  * @param	lhs	The left-hand-side operand
  * @param	rhs	The right-hand-side  operand
  ************************************************************************************************/
 void PComp::constPromote(Datum& lhs, Datum& rhs) {
-	if (lhs.kind() == lhs.kind())
+	if (lhs.kind() == rhs.kind())
 		;									// nothing to do
 
-	else if ((lhs.kind() == Datum::Integer	&& rhs.kind() == Datum::Integer) ||
-			 (lhs.kind() == Datum::Real		&& rhs.kind() == Datum::Real))
-		;									// nothing to do, again
+	else if (lhs.kind() == Datum::Integer && rhs.kind() == Datum::LongInt)
+		lhs = lhs.longint();				// convert lhs to a long integer
 
-	else if (lhs.kind() == Datum::Integer && rhs.kind() == Datum::Real)
-		lhs = lhs.integer() * 1.0;			// convert lhs to a real
+	else if (lhs.kind() == Datum::LongInt && rhs.kind() == Datum::Integer)
+		rhs = rhs.longint();				// convert rhs to a long integer
 
-	else if (lhs.kind() == Datum::Real && rhs.kind() == Datum::Integer)
-		rhs = rhs.integer() * 1.0;			// convert rhs to a real
+	else if (lhs.integral() && rhs.kind() == Datum::Real)
+		lhs = lhs.real();					// convert lhs to a real
+
+	else if (lhs.kind() == Datum::Real && rhs.integral())
+		rhs = rhs.real();					// convert rhs to a real
 
 	else
 		error("incompatable binary types");
 }
 
 /********************************************************************************************//**
- * identifier | number | ( const-expression )
+ * identifier | number | character | ( const-expression )
  *
  * @return A boolean, constant value pair. Second is valid only if first is true.
  ************************************************************************************************/
@@ -693,10 +1105,25 @@ PComp::ConstExprValue PComp::constFactor() {
 		value.second = sign * ts.current().integer_value;
 		next();										// Consume the number
 
+	} else if (accept(Token::LongIntNum, false)) {
+		value.second = sign * ts.current().longint_value;
+		next();										// Consume the number
+
 	} else if (accept(Token::RealNum, false)) {
 		value.second = sign * ts.current().real_value;
 		next();										// Consume the number
 
+	} else if (accept(Token::Character, false)) {
+		const string s = ts.current().string_value;
+		next();										// Consume the character
+
+		if (s.empty())
+			error("expected a character, but got ''");
+		else if (sign != 1)
+			error("can't negate a character");
+		else
+			value.second = s[0];
+
 	} else if (accept(Token::Identifier, false)) {	// Copy, and then, consume the identifier..
 		auto it = lookup(ts.current().string_value);
 		next(); 									// consume the identifier
@@ -713,6 +1140,8 @@ PComp::ConstExprValue PComp::constFactor() {
 						error("min attribute not defined for records", it->first);
 					else if (it->second.type()->tclass() == TypeDesc::Real)
 						value.second = numeric_limits<double>::min();
+					else if (it->second.type()->tclass() == TypeDesc::LongInt)
+						value.second = numeric_limits<int64_t>::min();
 					else 
 						value.second = it->second.type()->range().min();
 
@@ -723,6 +1152,8 @@ PComp::ConstExprValue PComp::constFactor() {
 							error("max attribute not defined for records", it->first);
 						else if (it->second.type()->tclass() == TypeDesc::Real)
 							value.second = numeric_limits<double>::max();
+						else if (it->second.type()->tclass() == TypeDesc::LongInt)
+							value.second = numeric_limits<int64_t>::max();
 						else
 							value.second = it->second.type()->range().max();
 					}
@@ -730,8 +1161,8 @@ PComp::ConstExprValue PComp::constFactor() {
 			}
 			break;
 
-		case SymValue::Constant:
-			value.second = Datum(sign) * it->second.value();
+		case SymValue::Constant:				// Don't sign non-numeric values, e.g., true
+			value.second = sign == 1 ? it->second.value() : -it->second.value();
 			break;
 
 		default:
@@ -929,6 +1360,119 @@ PComp::ConstExprValue PComp::constExpr() {
 	return lhs;
 }
 
+/********************************************************************************************//**
+ * const-init = const-expr | string | '(' const-init { ',' const-init } ')' ;
+ *
+ * Appends the value of a constant initializer, for an object of the given type, on values. Arrays
+ * and records are a parenthesized list of element, or field, initializers, in order. Character
+ * arrays may also be initialized with a string of the same length.
+ *
+ * @param			type	The type of the object being initialized
+ * @param[in,out]	values	The values are appended here
+ ************************************************************************************************/
+void PComp::constInit(TDescPtr type, DatumVector& values) {
+	LogLevel	lvl;
+	if (verbose)
+		cout << prefix(progName) << "constant-initializer(" << type->tclass() << ")\n";
+
+	const size_t first = values.size();
+	ostringstream oss;
+
+	if (type->tclass() == TypeDesc::Array) {
+		if (accept(Token::String, false) && type->base()->tclass() == TypeDesc::Character) {
+			const string s = ts.current().string_value;
+			next();								// Consume the string
+
+			if (s.size() != type->range().span()) {
+				oss << "expected a string of " << type->range().span() << " characters, got " << s.size();
+				error(oss.str());
+			}
+
+			for (char c : s)
+				values.push_back(Datum(c));
+
+		} else if (expect(Token::OpenParen)) {
+			for (unsigned i = 0; i < type->range().span(); ++i) {
+				if (i > 0 && !expect(Token::Comma))
+					break;
+				constInit(type->base(), values);
+			}
+			expect(Token::CloseParen);
+		}
+
+	} else if (type->tclass() == TypeDesc::Record) {
+		if (expect(Token::OpenParen)) {
+			const size_t base = values.size();
+			bool first = true, variant = false;
+			for (const auto& fld : type->fields()) {
+				if (!first && !expect(Token::Comma))
+					break;
+				if (!variant && base + fld.offset() != values.size()) {
+					error("can't initialize a variant record");
+					variant = true;
+				}
+				constInit(fld.type(), values);
+				first = false;
+			}
+			expect(Token::CloseParen);
+		}
+
+	} else {
+		auto value = constExpr();
+		Datum& v = value.second;
+
+		if (!value.first) {
+			error("expected a const-expression, got:", ts.current().string_value);
+			v = Datum(0);
+
+		} else switch(type->tclass()) {
+		case TypeDesc::Real:
+			if (v.integral())
+				v = v.real();
+			else if (v.kind() != Datum::Real)
+				oss << "expected a real value, got: " << v;
+			break;
+
+		case TypeDesc::LongInt:
+			if (v.integral())
+				v = v.longint();
+			else
+				oss << "expected an integer value, got: " << v;
+			break;
+
+		case TypeDesc::Boolean:
+			if (v.kind() != Datum::Boolean)
+				oss << "expected a boolean value, got: " << v;
+			break;
+
+		case TypeDesc::Character:
+			if (v.kind() != Datum::Character)
+				oss << "expected a character value, got: " << v;
+			else if (v.character() < type->range().min() || v.character() > type->range().max())
+				oss << "character value out of range: " << v;
+			break;
+
+		case TypeDesc::Pointer:
+			if (v.kind() != Datum::Integer || v.integer() != 0)
+				oss << "expected nil, got: " << v;
+			break;
+
+		default:								// Integer or Enumeration
+			if (v.kind() != Datum::Integer)
+				oss << "expected an integer value, got: " << v;
+			else if (v.integer() < type->range().min() || v.integer() > type->range().max())
+				oss << "value out of range " << type->range() << ": " << v;
+		}
+
+		if (!oss.str().empty())
+			error(oss.str());
+
+		values.push_back(v);
+	}
+
+	values.resize(first + type->size());		// Keep the layout intact in spite of errors
+}
+
 /********************************************************************************************//**
  * Call a function or procedure...
  *
@@ -938,15 +1482,39 @@ PComp::ConstExprValue PComp::constExpr() {
  * @param	it		The sub-routines symbol table entry
  ************************************************************************************************/
 void PComp::callStatement(int level, SymbolTableIter it) {
+	CallSite site;								// Scalar value arguments, for propagate()
+
 	if (expect(Token::OpenParen)) {
 		unsigned nParams = 0;					// Count actual parameters
 
 		const auto& params = it->second.params(); // Formal parameter kinds
+		vector<int> offsets(params.size());		// Parameters have negative offsets, in reverse
+		for (int k = params.size(), dx = 0; k-- > 0; )
+			offsets[k] = dx -= params[k]->size();
+
 		if (!accept(Token::CloseParen, false))
 			do {								// collect actual parameters
 				if (params.size() > nParams) {
-					const auto kind = expression(level, params[nParams]->ref());
-					assignPromote(params[nParams], kind);
+					const TDescPtr param = params[nParams];
+					const size_t pc = code->size();
+					const auto kind = expression(level, param->ref());
+					assignPromote(param, kind);
+
+					if (!param->ref() && param->ordinal() && param->size() == 1) {
+						// A constant is a single integer push, followed by any limit checks
+						bool constant =	code->size() > pc &&
+										(*code)[pc].op == OpCode::PUSH &&
+										(*code)[pc].value.kind() == Datum::Integer;
+						for (size_t i = pc + 1; constant && i < code->size(); ++i)
+							constant =	(*code)[i].op == OpCode::LLIMIT ||
+										(*code)[i].op == OpCode::ULIMIT;
+
+						site.args.push_back({	offsets[nParams],
+												constant,
+												constant ? (*code)[pc].value.integer() : 0,
+												param->range()	});
+					}
+
 				} else
 					expression(level); 			// consume the expression...
 
@@ -966,7 +1534,21 @@ void PComp::callStatement(int level, SymbolTableIter it) {
 	if (SymValue::Procedure != it->second.kind() && SymValue::Function != it->second.kind())
 		error("Identifier is not a function or procedure", it->first);
 
-	emitCallI(level - it->second.level(), it->second.value().natural());
+	if (it->second.external()) {
+		emit(OpCode::CALLX, 0, it->second.value());
+		return;
+	}
+
+	const int hops = level - it->second.level();
+	const size_t pc = emitCallI(hops, it->second.value().natural());
+	site.pc = pc;
+	callSites.push_back(site);
+	if (hops >= DeepChain) {
+		ostringstream oss;
+		oss << "call to '" << it->first << "', declared " << hops << " blocks out; follows "
+			<< hops << " static links every call";
+		perfNote(pc, oss.str());
+	}
 }
 
 /********************************************************************************************//**
@@ -980,7 +1562,8 @@ void PComp::statementList(int level, SymbolTableEntry& context) {
 		Token::End,
 		Token::Endfunc,
 		Token::Endproc,
-		Token::Endprog
+		Token::Endprog,
+		Token::EOS
 	};
 
 	do {
@@ -1060,13 +1643,13 @@ TDescPtr PComp::varSelector(SymbolTableIter it, TDescPtr type) {
 	// Copy, and then consume, the selector identifier...
 	const string selector = ts.current().string_value;
 	if (expect(Token::Identifier)) {
-		size_t offset = 0;					// Calc the offset into the record...
+		size_t offset = 0;					// Find the offset into the record...
 		for (const auto& fld : type->fields()) {
 			if (fld.name() == selector) {
 				type = fld.type();			// Return the record field's type
+				offset = fld.offset();
 				break;
 			}
-			offset += fld.type()->size();
 		}
 
 		if (offset > 0) {				// Don't bother if it's the 1st field...
@@ -1098,6 +1681,8 @@ TDescPtr PComp::attribute(SymbolTableIter it, TDescPtr type) {
 				emit(OpCode::PUSH, 0, 0);
 			} else if (type->tclass() == TypeDesc::Real)
 				emit(OpCode::PUSH, 0, numeric_limits<double>::min());
+			else if (type->tclass() == TypeDesc::LongInt)
+				emit(OpCode::PUSH, 0, numeric_limits<int64_t>::min());
 			else if (type->tclass() == TypeDesc::Array) {
 				emit(OpCode::PUSH, 0, type->range().min());
 				type = type->itype();		// Return arrays index type
@@ -1113,6 +1698,8 @@ TDescPtr PComp::attribute(SymbolTableIter it, TDescPtr type) {
 				emit(OpCode::PUSH, 0, 0);
 			} else if (type->tclass() == TypeDesc::Real)
 				emit(OpCode::PUSH, 0, numeric_limits<double>::max());
+			else if (type->tclass() == TypeDesc::LongInt)
+				emit(OpCode::PUSH, 0, numeric_limits<int64_t>::max());
 			else if (type->tclass() == TypeDesc::Array) {
 				emit(OpCode::PUSH, 0, type->range().max());
 				type = type->itype();		// Return arrays index type
@@ -1134,11 +1721,32 @@ TDescPtr PComp::attribute(SymbolTableIter it, TDescPtr type) {
  *
  * Emits a variable reference, i.e., a pointer type, optionally with array indexes.
  *
- * @param	id		The variable or array identifier
+ * Also notes if a frame allocation candidate escapes; any reference to the pointer value itself,
+ * other than by its owner (new or dispose), and from any other block, rather than what it
+ * points to.
+ *
  * @param	level	The current block level.
+ * @param	it		The variable or array identifier
+ * @param	owner	True if the reference is by new or dispose
  * @return	The identifier type
  ************************************************************************************************/
-TDescPtr PComp::variable(int level, SymbolTableIter it) {
+TDescPtr PComp::variable(int level, SymbolTableIter it, bool owner) {
+	auto local = localPtrs.find(&it->second);
+	if (local != localPtrs.end()) {
+		if (level != it->second.level() || (!owner && !accept(Token::Caret, false)))
+			local->second.escapes = true;
+
+	} else if (it->second.kind() == SymValue::WithField)
+		tempRefs.push_back(code->size());	// Location of the PUSHVAR to the temporary
+
+	const int hops = level - it->second.level();
+	if (it->second.kind() == SymValue::Variable && hops >= DeepChain) {
+		ostringstream oss;
+		oss << "'" << it->first << "' is declared " << hops << " blocks out; follows " << hops
+			<< " static links every reference" << (loopDepth > 0 ? ", every iteration" : "");
+		perfNote(code->size(), oss.str());
+	}
+
 	TDescPtr type = emitVarRef(level, it->second);
 	if (it->second.type()->ref())			// dereference if necessary...
 		emit(OpCode::EVAL, 0, type->size());
@@ -1179,7 +1787,7 @@ TDescPtr PComp::lvalueRef(int level, SymbolTableIter it, bool dup) {
 		emit(OpCode::PUSHVAR, 0, FrameRetVal);
 		type = TypeDesc::newPointerDesc(type);
 
-	} else if (it->second.kind() == SymValue::Variable)
+	} else if (it->second.kind() == SymValue::Variable || it->second.kind() == SymValue::WithField)
 		type = variable(level, it);
 
 	else
@@ -1234,10 +1842,12 @@ bool PComp::identStatement(int level) {
 				break;
 
 			case SymValue::Variable:		// emit a reference to a variable, or array, value
+			case SymValue::WithField:
 				assignStatement(level, lhs);
 				break;
 
 			case SymValue::Constant:
+			case SymValue::ConstVar:
 				error("Can't assign to a constant", lhs->first);
 				break;
 
@@ -1319,6 +1929,7 @@ bool PComp::ifStatement(int level, SymbolTableEntry& context) {
 bool PComp::whileStatement(int level, SymbolTableEntry& context) {
 	if (accept(Token::While)) {
 		const auto cond_pc = code->size();	// Start of while expr
+		++loopDepth;
 		expression(level);
 
 		// jump if expr is false...
@@ -1326,6 +1937,7 @@ bool PComp::whileStatement(int level, SymbolTableEntry& context) {
 		expect(Token::Loop);				// consume "loop"
 		statementList(level, context);
 		expect(Token::Endloop);
+		--loopDepth;
 
 		emitJumpI(cond_pc);					// Jump back to expr test...
 
@@ -1348,9 +1960,11 @@ bool PComp::whileStatement(int level, SymbolTableEntry& context) {
 bool PComp::repeatStatement(int level, SymbolTableEntry& context) {
 	if (accept(Token::Repeat)) {
 		const size_t loop_pc = code->size();			// jump here until expr fails
+		++loopDepth;
 		statementList(level, context);
 		expect(Token::Until);
 		expression(level);
+		--loopDepth;
 		emitJNEQI(loop_pc);
 		expect(Token::Endloop);
 
@@ -1361,7 +1975,15 @@ bool PComp::repeatStatement(int level, SymbolTableEntry& context) {
 }
 
 /********************************************************************************************//**
- * for identifier := expresson ( to | downto ) condition do statement
+ * for identifier in [ reverse ] ordinal-type loop statement-lst endloop
+ *
+ * A counted loop; the iterator's reference, and the limit, are statement temporaries. FORPREP
+ * assigns the first value, or skips an empty range, and FORLOOP tests, steps and branches back
+ * to the statement list, in a single instruction:
+ *
+ *     pushvar iterator; push first; push limit; forprep inc, done
+ *     body: statement-lst; forloop inc, body
+ *     done:
  *
  * @param	level	The current block level.
  * @param	context	The enclosing subroutine context
@@ -1373,7 +1995,6 @@ bool PComp::forStatement(int level, SymbolTableEntry& context) {
 		if (var == symtbl.end())
 			return true;					// give up if the identifier is undefined
 		auto lhs = lvalueRef(level, var, false);
-		emit(OpCode::DUP);					// dupliate the iternator reference
 
 		expect(Token::In);					// "for" identifier "in" ...
 
@@ -1394,47 +2015,93 @@ bool PComp::forStatement(int level, SymbolTableEntry& context) {
 			return true;					// give up...
 		}
 
-		if (inc == 1)
-			emit(OpCode::PUSH, 0, range->range().min());
-		else
-			emit(OpCode::PUSH, 0, range->range().max());
-			
-		emit(OpCode::ASSIGN, 0, lhs->size()); // initialize the iterator
+		const int first = inc == 1 ? range->range().min() : range->range().max();
+		const int limit = inc == 1 ? range->range().max() : range->range().min();
+		switch (lhs->base()->tclass()) {	// the first value, of the iterator's kind
+		case TypeDesc::Boolean:		emit(OpCode::PUSH, 0, first != 0);						break;
+		case TypeDesc::Character:	emit(OpCode::PUSH, 0, static_cast<char>(first));		break;
+		case TypeDesc::LongInt:		emit(OpCode::PUSH, 0, static_cast<int64_t>(first));		break;
+		default:					emit(OpCode::PUSH, 0, first);							break;
+		}
+		emit(OpCode::PUSH, 0, limit);
+		const auto prep_pc = emit(OpCode::FORPREP, inc, 0);
+		const auto body_pc = code->size();
 
-		const auto cond_pc = code->size();	// Condition check
+		tempOffset += 2;					// The iterator reference, and limit, are statement temporaries
+		++loopDepth;
+		expect(Token::Loop);				// ... loop statements...
+		statementList(level, context);
+		expect(Token::Endloop);				// ... endloop
+		--loopDepth;
+		tempOffset -= 2;
 
-		emit(OpCode::DUP);					// dupliate the iternator reference, again
-			emit(OpCode::EVAL, 0, lhs->size());	// evaluate the iterator and compare to the limit
+		emit(OpCode::FORLOOP, inc, body_pc);
 
-		if (inc == 1) {
-			emit(OpCode::PUSH, 0, range->range().max());
-			emit(OpCode::LTE);					// is iterator <= the condition?
+		if (verbose)
+			cout << prefix(progName) << "patching address @ " << prep_pc << " to " << code->size() << '\n';
+		(*code)[prep_pc].value = code->size();
 
-		} else {
-			emit(OpCode::PUSH, 0, range->range().min());
-			emit(OpCode::GTE);					// is iterator <= the condition?
-		}
+		return true;
+	}
 
-		const auto jmp_pc = emitJNEQI();	// Jump to end of statement if not
+	return false;
+}
 
-		expect(Token::Loop);				// ... loop statements...
-		statementList(level, context);
-		expect(Token::Endloop);				// ... endloop
+/********************************************************************************************//**
+ * with variable { ',' variable } do statement-lst end
+ *
+ * Each record's address is evaluated once, and left on the stack as a statement temporary, i.e.,
+ * a frame slot following the locals. The record's field names are then entered into the symbol
+ * table as offsets from the saved address, for the duration of the statement list.
+ *
+ * @param	level	The current block level.
+ * @param	context	The enclosing subroutine context
+ *
+ * @return	true if a with statement was processed
+ ************************************************************************************************/
+bool PComp::withStatement(int level, SymbolTableEntry& context) {
+	if (accept(Token::With)) {
+		const int		first = tempOffset;		// The first statement temporary
+		vector<SymbolTableIter>	fields;			// Field symbols to remove when done
+
+		do {
+			auto var = lookup(ts.current().string_value);
+			expect(Token::Identifier);		// consume the identifier...
+			if (var == symtbl.end())
+				break;						// give up if the identifier is undefined
+
+			else if (var->second.kind() != SymValue::Variable &&
+					 var->second.kind() != SymValue::WithField) {
+				error("expected a record variable, got:", var->first);
+				break;
+			}
 
-		emit(OpCode::DUP);					// iterate; dupliate the iternator reference again
-		emit(OpCode::DUP);					// and one more time
-		emit(OpCode::EVAL, 0, 1);			// add (or subtract 1)
-		emit(OpCode::PUSH, 0, inc);
-		emit(OpCode::ADD);
-		emit(OpCode::ASSIGN, 0, 1);			// update the iterator
-		emitJumpI(cond_pc);					// jump back to check the condition again
+			auto type = variable(level, var)->base();
+			const int slot = FrameSize + tempOffset++;
 
-		// pop the condition varaible off the stack...
-		const auto done_pc = emit(OpCode::POP, 0, 1);
+			if (type->tclass() != TypeDesc::Record)
+				error("expected a record variable, got:", var->first);
 
-		if (verbose)
-			cout << prefix(progName) << "patching address @ " << done_pc << " to " << code->size() << '\n';
-		(*code)[jmp_pc].value = done_pc;
+			else {
+				for (const auto& fld : type->fields()) {	// install the fields...
+					if (verbose)
+						cout << prefix(progName) << "with field " << fld.name() << ": " << slot << ", " << fld.offset() << '\n';
+					fields.push_back(symtbl.insert(
+						{ fld.name(), SymValue::makeWithField(level, slot, fld.offset(), fld.type()) }));
+				}
+			}
+		} while (accept(Token::Comma));
+
+		expect(Token::Do);					// ... do statements...
+		statementList(level, context);
+		expect(Token::End);					// ... end
+
+		for (auto it : fields)
+			symtbl.erase(it);
+
+		if (tempOffset > first)				// pop the record references off the stack...
+			emit(OpCode::POP, 0, tempOffset - first);
+		tempOffset = first;
 
 		return true;
 	}
@@ -1497,6 +2164,7 @@ void PComp::getStatement(int level) {
 			case TypeDesc::Boolean:		emit(OpCode::GET, 0, Datum::Boolean);		break;
 			case TypeDesc::Character:	emit(OpCode::GET, 0, Datum::Character);		break;
 			case TypeDesc::Integer:		emit(OpCode::GET, 0, Datum::Integer);		break;
+			case TypeDesc::LongInt:		emit(OpCode::GET, 0, Datum::LongInt);		break;
 			case TypeDesc::Real:		emit(OpCode::GET, 0, Datum::Real);			break;
 			default:	error("unsupported get parameter");
 			}
@@ -1505,6 +2173,7 @@ void PComp::getStatement(int level) {
 		case TypeDesc::Boolean:		emit(OpCode::GET, 0, Datum::Boolean);			break;
 		case TypeDesc::Character:	emit(OpCode::GET, 0, Datum::Character);			break;
 		case TypeDesc::Integer:		emit(OpCode::GET, 0, Datum::Integer);			break;
+		case TypeDesc::LongInt:		emit(OpCode::GET, 0, Datum::LongInt);			break;
 		case TypeDesc::Real:		emit(OpCode::GET, 0, Datum::Real);				break;
 		default:
 			error("unsupported nullptr parameter");
@@ -1515,11 +2184,15 @@ void PComp::getStatement(int level) {
 /********************************************************************************************//**
  * put or put[ln]( [ expression [',' width [ ',' precision ]]] )
  *
- * Process put and putln parameters, up to, but not including, emitteing the final op-code.
+ * Process put and putln parameters, and emit PUT, or PUTLN. If optimizing, a string literal,
+ * without a width or precision, is instead placed in the constant segment, once per distinct
+ * literal, as a count followed by its characters, and written with PUTS, or PUTSLN, rather than
+ * pushing each character.
  *
  * @param	level	The current block level.
+ * @param	newline	Follow the values with a newline?
  ************************************************************************************************/
-void PComp::put(int level) {
+void PComp::put(int level, bool newline) {
 	const int defaultWidth = 0;
 	const int defaultPrec = 0;
 
@@ -1530,7 +2203,28 @@ void PComp::put(int level) {
 			emit(OpCode::PUSH, 0, defaultPrec);
 
 		} else {
+			const size_t start = code->size();
+			const string literal = current() == Token::String ? ts.current().string_value : "";
 			auto expr = expression(level); 	// value(s) to put
+
+			if (optimizing && !literal.empty() && code->size() == start + literal.size()
+				&& current() == Token::CloseParen) {
+				code->resize(start);		// Elide the character pushes
+				indextbl.resize(start);
+				next();
+
+				auto it = strings.find(literal);
+				if (it == strings.end()) {
+					DatumVector values { Datum(static_cast<int>(literal.size())) };
+					for (char c : literal)
+						values.push_back(Datum(c));
+					it = strings.insert({ literal, emitConsts(values) }).first;
+				}
+
+				emit(newline ? OpCode::PUTSLN : OpCode::PUTS, 0, it->second);
+				return;
+			}
+
 			emit(OpCode::PUSH, 0, expr->size());
 
 			if (accept(Token::Comma)) {		// [ ',' width [ ',' precision ]]
@@ -1560,18 +2254,17 @@ void PComp::put(int level) {
 			expect(Token::CloseParen);
 		}
 	}
+
+	emit(newline ? OpCode::PUTLN : OpCode::PUT);
 }
 
 /********************************************************************************************//**
- * put or putln( [ expression [',' width [ ',' precision ]]] )
- *
- * Process put and putln parameters, up to, but not including, emitteing the final op-code.
+ * put( [ expression [',' width [ ',' precision ]]] )
  *
  * @param	level	The current block level.
  ************************************************************************************************/
 void PComp::putStatement(int level) {
-	put(level);
-	emit(OpCode::PUT);
+	put(level, false);
 }
 
 /********************************************************************************************//**
@@ -1580,8 +2273,7 @@ void PComp::putStatement(int level) {
  * @param	level	The current block level.
  ************************************************************************************************/
 void PComp::putLnStatement(int level) {
-	put(level);
-	emit(OpCode::PUTLN);
+	put(level, true);
 }
 
 /********************************************************************************************//**
@@ -1598,26 +2290,41 @@ void PComp::statementNew(int level) {
 		auto it = lookup(ts.current().string_value);
 		next();								// consume the identifier
 
+		const bool whole = accept(Token::CloseParen, false);
+		const auto new_pc = code->size();
+
 		TDescPtr tdesc = TypeDesc::newIntDesc();
 		if (it != symtbl.end())
-			tdesc = variable(level, it);
+			tdesc = variable(level, it, whole);
 
-		if (tdesc->tclass() != TypeDesc::Pointer) {
+		size_t size = 1;
+		if (tdesc->tclass() != TypeDesc::Pointer || tdesc->base()->tclass() != TypeDesc::Pointer) {
 			ostringstream oss;
 			oss << "expected a pointer, got " << tdesc->tclass();
 			error(oss.str());
-		}
+
+		} else
+			size = tdesc->base()->base()->size();	// size of the object pointed to
 
 		// The object size must be a signed integer, else it will be interperted as an address
-		assert(tdesc->size() < numeric_limits<int>::max());
-		if (tdesc->size() > numeric_limits<int>::max())
+		if (size > static_cast<size_t>(numeric_limits<int>::max()))
 			error("size of object exceeds MaxInt!");
-		int n = static_cast<int>(tdesc->size());
+		int n = static_cast<int>(size);
 
 		emit(OpCode::PUSH, 0, n);		// push the size of the id
 		emit(OpCode::NEW);
 		emit(OpCode::ASSIGN, 0, 1);
 
+		if (loopDepth > 0) {
+			ostringstream oss;
+			oss << "new in a loop; a free store search, and " << n << " Datum allocation, every iteration";
+			perfNote(new_pc, oss.str());
+		}
+
+		auto local = whole && it != symtbl.end() ? localPtrs.find(&it->second) : localPtrs.end();
+		if (local != localPtrs.end())
+			local->second.news.push_back(new_pc);
+
 		expect(Token::CloseParen);
 	}
 }
@@ -1642,7 +2349,35 @@ void PComp::statementProcs(int level) {
 
 	else if (accept(Token::Dispose)) {		// 'Dispose (' expr ')'
 		expect(Token::OpenParen);
-		auto tdesc = expression(level);
+		const auto dispose_pc = code->size();
+
+		TDescPtr tdesc;						// dispose(ptr) is noted if ptr is a candidate
+		auto local = localPtrs.end();
+		if (accept(Token::Identifier, false)) {
+			auto it = lookup(ts.current().string_value);
+			if (it == symtbl.end()) {
+				next();						// consume the undefined identifier
+				tdesc = TypeDesc::newIntDesc();
+
+			} else if (it->second.kind() == SymValue::Variable) {
+				next();						// consume the identifier
+				const bool whole = accept(Token::CloseParen, false);
+				tdesc = variable(level, it, whole)->base();
+				emit(OpCode::EVAL, 0, tdesc->size());
+				if (whole)
+					local = localPtrs.find(&it->second);
+			}
+		}
+
+		if (tdesc == nullptr)
+			tdesc = expression(level);
+
+		if (local != localPtrs.end())
+			local->second.disposes.push_back(dispose_pc);
+
+		if (loopDepth > 0)
+			perfNote(dispose_pc, "dispose in a loop; a free store coalesce every iteration");
+
 		if (tdesc->tclass() != TypeDesc::Pointer) {
 			ostringstream oss;
 			oss << "expected a pointer, got " << tdesc->tclass();
@@ -1651,6 +2386,10 @@ void PComp::statementProcs(int level) {
 		emit(OpCode::DISPOSE);
 		expect(Token::CloseParen);
 		
+	} else if (accept(Token::Ready)) {		// 'ready' [ '(' ')' ]
+		if (accept(Token::OpenParen))
+			expect(Token::CloseParen);
+		emit(OpCode::READY);
 	}
 
 	// else: nothing
@@ -1661,6 +2400,7 @@ void PComp::statementProcs(int level) {
  *   if expr then stmt { else stmt }	|
  *   while expr do stmt					|
  *   repeat stmt until expr				|
+ *   with variable-lst do stmt-lst end	|
  *   stmt-block ]
  *
  * @param	level	The current block level.
@@ -1677,6 +2417,8 @@ void PComp::statement(int level, SymbolTableEntry& context) {
 		;
 	else if (forStatement(level, context))
 		;
+	else if (withStatement(level, context))
+		;
 	else if (returnStatement(level, context))
 		;
 	else
@@ -1696,7 +2438,8 @@ void PComp::constDeclList(int level) {
 		Token::VarDecl,
 		Token::ProcDecl,
 		Token::FuncDecl,
-		Token::Begin
+		Token::Begin,
+		Token::EOS
 	};
 
 	if (accept(Token::ConsDecl)) {
@@ -1737,7 +2480,8 @@ void PComp::typeDeclList(int level) {
 		Token::VarDecl,
 		Token::ProcDecl,
 		Token::FuncDecl,
-		Token::Begin
+		Token::Begin,
+		Token::EOS
 	};
 
 	if (accept(Token::TypeDecl)) {
@@ -1751,20 +2495,47 @@ void PComp::typeDeclList(int level) {
 }
 
 /********************************************************************************************//**
- * ident = const-expr ;
+ * ident [ ':' type ] = const-init ;
+ *
+ * Typed scalar constants are just constant values, while typed array and record constants are
+ * allocated in the constant segment.
  *
  * @param	level	The current block level.
  ************************************************************************************************/
 void PComp::constDecl(int level) {
 	auto ident = nameDecl(level);				// Copy the identifier
+
+	if (accept(Token::Colon)) {					// typed constant
+		TDescPtr tdesc = type(level, false);
+		expect(Token::EQU);						// Consume the "="
+
+		DatumVector values;
+		constInit(tdesc, values);
+
+		if (tdesc->tclass() == TypeDesc::Array || tdesc->tclass() == TypeDesc::Record) {
+			const size_t addr = emitConsts(values);
+			symtbl.insert(	{ ident, SymValue::makeConstVar(level, addr, tdesc) } );
+			if (verbose)
+				cout << prefix(progName) << "constDecl " << ident << ": " << level << ", @" << addr << '\n';
+
+		} else {
+			symtbl.insert(	{ ident, SymValue::makeConst(level, values.front(), tdesc) } );
+			if (verbose)
+				cout << prefix(progName) << "constDecl " << ident << ": " << level << ", " << values.front() << '\n';
+		}
+
+		return;
+	}
+
 	expect(Token::EQU);							// Consume the "="
 	auto value = constExpr();					// Get the constant value
 
 	if (!value.first)
 		error("expected a const-expression, got:", ts.current().string_value);
 
-	TDescPtr type = value.second.kind() == Datum::Kind::Integer
-		? TypeDesc::newIntDesc() : TypeDesc::newRealDesc();
+	TDescPtr type = value.second.kind() == Datum::Kind::Integer	? TypeDesc::newIntDesc()
+				  : value.second.kind() == Datum::Kind::LongInt	? TypeDesc::newLongDesc()
+				  : TypeDesc::newRealDesc();
 
 	symtbl.insert(	{ ident, SymValue::makeConst(level, value.second, type) } );
 	if (verbose)
@@ -1774,14 +2545,16 @@ void PComp::constDecl(int level) {
 /********************************************************************************************//**
  * const" var-decl-lst ;
  *
- * @param	level	The current block level.
+ * @param			level	The current block level.
+ * @param[in,out]	inits	Initialized variables are appended here
+ * @param			base	Offset of the first variable
  * @return  Number of variables allocated before or after the activation frame.
  ************************************************************************************************/
-int PComp::varDeclBlock(int level) {
+int PComp::varDeclBlock(int level, VarInitVec& inits, int base) {
 	FieldVec	idents;							// vector of name/type pairs.
 
 	if (accept(Token::VarDecl))
-		varDeclList(level, false, "", idents);
+		varDeclList(level, false, "", idents, &inits, base);
 
 	int sum = 0;								// Add up the size of every variable in the block
 	for (const auto& id : idents)
@@ -1791,32 +2564,60 @@ int PComp::varDeclBlock(int level) {
 }
 
 /********************************************************************************************//**
- * var-decl { ';' var-decl }
+ * var-decl [ '=' const-init ] { ';' var-decl [ '=' const-init ] }
  *
  * Allocate space on the stack for each variable, as a postivie offset from the end of current
  * activaction frame. Create a new entry in the symbol table, that notes the offset and data
  * type.
  *
+ * Initial values, if allowed (inits isn't null), are emitted in the constant segment, to be
+ * copied into the activation frame on block entry.
+ *
  * @param			level		The current block level.
  * @param			params		True if processing formal parameters, false if variable declaractions. 
  * @param			idprefix	The identifier prefix
  * @param[in,out]	idents		Vector of identifer, kind pairs 
+ * @param[in,out]	inits		Initialized variables are appended here, if not null
+ * @param			base		Offset of the first variable, if not params
  *
  * @return  Offset of the next variable/parmeter from the current activation frame.
  ************************************************************************************************/
-void PComp::varDeclList(int level, bool params, const string& idprefix, FieldVec& idents) {
+void PComp::varDeclList(
+			int			level,
+			bool		params,
+	const	string&		idprefix,
+			FieldVec&	idents,
+			VarInitVec*	inits,
+			int			base)
+{
 	// Stops if the ';' if followd by any of hte following tokens
 	static const Token::KindSet stops {
 		Token::ProcDecl,
 		Token::FuncDecl,
 		Token::Begin,
-		Token::CloseParen
+		Token::CloseParen,
+		Token::Case,
+		Token::EOS
 	};
 
+	vector<size_t> initAddrs;					// Initial value address, if any, for each ident
 	do {
 		if (oneOf(stops))
 			break;								// No more variables...
+
+		const size_t first = idents.size();
 		varDecl(level, false, idprefix, idents);
+
+		size_t addr = numeric_limits<size_t>::max();
+		if (inits != nullptr && accept(Token::EQU)) {
+			DatumVector values;
+			constInit(idents.back().type(), values);
+			addr = emitConsts(values);
+		}
+		initAddrs.resize(idents.size(), addr);
+		for (size_t i = first; i < idents.size(); ++i)
+			initAddrs[i] = addr;
+
 	} while (accept(Token::SemiColon));
 
 	/*
@@ -1824,12 +2625,13 @@ void PComp::varDeclList(int level, bool params, const string& idprefix, FieldVec
 	 * parameters have negative offsets in reverse. 
 	 */
 
-	int dx = 0;
+	int dx = base;
 	if (params)
 		for (const auto& id : idents)
 			dx -= id.type()->size();
 
-	for (const auto& id : idents) {				// install the results in the symbol table...
+	for (size_t i = 0; i < idents.size(); ++i) {	// install the results in the symbol table...
+		const auto& id = idents[i];
 		if (verbose)
 			cout	<< prefix(progName)		<< "var/param "
 					<< id.name()			<< ": " 
@@ -1843,6 +2645,9 @@ void PComp::varDeclList(int level, bool params, const string& idprefix, FieldVec
 				error("previously defined", id.name());
 
 		symtbl.insert( { id.name(), SymValue::makeVar(level, dx, id.type())	} );
+		if (i < initAddrs.size() && initAddrs[i] != numeric_limits<size_t>::max())
+			inits->push_back({ dx, initAddrs[i], id.type()->size() });
+
 		dx += id.type()->size();
 	}
 }
@@ -2124,9 +2929,14 @@ TDescPtr PComp::structuredType(int level, const string& idprefix, bool var) {
 		FieldVec	fields;
 		fieldList(level, idprefix, fields);
 
-		unsigned sum = 0;						// Calc the total size of the record
-		for (auto& element : fields)
+		size_t sum = 0;							// Calc the offsets, and size, of the fixed part
+		for (auto& element : fields) {
+			element.offset(sum);
 			sum += element.type()->size();
+		}
+
+		if (accept(Token::Case))				// ... and the variant part, if any
+			sum = variantPart(level, idprefix, sum, fields);
 
 		tdesc = TypeDesc::newRcrdDesc(sum, fields, var);
 
@@ -2136,6 +2946,102 @@ TDescPtr PComp::structuredType(int level, const string& idprefix, bool var) {
 	return tdesc;
 }
 
+/********************************************************************************************//**
+ * variant-part =	"case" [ identifier ':' ] ordinal-type "of" variant { ';' variant } ;
+ * variant =		const-expr { ',' const-expr } ':' '(' field-lst ')' ;
+ *
+ * The "case" has already been consumed. The tag field, if any, follows the fixed part, and is
+ * followed by the variants, each starting at the same offset, thus sharing the same storage.
+ * The labels document which variant the tag selects; they aren't checked at run time.
+ *
+ * @param			level		The current block level.
+ * @param			idprefix	The identifier prefix
+ * @param			offset		The offset of the variant part, i.e., the size of the fixed part
+ * @param[in,out]	fields		The tag, and variant, fields are appended here
+ *
+ * @return	The size of the record; the fixed part, the tag, and the largest variant
+ ************************************************************************************************/
+size_t PComp::variantPart(int level, const string& idprefix, size_t offset, FieldVec& fields) {
+	TDescPtr tag;
+	string tagName;								// The tag field's name, if any
+
+	if (accept(Token::Identifier, false)) {		// tag field, or tag type name
+		const string id = ts.current().string_value;
+		next();									// Consume the identifier...
+
+		if (accept(Token::Colon)) {
+			for (const auto& fld : fields)
+				if (fld.name() == id)
+					error("previously defined", id);
+
+			tag = type(level, false, "");
+			tagName = id;
+			fields.push_back(Field(id, tag, offset));
+			offset += tag->size();
+
+		} else {
+			auto it = lookup(id);
+			if (it == symtbl.end() || it->second.kind() != SymValue::Type)
+				error("expected type, got ", id);
+			else
+				tag = it->second.type();
+		}
+
+	} else
+		tag = type(level, false, "");
+
+	if (tag != nullptr && !tag->ordinal())
+		error("expected an ordinal variant tag type");
+	expect(Token::Of);
+
+	size_t size = 0;							// Size of the largest variant
+	do {
+		if (oneOf({ Token::End }))
+			break;								// Allow a trailing ';'
+
+		do {									// variant labels...
+			auto label = constExpr();
+			const Datum& v = label.second;
+
+			if (!label.first)
+				error("expected a const-expression, got:", ts.current().string_value);
+
+			else if (v.kind() == Datum::Real || v.kind() == Datum::LongInt)
+				error("expected an ordinal variant label");
+
+			else if (tag != nullptr && tag->ordinal()) {
+				const int n =	v.kind() == Datum::Character	? v.character()	:
+								v.kind() == Datum::Boolean		? v.boolean()	: v.integer();
+				if (n < tag->range().min() || n > tag->range().max()) {
+					ostringstream oss;
+					oss << "variant label out of range " << tag->range() << ": " << v;
+					error(oss.str());
+				}
+			}
+		} while (accept(Token::Comma));
+
+		expect(Token::Colon);
+		expect(Token::OpenParen);
+
+		FieldVec variant;						// Each variant starts at offset...
+		fieldList(level, idprefix, variant);
+
+		size_t sum = 0;
+		for (auto& fld : variant) {				// The tag isn't in the symbol table...
+			if (!tagName.empty() && fld.name() == tagName)
+				error("previously defined", tagName);
+			fld.offset(offset + sum);
+			sum += fld.type()->size();
+			fields.push_back(fld);
+		}
+		size = max(size, sum);
+
+		expect(Token::CloseParen);
+	} while (accept(Token::SemiColon));
+
+	return offset + size;
+}
+
 /********************************************************************************************//**
  * var-decl-list 
  *
@@ -2253,27 +3159,40 @@ SymbolTableIter PComp::subroutineDecl(int level, SymValue::Kind kind) {
 
 		expect(Token::CloseParen);
 
-		for (auto id : idents)
+		for (auto id : idents) {
 			it->second.params().push_back(id.type());
+
+			if (!id.type()->ref() && id.type()->size() >= LargeValue) {
+				ostringstream oss;
+				oss << "'" << id.name() << "' is passed to '" << ident << "' by value; copies "
+					<< id.type()->size() << " Datums every call";
+				perfNote(code->size(), oss.str());
+			}
+		}
 	}
 
 	return it;
 }
 
 /********************************************************************************************//**
- * procedure ident [ ( var-decl-lst ) ] ; block ;
+ * procedure ident [ ( var-decl-lst ) ] is ( block "endproc" | external-decl ) ;
  *
  * @param	level	The current block level.
  ************************************************************************************************/
 void PComp::procDecl(int level) {
 	SymbolTableIter it = subroutineDecl(level, SymValue::Procedure);
 	expect(Token::Is);
-	blockDecl(*it, level + 1, Token::Endproc);
-	emit(OpCode::RET, 0, it->second.params().size());
+	if (accept(Token::External))
+		externalDecl(level, it);
+
+	else {
+		blockDecl(*it, level + 1, Token::Endproc);
+		emit(OpCode::RET, 0, it->second.params().size());
+	}
 }
 
 /********************************************************************************************//**
- * function ident [ ( var-decl-lst ) ] : type  block-decl ;
+ * function ident [ ( var-decl-lst ) ] : type is ( block-decl "endfunc" | external-decl ) ;
  *
  * @param	level	The current block level.
  ************************************************************************************************/
@@ -2282,9 +3201,94 @@ void PComp::funcDecl(int level) {
 	expect(Token::Colon);
 	it->second.type(type(level, false, ""));
 	expect(Token::Is);
-	blockDecl(*it, level + 1, Token::Endfunc);
-	if (!it->second.returned())
-		error("Funcation has no return statement");
+	if (accept(Token::External))
+		externalDecl(level, it);
+
+	else {
+		blockDecl(*it, level + 1, Token::Endfunc);
+		if (!it->second.returned())
+			error("Funcation has no return statement");
+	}
+}
+
+/********************************************************************************************//**
+ * @param		type	A parameter, or return, type
+ * @param[out]	param	type's external parameter description
+ * @return	false if type can't be passed to, or returned from, an external subroutine
+ ************************************************************************************************/
+static bool externalParam(TDescPtr type, External::Param& param) {
+	param.ref = type->ref();
+	param.array = false;
+	param.count = 1;
+
+	if (type->tclass() == TypeDesc::Array) {	// arrays of scalars, of any rank
+		param.array = true;
+		param.count = type->size();
+		while (type->tclass() == TypeDesc::Array)
+			type = type->base();
+	}
+
+	switch (type->tclass()) {
+	case TypeDesc::Boolean:		param.kind = Datum::Boolean;	break;
+	case TypeDesc::Character:	param.kind = Datum::Character;	break;
+	case TypeDesc::Enumeration:
+	case TypeDesc::Integer:		param.kind = Datum::Integer;	break;
+	case TypeDesc::LongInt:		param.kind = Datum::LongInt;	break;
+	case TypeDesc::Real:		param.kind = Datum::Real;		break;
+	default:					return false;
+	}
+
+	return true;
+}
+
+/********************************************************************************************//**
+ * external-decl = "external" string [ ',' string ] ;
+ *
+ * Bind the subroutine to a C function in the shared library named by the first string, by the
+ * subroutine's name, or the second string, if given. An empty library name binds to the
+ * interpreter, and the libraries it's linked with. The "external" has already been consumed.
+ *
+ * @param	level	The current block level.
+ * @param	it		The subroutine's symbol table entry
+ ************************************************************************************************/
+void PComp::externalDecl(int level, SymbolTableIter it) {
+	const string library = ts.current().string_value;
+	expect(Token::String);
+
+	string symbol = it->first;
+	if (accept(Token::Comma)) {
+		symbol = ts.current().string_value;
+		expect(Token::String);
+	}
+
+	bool valid = true;
+	External::ParamVec params;
+	for (auto type : it->second.params()) {
+		External::Param param;
+		if (!externalParam(type, param)) {
+			error("can't pass a record, or pointer, to an external subroutine", it->first);
+			valid = false;
+		}
+		params.push_back(param);
+	}
+
+	const bool function = it->second.kind() == SymValue::Function;
+	External::Param result { Datum::Integer, 1, false, false };
+	if (function && (!externalParam(it->second.type(), result) || result.array)) {
+		error("an external function must return a scalar", it->first);
+		valid = false;
+	}
+
+	string msg;
+	const size_t index = valid ? External::bind(library, symbol, params, function, result.kind, msg)
+							   : External::size();
+	if (valid && index == External::size())
+		error(msg);
+
+	it->second.value(Datum(index));
+	it->second.external(true);
+	it->second.returned(true);
+	purge(level + 1);						// Forget the parameters
 }
 
 /********************************************************************************************//**
@@ -2312,6 +3316,89 @@ void PComp::subDeclList(int level) {
 	}
 }
 
+/********************************************************************************************//**
+ * Note the blocks local pointer variables as frame allocation candidates.
+ *
+ * @param	level	The current block level.
+ ************************************************************************************************/
+void PComp::localPointers(int level) {
+	for (const auto& entry : symtbl) {
+		const SymValue& value = entry.second;
+		if (	value.level() == level						&&
+				value.kind() == SymValue::Variable			&&
+				value.value().integer() >= 0				&&	// a local, not a parameter
+				value.type()->tclass() == TypeDesc::Pointer	&&
+				!value.type()->ref())
+			localPtrs[&value] = LocalPtr();
+	}
+}
+
+/********************************************************************************************//**
+ * Objects allocated via new(ptr), where the local ptr doesn't escape the block, are allocated in
+ * the activation frame, following the locals, rather than on the heap:
+ * - each "push size; new; assign 1" becomes "pushvar 0,object; assign 1; nop", and
+ * - each "pushvar ptr; eval 1; dispose" becomes "nop; nop; nop".
+ *
+ * The block's enter, and statement temporary references, are moved up to make room.
+ *
+ * @param	level	The current block level.
+ * @param	enter	Location of the blocks enter instruction
+ * @param	dx		Size of the block's locals
+ *
+ * @return	Number of Datums allocated in the activation frame
+ ************************************************************************************************/
+int PComp::frameAllocate(int level, size_t enter, int dx) {
+	int size = 0;							// Datums allocated in the frame, so far
+
+	for (auto it = localPtrs.begin(); it != localPtrs.end(); ) {
+		const SymValue* ptr = it->first;
+		const LocalPtr& local = it->second;
+
+		if (ptr->level() != level) {		// Not one of ours...
+			++it;
+			continue;
+
+		} else if (optimizing && !local.escapes && !local.news.empty()) {
+			const int offset = FrameSize + dx + size;
+			if (verbose)
+				cout << prefix(progName) << "allocating local pointer object at " << offset << '\n';
+
+			for (auto loc : local.news) {
+				(*code)[loc + 1] = Instr(OpCode::PUSHVAR, 0, Datum(offset));
+				(*code)[loc + 2] = Instr(OpCode::ASSIGN, 0, Datum(1));
+				(*code)[loc + 3] = Instr(OpCode::NOP);
+			}
+
+			for (auto loc : local.disposes) {
+				for (; (*code)[loc].op != OpCode::DISPOSE; ++loc)
+					(*code)[loc] = Instr(OpCode::NOP);
+				(*code)[loc] = Instr(OpCode::NOP);
+			}
+
+			// They're no longer free store operations, so forget any performance warnings
+			const auto elided = [&local](const PerfNote& note) {
+				return	find(local.news.begin(), local.news.end(), note.pc) != local.news.end() ||
+						find(local.disposes.begin(), local.disposes.end(), note.pc) != local.disposes.end();
+			};
+			perfNotes.erase(remove_if(perfNotes.begin(), perfNotes.end(), elided), perfNotes.end());
+
+			size += ptr->type()->base()->size();
+		}
+
+		it = localPtrs.erase(it);
+	}
+
+	if (size > 0) {
+		assert((*code)[enter].op == OpCode::ENTER);
+		(*code)[enter].value = Datum(dx + size);
+
+		for (auto loc : tempRefs)
+			(*code)[loc].value = Datum((*code)[loc].value.integer() + size);
+	}
+
+	return size;
+}
+
 /********************************************************************************************//**
  * [ const-decl-lst ]
  * [ var-decl-blk   ]
@@ -2327,25 +3414,39 @@ void PComp::subDeclList(int level) {
 size_t PComp::blockDecl(SymbolTableEntry& context, int level, Token::Kind end) {
 	LogLevel lvl;
 
+	VarInitVec	inits;							// Initialized variables
+
 	constDeclList(level);						// declaractions...
 	typeDeclList(level);
-	auto dx = varDeclBlock(level);
+	auto dx = varDeclBlock(level, inits);
+	localPointers(level);
 	subDeclList(level);
 
 	/* Block body
 	 *
 	 * Emit the block's prefix, saving and return its address, followed by the postfix. Omit the prefix
-	 * if dx == 0 (the subroutine has zero locals.
+	 * if dx == 0 (the subroutine has zero locals. Initialized variables are copied, in one go, from
+	 * the constant segment.
 	 */
 
 	const size_t addr = dx > 0 ? emit(OpCode::ENTER, 0, dx) : code->size();
 	context.second.value(Datum(addr));
+	subrs[addr] = context.first;
+	tempOffset = dx;						// Statement temporaries follow the locals
+	tempRefs.clear();
+
+	for (const auto& init : inits) {
+		emit(OpCode::PUSHVAR, 0, init.offset + FrameSize);
+		emit(OpCode::PUSH, 0, init.addr);
+		emit(OpCode::COPY, 0, init.size);
+	}
 
 	if (expect(Token::Begin)) {					// "begin" statements... "end"
 		statementList(level, context);
 		expect(end);
 	}
 
+	frameAllocate(level, addr, dx);
 	purge(level);								// Remove symbols only visible at this level
 
 	return addr;
@@ -2376,17 +3477,40 @@ void PComp::progDecl(int level) {
 
 /********************************************************************************************//**
  ************************************************************************************************/
-void PComp::run()								{	progDecl(0);	}
+void PComp::run() {
+	loopDepth = 0;
+	perfNotes.clear();
+	strings.clear();
+	callSites.clear();
+
+	progDecl(0);
+
+	if (optimizing && wholeProg && nErrors == 0)
+		propagate();
+
+	if (perfWarn)
+		perfReport();
+}
 
 // public:
 
 /********************************************************************************************//**
  * Construct a new compilier with the token stream initially bound to std::cin.
  ************************************************************************************************/
-PComp::PComp() : Compilier () {
+PComp::PComp()
+	:	Compilier (),
+		tempOffset{0},
+		optimizing{true},
+		perfWarn{false},
+		wholeProg{true},
+		loopDepth{0},
+		replProg{"", SymValue::makeSbr(SymValue::Procedure, 0)},
+		replDx{0}
+{
 	TDescPtr boolean	= TypeDesc::newBoolDesc();
 	TDescPtr character	= TypeDesc::newCharDesc();
 	TDescPtr integer	= TypeDesc::newIntDesc();
+	TDescPtr longint	= TypeDesc::newLongDesc();
 	TDescPtr natural	= TypeDesc::newIntDesc(Subrange(0, TypeDesc::maxRange.max()));
 	TDescPtr positive	= TypeDesc::newIntDesc(Subrange(1, TypeDesc::maxRange.max()));
 	TDescPtr real		= TypeDesc::newRealDesc();
@@ -2395,6 +3519,7 @@ PComp::PComp() : Compilier () {
 
 	symtbl.insert( { "boolean",		SymValue::makeType(0, boolean)					} );
 	symtbl.insert( { "integer",		SymValue::makeType(0, integer)					} );
+	symtbl.insert( { "longint",		SymValue::makeType(0, longint)					} );
 	symtbl.insert( { "real",		SymValue::makeType(0, real)						} );
 
 	// Built-in subrange types
@@ -2413,3 +3538,86 @@ PComp::PComp() : Compilier () {
 										TypeDesc::newPointerDesc(integer))			} );
 }
 
+
+/********************************************************************************************//**
+ * Session inputs are compiled, as if in the program block, and appended onto instructions and
+ * constants, which must persist for the life of the session.
+ *
+ * @param	instructions	The session's code segment
+ * @param	constants		The session's constant segment
+ ************************************************************************************************/
+void PComp::replBegin(InstrVector& instructions, DatumVector& constants) {
+	progName = "repl";
+	code = &instructions;
+	consts = &constants;
+	replDx = 0;
+	strings.clear();
+}
+
+/********************************************************************************************//**
+ * [ const-decl-lst ]
+ * [ type-decl-lst  ]
+ * [ var-decl-blk   ]
+ * [ sub-decl-lst   ]
+ * [ stmt-lst       ]
+ *
+ * Compiles source, as if in the program block, appending the subroutines, followed by the
+ * inputs entry point; space for the variables, their initialization, the statements, and a
+ * halt. Variables follow those of previous inputs. Nothing is kept if there are errors.
+ *
+ * @param		source		The input
+ * @param[out]	entry		The entry point
+ * @param[out]	incomplete	True if the first error was at the end of the input
+ * @return	The number of errors
+ ************************************************************************************************/
+unsigned PComp::replInput(const string& source, size_t& entry, bool& incomplete) {
+	const SymbolTable	symbols = symtbl;		// Roll back to here on errors
+	const SubrMap		subroutines = subrs;
+	const size_t		ncode = code->size();
+	const size_t		nconsts = consts->size();
+	const size_t		nindex = indextbl.size();
+
+	istringstream in(source);
+	ts.set_input(in);
+	nErrors = 0;
+	endError = false;
+	callSites.clear();							// Sessions are never whole programs
+	next();										// Fetch the 1st token
+
+	VarInitVec	inits;
+	constDeclList(0);
+	typeDeclList(0);
+	const int dx = varDeclBlock(0, inits, replDx);
+	subDeclList(0);
+
+	entry = dx > 0 ? emit(OpCode::ENTER, 0, dx) : code->size();
+	for (const auto& init : inits) {
+		emit(OpCode::PUSHVAR, 0, init.offset + FrameSize);
+		emit(OpCode::PUSH, 0, init.addr);
+		emit(OpCode::COPY, 0, init.size);
+	}
+
+	tempOffset = replDx + dx;					// Statement temporaries follow the variables
+	statementList(0, replProg);
+	if (current() != Token::EOS)
+		error("unexpected", ts.current().string_value);
+	emit(OpCode::HALT);
+
+	incomplete = endError;
+	if (nErrors > 0) {
+		symtbl = symbols;
+		subrs = subroutines;
+		code->resize(ncode);
+		consts->resize(nconsts);
+		indextbl.resize(nindex);
+		for (auto it = strings.begin(); it != strings.end(); )
+			if (it->second >= nconsts)
+				it = strings.erase(it);
+			else
+				++it;
+
+	} else
+		replDx += dx;
+
+	return nErrors;
+}
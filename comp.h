@@ -10,6 +10,10 @@
 #ifndef	PCOMP_H
 #define	PCOMP_H
 
+#include <map>
+#include <set>
+#include <vector>
+
 #include "compilier.h"
 
 /********************************************************************************************//**
@@ -26,8 +30,127 @@ class PComp : public Compilier {
 public:
 	PComp();								///< Constructor
 
+	/// Enable, or disable, optimizations, e.g., frame allocation of local pointer objects
+	void optimize(bool on)					{	optimizing = on;	}
+
+	/// Enable, or disable, performance warnings
+	void perfWarnings(bool on)				{	perfWarn = on;		}
+
+	/// Is the compiled code the whole program, i.e., no other code calls its subroutines?
+	void wholeProgram(bool on)				{	wholeProg = on;		}
+
+	/// Start an incremental, read-eval-print, session, appending to code and constants...
+	void replBegin(InstrVector& instructions, DatumVector& constants);
+
+	/// Compile a session input...
+	unsigned replInput(const std::string& source, size_t& entry, bool& incomplete);
+
+	/// Return the size of the session's global variables
+	int replFrame() const					{	return replDx;		}
+
 private:
+	/// A block local pointer variable; does it escape the block, and where is it new'd and disposed
+	struct LocalPtr {
+		bool				escapes;		///< Is the pointer value used other than via ptr^?
+		std::vector<size_t>	news;			///< Location of each new(ptr)
+		std::vector<size_t>	disposes;		///< Location of each dispose(ptr)
+
+		LocalPtr() : escapes{false} {}
+	};
+
+	typedef std::map<const SymValue*, LocalPtr> LocalPtrMap;	///< Local pointers by symbol
+
+	/// A performance warning; where, and what, including its estimated cost
+	struct PerfNote {
+		size_t				line;			///< Source line number
+		size_t				pc;				///< Address of the first instruction concerned
+		std::string			msg;			///< The warning, and its estimated cost
+	};
+
+	/// Performance warning thresholds
+	enum PerfLimits {
+		LargeValue	= 16,					///< Size, in Datums, of a large value parameter
+		DeepChain	= 2						///< Static links followed by a deep reference
+	};
+
+	/// A scalar value argument at a call site
+	struct CallArg {
+		int					offset;			///< The parameter's frame offset
+		bool				constant;		///< Is the argument an integer constant?
+		int					value;			///< The argument, if constant
+		Subrange			range;			///< The parameter's range, as checked by the caller
+	};
+
+	/// A call site; the CALLI's location, and its scalar value arguments
+	struct CallSite {
+		size_t				pc;				///< Location of the CALLI
+		std::vector<CallArg> args;			///< The scalar value arguments, in order
+	};
+
+	/// What's known about a parameter's value on entry
+	struct ParamFact {
+		Subrange			range;			///< The values it may take
+		bool				constant;		///< An integer constant, range.min()?
+	};
+
+	typedef std::map<int, ParamFact> ParamFacts;	///< Parameter facts, by frame offset
+
+	/// Subroutine cloning limits
+	enum CloneLimits {
+		CloneSize	= 64,					///< Largest subroutine worth cloning, in instructions
+		MaxClones	= 4,					///< Most clones of any one subroutine
+		CloneSavings = 3					///< Fewest instructions a clone must remove
+	};
+
+	int					tempOffset;			///< Frame offset of the next statement temporary
+	std::vector<size_t>	tempRefs;			///< Location of each statement temporary reference
+	LocalPtrMap			localPtrs;			///< Frame allocation candidates
+	bool				optimizing;			///< Optimizations enabled?
+	bool				perfWarn;			///< Performance warnings enabled?
+	bool				wholeProg;			///< No other code calls the subroutines?
+	std::vector<CallSite> callSites;		///< Every subroutine call, for propagate()
+	unsigned			loopDepth;			///< Loop nesting depth of the current statement
+	std::vector<PerfNote> perfNotes;		///< Performance warnings, in the order found
+	std::map<std::string, size_t> strings;	///< String literals in the constant segment, by value
+	SymbolTableEntry	replProg;			///< The session's program, for statement contexts
+	int					replDx;				///< Size of the session's global variables
+
+	/// A initialized variable; frame offset, and the constant segment address and size of its value
+	struct VarInit {
+		int			offset;					///< Variable offset from the activation frame
+		size_t		addr;					///< Constant segment address of the initial value
+		size_t		size;					///< Size of the variable, in Datums
+	};
+
+	typedef std::vector<VarInit> VarInitVec;	///< A vector of VarInit's
+
+	/// Note a performance warning...
+	void perfNote(size_t pc, const std::string& msg);
+
+	void perfReport();						///< Write the performance warnings...
+
+	void propagate();						///< Propagate arguments into subroutines...
+
+	/// Return the end of the subroutine at entry
+	size_t subrEnd(size_t entry) const;
+
+	/// Return every address that control may reach other than by falling through
+	std::set<size_t> jumpTargets() const;
+
+	/// Is the parameter at offset written, or referenced, other than by value?
+	bool paramWritten(size_t entry, size_t end, int offset) const;
+
+	/// Copy the subroutine at [entry, end) to the end of the code...
+	size_t cloneSubr(size_t entry, size_t end);
+
+	/// Specialize [entry, end) for the parameter facts...
+	size_t specialize(size_t entry, size_t end, const ParamFacts& facts);
+
+	/// Fold constant arithmetic, and limit checks, in [entry, end)...
+	size_t fold(size_t entry, size_t end, const std::set<size_t>& targets);
+
 	bool isAnInteger(TDescPtr type);		///< Is type an integer?
+	bool isALongInt(TDescPtr type);			///< Is type a LongInt?
 	bool isAReal(TDescPtr type);			///< Is type a Real?
 	size_t emitJump(size_t where = 0);		///< Emit a JUMP instruction...
 	size_t emitJumpI(size_t where = 0);		///< Emit a JUMPI instruction...
@@ -61,7 +184,8 @@ private:
 
 	/// variable sub-production...
 	TDescPtr variable(	int					level,
-						SymbolTableIter		it);
+						SymbolTableIter		it,
+						bool				owner = false);
 
 	TDescPtr builtInFunc(int level);		///< built-in functions
 
@@ -94,6 +218,9 @@ private:
 	ConstExprValue constSimpleExpr(); 		///< const-simple-expr production...
 	ConstExprValue constExpr();				///< const-expr production...
 
+	/// const-init production...
+	void constInit(TDescPtr type, DatumVector& values);
+
 	/// call-statement production...
 	void callStatement(	int					level,
 						SymbolTableIter		it);
@@ -121,11 +248,14 @@ private:
  	/// for-statement production...
  	bool forStatement(int level, SymbolTableEntry& context);
 
+	/// with-statement production...
+	bool withStatement(int level, SymbolTableEntry& context);
+
 	/// return-statement production...
 	bool returnStatement(int level, SymbolTableEntry& context);
 					
 	void getStatement(int level);			///< get production..
-	void put(int level);					///< Prefix for put and putln productions...
+	void put(int level, bool newline);		///< put and putln productions...
 	void putStatement(int level);			///< put production..
 	void putLnStatement(int level);			///< putln production..
 	void statementNew(int level);			///< New statement production...
@@ -141,13 +271,16 @@ private:
 	void constDecl(int level);				///< constant-declaration production...
 	void typeDecl(int level, bool var);		///< type-declaracton production...
 	void typeDeclList(int level);			///< type-declaraction-list production...
-	int varDeclBlock(int level);			///< variable-declaration-block production...
+	/// variable-declaration-block production...
+	int varDeclBlock(int level, VarInitVec& inits, int base = 0);
 
 	/// variable-declaration-list production...
 	void varDeclList(	int					level,
 						bool				params,
 				const	std::string&		idprefix,
-						FieldVec&			idents);
+						FieldVec&			idents,
+						VarInitVec*			inits = nullptr,
+						int					base = 0);
 
 	/// variable-declaration production...
 	void varDecl(		int					level,
@@ -186,6 +319,12 @@ private:
 				const	std::string&		idprefix,
 						FieldVec&			idents);
 
+	/// variant-part productions...
+	size_t variantPart(	int					level,
+				const	std::string&		idprefix,
+						size_t				offset,
+						FieldVec&			fields);
+
 	/// variable-declaration-list production...
 	void paramDeclList(	int					level,
 						bool				params,
@@ -199,8 +338,14 @@ private:
 
 	void procDecl(int level);				///< procedure-declaration production...
 	void funcDecl(int level);				///< function-declaration production...
+	void externalDecl(int level, SymbolTableIter it);	///< external-declaration production...
 	void subDeclList(int level);			///< function/procedue declaraction productions...
 
+	void localPointers(int level);			///< Collect the blocks frame allocation candidates
+
+	/// Allocate non-escaping local pointers in the activation frame...
+	int frameAllocate(int level, size_t enter, int dx);
+
 	/// block-declaration production...
 	size_t blockDecl(SymbolTableEntry&		context,
 					int 					level,
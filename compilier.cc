@@ -76,6 +76,8 @@ std::ostream& operator<<(std::ostream& oss, LogPrefix p) {
  * @param msg The error message
  ************************************************************************************************/
 void Compilier::error(const std::string& msg) {
+	if (0 == nErrors)
+		endError = Token::EOS == current();
 	cerr << progName << ": " << msg << " near line " << ts.lineNum << endl;
 	++nErrors;
 }
@@ -173,11 +175,28 @@ size_t Compilier::emit(const OpCode op) {
  * (bp), while parameters have a negative offset from the *start* of the frame
  *  -- offset locals by the size of the activation frame.
  *
+ *  Constant segment variables (ConstVar) have an absolute address, while with statement fields
+ *  (WithField) are an offset from the record address cached in the frame.
+ *
  *  @param	level	The current block level
  *  @param	val		The variable symbol table entry
  *  @return			Data type reference
  ************************************************************************************************/
 TDescPtr Compilier::emitVarRef(int level, const SymValue& val) {
+	if (val.kind() == SymValue::ConstVar) {				// absolute constant segment address
+		emit(OpCode::PUSH, 0, val.value());
+		return TypeDesc::newPointerDesc(val.type());
+
+	} else if (val.kind() == SymValue::WithField) {		// cached record address + field offset
+		emit(OpCode::PUSHVAR, 0, val.slot());
+		emit(OpCode::EVAL, 0, 1);
+		if (val.value().natural() > 0) {
+			emit(OpCode::PUSH, 0, val.value());
+			emit(OpCode::ADD);
+		}
+		return TypeDesc::newPointerDesc(val.type());
+	}
+
 	const auto offset = val.value().integer() >= 0			?
 						val.value().integer() + FrameSize	:	// local
 						val.value().integer();					// parameter
@@ -186,6 +205,34 @@ TDescPtr Compilier::emitVarRef(int level, const SymValue& val) {
 	return TypeDesc::newPointerDesc(val.type());
 }
 
+/********************************************************************************************//**
+ * Appends values on the end of the constant segment, returning the address of the first.
+ *
+ * @param	values	The values to append
+ * @return	The constant segment address of values[0]
+ ************************************************************************************************/
+size_t Compilier::emitConsts(const DatumVector& values) {
+	const size_t addr = consts->size();
+	if (verbose)
+		cout << progName << ": emitting " << values.size() << " constants at " << addr << "\n";
+
+	consts->insert(consts->end(), values.begin(), values.end());
+	return addr;
+}
+
+/********************************************************************************************//**
+ * Write the constant segment, if any, on the output stream
+ *
+ * @param out		The listing file stream
+ ************************************************************************************************/
+void Compilier::dumpConsts(ostream& out) {
+	if (!consts->empty())
+		out << "# " << progName << ": constant segment\n";
+
+	for (unsigned addr = 0; addr < consts->size(); ++addr)
+		out << setw(5) << addr << ": " << (*consts)[addr] << "\n";
+}
+
 /********************************************************************************************//**
  * Uses the cross index to write a listing on the output stream
  *
@@ -211,6 +258,7 @@ TDescPtr Compilier::emitVarRef(int level, const SymValue& val) {
 	while (getline(source, line))				// Any lines following '.' ...
 		cout << "# " << progName << ", " << linenum++ << ": " << line << "\n";
 
+	dumpConsts(out);
 	out << endl;
 }
 
@@ -236,7 +284,8 @@ void Compilier::purge(int level) {
 
 
 /********************************************************************************************//**
- * return the 'closest' (highest block level) identifer...
+ * return the 'closest' (highest block level) identifer. Ties go to the latest definition, e.g.,
+ * fields named by a with statement.
  *
  * @param	id	identifier to look up in the symbol table
  * @return symtbl.end() or an iterator positioned at a symbol table entry.
@@ -250,7 +299,7 @@ SymbolTable::iterator Compilier::lookup(const string& id) {
 	} else {										// Find the closest...
 		auto closest = range.first;
 		for (auto it = closest; it != range.second; ++it)
-			if (it->second.level() > closest->second.level())
+			if (it->second.level() >= closest->second.level())
 				closest = it;
 
 		return closest;
@@ -299,13 +348,14 @@ const std::string Compilier::nameDecl(int level, const string& idprefix) {
 /********************************************************************************************//**
  * Construct a new compilier with the token stream initially bound to std::cin.
  ************************************************************************************************/
-Compilier::Compilier() : nErrors{0}, verbose {false}, ts{cin} {}
+Compilier::Compilier() : nErrors{0}, endError{false}, verbose {false}, ts{cin}, code{nullptr}, consts{nullptr} {}
 
 /********************************************************************************************//**
  * Compile the contents of fName, generating code in prog.
  *
  * @param	fName			The source file name, where "-" means the standard input stream
  * @param	instructions	The generated machine code is appended here
+ * @param	constants		The generated constant segment is appended here
  * @param	lst				Write listing on standard output.
  * @param	ver				Run in verbose mode if true
  *
@@ -314,11 +364,13 @@ Compilier::Compilier() : nErrors{0}, verbose {false}, ts{cin} {}
 unsigned Compilier::operator()(
 	const	string&			fName,
 			InstrVector&	instructions,
+			DatumVector&	constants,
 			bool			lst,
 			bool			ver)
 {
 	progName = fName;
 	code = &instructions;
+	consts = &constants;
 	verbose = ver;
 
 	if ("-" == fName)  {					// "-" means standard input
@@ -328,6 +380,7 @@ unsigned Compilier::operator()(
 		// Just disasmemble as we can't rewind standard input!
 		for (unsigned loc = 0; loc < code->size(); ++loc)
 			disasm(cout, loc, (*code)[loc]);
+		dumpConsts(cout);
 
 	} else {
 		ifstream ifile(fName);
@@ -59,6 +59,9 @@ std::ostream& operator<<(std::ostream& oss, LogPrefix p);
  ************************************************************************************************/
 class Compilier {
 public:
+	/// A table, indexed by instruction address, yeilding source line numbers...
+	typedef std::vector<unsigned> SourceIndex;
+
 	Compilier();							///< Constructor...
 	virtual ~Compilier() {}					///< Destructor...
 
@@ -66,20 +69,27 @@ public:
 	unsigned operator()(
 		const	std::string&	fName,
 				InstrVector&	instructions,
+				DatumVector&	constants,
 				bool			lst,
 				bool			ver);
 
-protected:
-	/// A table, indexed by instruction address, yeilding source line numbers...
-	typedef std::vector<unsigned> SourceIndex;
+	/// Return the source cross-index from the last compile
+	const SourceIndex& sourceIndex() const	{	return indextbl;	}
+
+	/// Return the subroutine entry points from the last compile
+	const SubrMap& subroutines() const		{	return subrs;		}
 
+protected:
 	std::string			progName;			///< The compilier's name, used in error messages
 	unsigned			nErrors;			///< Total # of compilier errors
+	bool				endError;			///< Was the first error at the end of the input?
 	bool				verbose;			///< Dump debugging information if true
 	TokenStream			ts;					///< The input token stream (the source)
 	SymbolTable			symtbl;				///< Symbol table
 	InstrVector*		code;				///< Emitted code
+	DatumVector*		consts;				///< Emitted constant segment
 	SourceIndex			indextbl;			///< Source cross-index for listings
+	SubrMap				subrs;				///< Subroutine names, by entry point
 
 	void error(const std::string& msg);		///< Write an error message...
 
@@ -106,9 +116,15 @@ protected:
 	/// Emit a variable reference, e.g., an absolute address...
 	TDescPtr emitVarRef(int level, const SymValue& val);
 
+	/// Append values to the constant segment...
+	size_t emitConsts(const DatumVector& values);
+
 	/// Create a listing...
 	void listing(std::istream& source, std::ostream& out);
 
+	/// Write the constant segment...
+	void dumpConsts(std::ostream& out);
+
 	/// Purge symtbl of entries from a given block level
 	void purge(int level);
 
@@ -0,0 +1,140 @@
+/********************************************************************************************//**
+ * @file datasegment.cc
+ *
+ * class DataSegment implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include <new>
+#include <type_traits>
+
+#include "datasegment.h"
+
+using namespace std;
+
+// Zero filled pages are used as Datums, without construction or destruction
+static_assert(is_trivially_destructible<Datum>::value, "Datum must be trivially destructible");
+static_assert(Datum::Integer == 0, "A zeroed Datum must be an Integer 0");
+
+// private
+
+/********************************************************************************************//**
+ ************************************************************************************************/
+void DataSegment::unmap() {
+	if (data != nullptr)
+		munmap(data, length * sizeof(Datum));
+
+	data = nullptr;
+	length = guardBegin = guardEnd = 0;
+}
+
+/********************************************************************************************//**
+ * Whole pages are released (MADV_DONTNEED), so that they're faulted back in, zero filled, only
+ * if touched again; the partial pages at either end are cleared in place.
+ *
+ * @param	begin	Start of the range
+ * @param	end		One past the end of the range
+ ************************************************************************************************/
+void DataSegment::zero(size_t begin, size_t end) {
+	if (begin >= end)
+		return;
+
+	const size_t page = pageSize();
+	const size_t first = (begin + page - 1) / page * page;	// The whole pages...
+	const size_t last = end / page * page;
+
+	if (first >= last || madvise(data + first, (last - first) * sizeof(Datum), MADV_DONTNEED) != 0)
+		memset(static_cast<void*>(data + begin), 0, (end - begin) * sizeof(Datum));
+
+	else {
+		memset(static_cast<void*>(data + begin), 0, (first - begin) * sizeof(Datum));
+		memset(static_cast<void*>(data + last), 0, (end - last) * sizeof(Datum));
+	}
+}
+
+// public
+
+/********************************************************************************************//**
+ * @param	size	Size of the segment, in Datums
+ * @param	huge	Advise the use of huge pages if true
+ ************************************************************************************************/
+DataSegment::DataSegment(size_t size, bool huge)
+	: data{nullptr}, length{0}, hugePages{huge}, guardBegin{0}, guardEnd{0}
+{
+	resize(size);
+}
+
+/********************************************************************************************//**
+ ************************************************************************************************/
+DataSegment::~DataSegment()						{	unmap();	}
+
+/********************************************************************************************//**
+ * The previous contents, if any, are discarded.
+ *
+ * @param	size	Size of the new segment, in Datums
+ * @throws	std::bad_alloc if the region couldn't be mapped
+ ************************************************************************************************/
+void DataSegment::resize(size_t size) {
+	unmap();
+	if (size == 0)
+		return;
+
+	const size_t bytes = size * sizeof(Datum);
+	void* addr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+					  MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (addr == MAP_FAILED)
+		throw bad_alloc();
+
+#if defined(MADV_HUGEPAGE)
+	if (hugePages)
+		madvise(addr, bytes, MADV_HUGEPAGE);	// Just advice; ignore failures
+#endif
+
+	data = static_cast<Datum*>(addr);
+	length = size;
+}
+
+/********************************************************************************************//**
+ * @return The number of Datums in a page
+ ************************************************************************************************/
+size_t DataSegment::pageSize() {
+	static const size_t n = static_cast<size_t>(sysconf(_SC_PAGESIZE)) / sizeof(Datum);
+	return n;
+}
+
+/********************************************************************************************//**
+ * @param	addr	Start of the range to zero
+ ************************************************************************************************/
+void DataSegment::clear(size_t addr) {
+	if (guardBegin == guardEnd)
+		zero(addr, length);
+
+	else {
+		zero(addr, min(guardBegin, length));
+		zero(max(addr, guardEnd), length);
+	}
+}
+
+/********************************************************************************************//**
+ * @param	addr	Start of the guard range, a multiple of pageSize()
+ * @param	n		Size of the guard range, a multiple of pageSize()
+ * @throws	std::bad_alloc if the range couldn't be protected
+ ************************************************************************************************/
+void DataSegment::guard(size_t addr, size_t n) {
+	assert(addr % pageSize() == 0 && n % pageSize() == 0 && addr + n <= length);
+
+	if (mprotect(data + addr, n * sizeof(Datum), PROT_NONE) != 0)
+		throw bad_alloc();
+
+	guardBegin = addr;
+	guardEnd = addr + n;
+}
@@ -0,0 +1,78 @@
+/********************************************************************************************//**
+ * @file datasegment.h
+ *
+ * The P machine data segment.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	DATASEGMENT_H
+#define DATASEGMENT_H
+
+#include <cstddef>
+
+#include "datum.h"
+
+/********************************************************************************************//**
+ * A Data Segment
+ *
+ * A fixed length array of Datums, backed by an anonymous, private, mmap region that is reserved
+ * without being committed (MAP_NORESERVE), and thus lazily faulted in, a page at a time, as it's
+ * touched. Large segments, e.g., multi-gigabyte heaps, cost nothing until they're used.
+ * Optionally, the region is advised to use transparent huge pages (MADV_HUGEPAGE), reducing TLB
+ * misses.
+ *
+ * The region is initially zero, which is a valid Datum; Integer 0.
+ *
+ * A page aligned range of the segment may be made a guard; inaccessible (PROT_NONE), so that
+ * any access raises SIGSEGV.
+ ************************************************************************************************/
+class DataSegment {
+public:
+	/// Construct a data segment of size Datums...
+	explicit DataSegment(std::size_t size = 0, bool huge = false);
+	~DataSegment();							///< Destructor; unmaps the region
+
+	DataSegment(const DataSegment&) = delete;
+	DataSegment& operator=(const DataSegment&) = delete;
+
+	void resize(std::size_t size);			///< Replace the region with a new, zeroed, one...
+
+	static std::size_t pageSize();			///< Return the number of Datums in a page
+
+	/// Make [addr, addr+n) a guard range, where both are multiples of pageSize()...
+	void guard(std::size_t addr, std::size_t n);
+
+	/// Zero [addr, size()), other than the guard range...
+	void clear(std::size_t addr);
+
+	/// Is p within the guard range?
+	bool guarded(const void* p) const {
+		return p >= static_cast<const void*>(data + guardBegin) && p < static_cast<const void*>(data + guardEnd);
+	}
+
+	std::size_t size() const				{	return length;			}	///< Return my size, in Datums
+	bool huge() const						{	return hugePages;		}	///< Using huge pages?
+
+	Datum* begin()							{	return data;			}	///< Return the start
+	Datum* end()							{	return data + length;	}	///< Return one past the end
+
+	/// Return a reference to the Datum at addr
+	Datum& operator[](std::size_t addr)				{	return data[addr];	}
+
+	/// Return a reference to the Datum at addr
+	const Datum& operator[](std::size_t addr) const	{	return data[addr];	}
+
+private:
+	Datum*			data;					///< The mapped region
+	std::size_t		length;					///< Size of the region, in Datums
+	bool			hugePages;				///< Advise the use of huge pages?
+	std::size_t		guardBegin;				///< Start of the guard range
+	std::size_t		guardEnd;				///< One past the end of the guard range
+
+	void unmap();							///< Unmap the region, if any
+	void zero(std::size_t begin, std::size_t end);	///< Zero [begin, end)...
+};
+
+#endif
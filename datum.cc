@@ -9,7 +9,9 @@
 #include "datum.h"
 
 #include <cassert>
+#include <cctype>
 #include <cmath>
+#include <iomanip>
 #include <limits>
 
 #include "results.h"
@@ -68,6 +70,11 @@ Datum::Datum(size_t value) : k{Kind::Integer} {
 	i = value;
 }
 
+/********************************************************************************************//**
+ * @param	value	initial value
+ ************************************************************************************************/
+Datum::Datum(int64_t value) : l{value}, k{Kind::LongInt}		{}
+
 /********************************************************************************************//**
  * @param	value	initial value
  ************************************************************************************************/
@@ -83,6 +90,7 @@ Datum& Datum::operator=(const Datum& rhs) {
 		case Kind::Boolean:		b = rhs.boolean();		break;
 		case Kind::Character:	c = rhs.character();	break;
 		case Kind::Integer:		i = rhs.integer();		break;
+		case Kind::LongInt:		l = rhs.longint();		break;
 		case Kind::Real:		r = rhs.real();			break;
 		default:				assert(false && "unknown Datum::Kind!");
 		}
@@ -101,6 +109,7 @@ Datum& Datum::operator=(Datum&& rhs) {
 		case Kind::Boolean:		b = rhs.boolean();		break;
 		case Kind::Character:	c = rhs.character();	break;
 		case Kind::Integer:		i = rhs.integer();		break;
+		case Kind::LongInt:		l = rhs.longint();		break;
 		case Kind::Real:		r = rhs.real();			break;
 		default:				assert(false && "unknown Datum::Kind!");
 		}
@@ -155,6 +164,12 @@ Datum& Datum::operator=(size_t rhs) {
 	return *this = Datum(rhs);
 }
 
+/********************************************************************************************//**
+ * @param	rhs		new value, and type
+ * @return	*this, which is now a LongInt
+ ************************************************************************************************/
+Datum& Datum::operator=(int64_t rhs)		{	return *this = Datum(rhs);	}
+
 /********************************************************************************************//**
  * @param	rhs		new value, and type
  * @return	*this, which is now a Real
@@ -173,6 +188,7 @@ Datum Datum::operator!() const				{	return Datum(!b);	}
 Datum Datum::operator-() const {
 	switch(kind()) {
 	case Datum::Integer:	return Datum(-i);
+	case Datum::LongInt:	return Datum(-l);
 	case Datum::Real:		return Datum(-r);
 	default: throw Result::illegalOp;
 	}
@@ -183,7 +199,10 @@ Datum Datum::operator-() const {
  * @return	modified copy of this
  ************************************************************************************************/
 Datum Datum::operator~() const {
-	if (kind() != Kind::Integer)
+	if (kind() == Kind::LongInt)
+		return Datum(~l);
+
+	else if (kind() != Kind::Integer)
 		throw Result::illegalOp;
 
 	return Datum(~i);
@@ -196,6 +215,7 @@ Datum Datum::operator~() const {
 Datum& Datum::operator++() {
 	switch(kind()) {
 	case Kind::Integer:	++i;	break;
+	case Kind::LongInt:	++l;	break;
 	case Kind::Real:	++r;	break;
 	default: throw Result::illegalOp;
 	}
@@ -210,6 +230,7 @@ Datum& Datum::operator++() {
 Datum& Datum::operator--() {
 	switch(kind()) {
 	case Kind::Integer:	--i;	break;
+	case Kind::LongInt:	--l;	break;
 	case Kind::Real:	--r;	break;
 	default: throw Result::illegalOp;
 	}
@@ -226,6 +247,7 @@ Datum Datum::operator++(int) {
 
 	switch(kind()) {
 	case Kind::Integer:	++i;	break;
+	case Kind::LongInt:	++l;	break;
 	case Kind::Real:	++r;	break;
 	default: throw Result::illegalOp;
 	}
@@ -242,6 +264,7 @@ Datum Datum::operator--(int) {
 
 	switch(kind()) {
 	case Kind::Integer:	--i;	break;
+	case Kind::LongInt:	--l;	break;
 	case Kind::Real:	--r;	break;
 	default: throw Result::illegalOp;
 	}
@@ -260,6 +283,7 @@ Datum& Datum::operator+=(const Datum& rhs) {
 
 	switch(kind()) {
 	case Kind::Integer:	i += rhs.integer();	break;
+	case Kind::LongInt:	l += rhs.longint();	break;
 	case Kind::Real:	r += rhs.real();	break;
 	default: throw Result::illegalOp;
 	}
@@ -278,6 +302,7 @@ Datum& Datum::operator-=(const Datum& rhs) {
 
 	switch(kind()) {
 	case Kind::Integer:	i -= rhs.integer();	break;
+	case Kind::LongInt:	l -= rhs.longint();	break;
 	case Kind::Real:	r -= rhs.real();	break;
 	default: throw Result::illegalOp;
 	}
@@ -296,6 +321,7 @@ Datum& Datum::operator*=(const Datum& rhs) {
 
 	switch(kind()) {
 	case Kind::Integer:	i *= rhs.integer();	break;
+	case Kind::LongInt:	l *= rhs.longint();	break;
 	case Kind::Real:	r *= rhs.real();	break;
 	default: throw Result::illegalOp;
 	}
@@ -318,6 +344,7 @@ Datum& Datum::operator/=(const Datum& rhs) {
 	
 	switch(kind()) {
 	case Kind::Integer:	i /= rhs.integer();	break;
+	case Kind::LongInt:	l /= rhs.longint();	break;
 	case Kind::Real:	r /= rhs.real();	break;
 	default: throw Result::illegalOp;
 	}
@@ -340,6 +367,7 @@ Datum& Datum::operator%=(const Datum& rhs) {
 
 	switch(kind()) {
 	case Kind::Integer:	i %= rhs.integer();				break;
+	case Kind::LongInt:	l %= rhs.longint();				break;
 	case Kind::Real:	r = remainder(r,rhs.real());	break;
 	default: throw Result::illegalOp;
 	}
@@ -353,13 +381,17 @@ Datum& Datum::operator%=(const Datum& rhs) {
  * @return	*this
  ************************************************************************************************/
 Datum& Datum::operator&=(const Datum& rhs) {
-	if (kind() != Kind::Integer || rhs.kind() != Kind::Integer)
+	if (!integral() || kind() != rhs.kind())
 		throw Result::illegalOp;
 
-	else if (i < 0 || rhs.integer() < 0)
+	else if (longint() < 0 || rhs.longint() < 0)
 		throw Result::illegalOp;
 
-	i &= rhs.natural();
+	else if (kind() == Kind::LongInt)
+		l &= rhs.longint();
+
+	else
+		i &= rhs.natural();
 
 	return *this;
 }
@@ -370,13 +402,17 @@ Datum& Datum::operator&=(const Datum& rhs) {
  * @return	*this
  ************************************************************************************************/
 Datum& Datum::operator|=(const Datum& rhs) {
-	if (kind() != Kind::Integer || rhs.kind() != Kind::Integer)
+	if (!integral() || kind() != rhs.kind())
 		throw Result::illegalOp;
 
-	else if (i < 0 || rhs.integer() < 0)
+	else if (longint() < 0 || rhs.longint() < 0)
 		throw Result::illegalOp;
 
-	i |= rhs.natural();
+	else if (kind() == Kind::LongInt)
+		l |= rhs.longint();
+
+	else
+		i |= rhs.natural();
 
 	return *this;
 }
@@ -387,13 +423,17 @@ Datum& Datum::operator|=(const Datum& rhs) {
  * @return	*this
  ************************************************************************************************/
 Datum& Datum::operator^=(const Datum& rhs) {
-	if (kind() != Kind::Integer || rhs.kind() != Kind::Integer)
+	if (!integral() || kind() != rhs.kind())
 		throw Result::illegalOp;
 
-	else if (i < 0 || rhs.integer() < 0)
+	else if (longint() < 0 || rhs.longint() < 0)
 		throw Result::illegalOp;
 
-	i ^= rhs.natural();
+	else if (kind() == Kind::LongInt)
+		l ^= rhs.longint();
+
+	else
+		i ^= rhs.natural();
 
 	return *this;
 }
@@ -405,13 +445,17 @@ Datum& Datum::operator^=(const Datum& rhs) {
  * @return lhs << rhs
  ************************************************************************************************/
 Datum& Datum::operator>>=(const Datum& rhs) {
-	if (kind() != Kind::Integer || rhs.kind() != Kind::Integer)
+	if (!integral() || kind() != rhs.kind())
 		throw Result::illegalOp;
 
-	else if (integer() < 0 || rhs.integer() < 0)
+	else if (longint() < 0 || rhs.longint() < 0)
 		throw Result::illegalOp;
 
-	i >>= rhs.natural();
+	else if (kind() == Kind::LongInt)
+		l >>= rhs.natural();
+
+	else
+		i >>= rhs.natural();
 
 	return *this;
 }
@@ -423,13 +467,17 @@ Datum& Datum::operator>>=(const Datum& rhs) {
  * @return lhs << rhs
  ************************************************************************************************/
 Datum& Datum::operator<<=(const Datum& rhs) {
-	if (kind() != Kind::Integer || rhs.kind() != Kind::Integer)
+	if (!integral() || kind() != rhs.kind())
 		throw Result::illegalOp;
 
-	else if (integer() < 0 || rhs.integer() < 0)
+	else if (longint() < 0 || rhs.longint() < 0)
 		throw Result::illegalOp;
 
-	i <<= rhs.natural();
+	else if (kind() == Kind::LongInt)
+		l <<= rhs.natural();
+
+	else
+		i <<= rhs.natural();
 
 	return *this;
 }
@@ -473,19 +521,41 @@ int Datum::integer() const {
 }
 
 /********************************************************************************************//**
- * @throws	Result::illegalOp if my value is negative
+ * @throws	Result::illegalOp if my value is negative, or exceeds the maximum unsigned value
  * @return my interger value
  ************************************************************************************************/
 unsigned Datum::natural() const {
+	if (kind() == Kind::LongInt) {
+		if (l < 0 || l > numeric_limits<unsigned>::max())
+			throw Result::illegalOp;
+		return l;
+	}
+
 	if (i < 0)
 		throw Result::illegalOp;
 
 	return i;
 }
 
+/********************************************************************************************//**
+ * @throws	Result::illegalOp if type isn't an integer or long integer
+ * @note will convert an integer to a long integer.
+ * @return my long integer value
+ ************************************************************************************************/
+int64_t Datum::longint() const {
+	if (kind() == Datum::LongInt)
+		return l;
+
+	else if (kind() == Datum::Integer)
+		return i;
+
+	else
+		throw Result::illegalOp;
+}
+
 /********************************************************************************************//**
  * @throws	Result::illegalOp if type is non-numeric
- * @note will convert an integer to a real.
+ * @note will convert an integer, or long integer, to a real.
  * @return my real value
  ************************************************************************************************/
 double Datum::real() const {
@@ -495,14 +565,22 @@ double Datum::real() const {
 	else if (kind() == Datum::Integer)
 		return i * 1.0;
 
+	else if (kind() == Datum::LongInt)
+		return l * 1.0;
+
 	else
 		throw Result::illegalOp;
 }
 
+/********************************************************************************************//**
+ * @return true if my value is an integer, or a long integer
+ ************************************************************************************************/
+bool Datum::integral() const				{	return kind() == Integer || kind() == LongInt;	}
+
 /********************************************************************************************//**
  * @return true if my value is numeric
  ************************************************************************************************/
-bool Datum::numeric() const					{	return kind() == Integer || kind() == Real;	}
+bool Datum::numeric() const					{	return integral() || kind() == Real;	}
 
 /********************************************************************************************//**
  * @return true if my value is an ordinal type
@@ -515,6 +593,7 @@ bool Datum::ordinal() const					{	return kind() != Real;	}
 bool Datum::zero() const {
 	switch(kind()) {
 		case Kind::Integer:	return i == 0;
+		case Kind::LongInt:	return l == 0;
 		case Kind::Real:	return r == 0.0;
 
 		default:			return false;
@@ -526,7 +605,8 @@ bool Datum::zero() const {
 /********************************************************************************************//**
  * @brief Datum::Kind stream put operator
  *
- * Puts Datum value on os per it's discriminator. 
+ * Puts Datum value on os per it's discriminator. Characters are quoted, with non-printable
+ * characters, quotes and backslashes escaped, as in C.
  *
  * @param	os		Stream to write kind on
  * @param	kind	Value to write on os
@@ -538,6 +618,7 @@ ostream& operator<<(std::ostream& os, const Datum::Kind& kind) {
 	case Datum::Character:	return os << "Character";	break;
 	case Datum::Integer:	return os << "Integer";		break;
 	case Datum::Real:		return os << "Real";		break;
+	case Datum::LongInt:	return os << "LongInt";		break;
 	default:
 		assert(false);
 		return os << "Unknown Datum Kind!";
@@ -556,8 +637,29 @@ ostream& operator<<(std::ostream& os, const Datum::Kind& kind) {
 ostream& operator<<(std::ostream& os, const Datum& value) {
 	switch (value.kind()) {
 	case Datum::Boolean:	return os << value.boolean();
-	case Datum::Character:	return os << "'" << value.character() << "'";
+	case Datum::Character: {
+		const unsigned char c = value.character();
+		os << "'";
+		switch (c) {
+		case '\0':	os << "\\0";		break;
+		case '\t':	os << "\\t";		break;
+		case '\n':	os << "\\n";		break;
+		case '\r':	os << "\\r";		break;
+		case '\\':	os << "\\\\";		break;
+		case '\'':	os << "\\'";		break;
+		default:
+			if (isprint(c))
+				os << c;
+			else {
+				const auto flags = os.flags();
+				os << "\\x" << hex << setw(2) << setfill('0') << static_cast<unsigned>(c) << setfill(' ');
+				os.flags(flags);
+			}
+		}
+		return os << "'";
+	}
 	case Datum::Integer:	return os << value.integer();
+	case Datum::LongInt:	return os << value.longint();
 	case Datum::Real:		return os << value.real();
 	default: assert(false); return os << 0;
 	}
@@ -698,6 +800,7 @@ bool operator<(const Datum& lhs, const Datum& rhs) {
 	case Datum::Boolean:	return lhs.boolean()	< rhs.boolean();
 	case Datum::Character:	return lhs.character()	< rhs.character();
 	case Datum::Integer:	return lhs.integer()	< rhs.integer();
+	case Datum::LongInt:	return lhs.longint()	< rhs.longint();
 	case Datum::Real:		return lhs.real()		< rhs.real();
 	default:				assert(false); return false;
 	}
@@ -719,6 +822,7 @@ bool operator==(const Datum& lhs, const Datum& rhs) {
 	case Datum::Boolean:	return lhs.boolean()	== rhs.boolean();
 	case Datum::Character:	return lhs.character()	== rhs.character();
 	case Datum::Integer:	return lhs.integer()	== rhs.integer();
+	case Datum::LongInt:	return lhs.longint()	== rhs.longint();
 	case Datum::Real:		return lhs.real()		== rhs.real();
 	default:				assert(false); return false;
 	}
@@ -10,6 +10,7 @@
 #ifndef	DATUM_H
 #define DATUM_H
 
+#include <cstdint>
 #include <iostream>
 #include <utility>
 #include <vector>
@@ -17,23 +18,25 @@
 /********************************************************************************************//**
  * A Data Value
  * 
- * A Datum is a discriminated union, containing either a boolean, character, signed integer or
- * a floating point (real) value.
+ * A Datum is a discriminated union, containing either a boolean, character, signed integer,
+ * 64-bit signed integer (long integer) or a floating point (real) value.
  * 
  * The discriminator is set by the constructors and overwritten via assignement, but enforced by
  * the other operators, e.g, throws a Datum::Error on bitwise operators on Real vlaues.
  * 
  * Convertsion between types is limited to signed and unsigned intergers, as long as signed
- * values are limited from 0..std::numeric_limits<int>::max().
+ * values are limited from 0..std::numeric_limits<int>::max(), and the widening of Integers to
+ * LongInts or Reals. Arithmetic operands must have the same kind.
  ************************************************************************************************/
 class Datum {
 public:
-	/// Datum "kinds"
+	/// Datum "kinds"; Integer is first, so that zeroed memory reads as Integer 0
 	enum Kind {
+		Integer,							///< Signed integer
 		Boolean,							///< Boolean value
 		Character,							///< Character (ASCII) value
-		Integer,							///< Signed integer
-		Real								///< Floating point
+		Real,								///< Floating point
+		LongInt								///< 64-bit signed integer
 	};
 
 	Datum();								///< Default constructor...
@@ -45,8 +48,9 @@ public:
 	explicit Datum(int value);				///< Construct a Integer...
 	explicit Datum(unsigned value);			///< Construct a Integer...
 	explicit Datum(size_t value);			///< Construct a Integer...
+	explicit Datum(int64_t value);			///< Construct a LongInt...
 	explicit Datum(double value);			///< Construct a Double...
-	virtual ~Datum() {}						///< Destructor
+	~Datum() = default;						///< Destructor
 
 	Datum& operator=(const Datum& value);	///< Assignment...
 	Datum& operator=(Datum&& value);		///< Move assignment...
@@ -56,6 +60,7 @@ public:
 	Datum& operator=(int value);			///< Assignment (Integer)...
 	Datum& operator=(unsigned value);		///< Assignment (Integer)...
 	Datum& operator=(size_t value);			///< Assignment (Integer)...
+	Datum& operator=(int64_t value);		///< Assignment (LongInt)...
 	Datum& operator=(double value);			///< Assignment (Real)...
 
 	Datum operator!() const;				///< Unary boolean negation...
@@ -86,8 +91,10 @@ public:
 	char character() const;					///< Return my Character...
 	int integer() const;					///< Return my Integer value...
 	unsigned natural() const;				///< Return my Integer value, but as an unsigned
+	int64_t longint() const;				///< Return my LongInt value...
 	double real() const;					///< Return my Real value...
 
+	bool integral() const;					///< Return true if value is an Integer or LongInt...
 	bool numeric() const;					///< Return true if value is numeric...
 	bool ordinal() const;					///< Return true if value is ordinal...
 	bool zero() const;						///< Return true if value is equal to zero...
@@ -97,6 +104,7 @@ private:
 		bool		b;						///< if k == Boolean
 		char		c;						///< if k == Character
 		int			i;						///< if k == Integer
+		int64_t		l;						///< if k == LongInt
 		double		r;						///< if k == Real
 	};
 	Kind			k;  					///< What Datum type?
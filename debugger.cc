@@ -0,0 +1,223 @@
+/********************************************************************************************//**
+ * @file debugger.cc
+ *
+ * class Debugger implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include <cctype>
+#include <cstdlib>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+
+#include "debugger.h"
+
+using namespace std;
+
+// private
+
+/********************************************************************************************//**
+ * @param		arg		An address, a subroutine name, or :line
+ * @param[out]	addr	The code address
+ * @return	false if arg isn't a valid location
+ ************************************************************************************************/
+bool Debugger::where(const string& arg, size_t& addr) {
+	const size_t size = machine.loaded()->code().size();
+
+	if (arg.empty())
+		return false;
+
+	else if (arg[0] == ':') {				// :line; the first instruction of the line
+		const unsigned line = strtoul(arg.c_str() + 1, nullptr, 10);
+		for (addr = 0; addr < index.size() && addr < size; ++addr)
+			if (index[addr] == line)
+				return true;
+		return false;
+
+	} else if (isdigit(arg[0])) {
+		addr = strtoul(arg.c_str(), nullptr, 10);
+		return addr < size;
+
+	} else {								// subroutine name
+		for (const auto& subr : subrs)
+			if (subr.second == arg && subr.first < size) {
+				addr = subr.first;
+				return true;
+			}
+		return false;
+	}
+}
+
+/********************************************************************************************//**
+ * Execute the next instruction; if it's a breakpoint, restore the original instruction, execute
+ * it, and put the breakpoint back.
+ *
+ * @return	The instruction's result
+ ************************************************************************************************/
+Result Debugger::next() {
+	const size_t pc = machine.pcReg();
+	const auto it = breaks.find(pc);
+
+	if (it == breaks.end())
+		status = machine.single();
+
+	else {
+		machine.patch(pc, it->second);
+		status = machine.single();
+		machine.patch(pc, Instr(OpCode::BREAK));
+	}
+
+	return status;
+}
+
+/********************************************************************************************//**
+ * Report where, and why, the machine stopped
+ ************************************************************************************************/
+void Debugger::stopped() {
+	const size_t pc = machine.pcReg();
+	const InstrVector& code = machine.loaded()->code();
+
+	switch (status) {
+	case Result::halted:
+		out << "program halted after " << machine.cycles() << " machine cycles\n";
+		return;
+
+	case Result::success:
+		break;
+
+	case Result::breakpoint:
+		out << "breakpoint, ";
+		break;
+
+	default:
+		out << "stopped, " << status << ", ";
+		break;
+	}
+
+	const auto subr = subrs.upper_bound(pc);
+	if (subr != subrs.begin())
+		out << prev(subr)->second << ", ";
+	if (pc < index.size())
+		out << "line " << index[pc] << ", ";
+	out << machine.cycles() << " cycles\n";
+
+	if (pc < code.size())
+		disasm(out, pc, code[pc], "pc");
+}
+
+/********************************************************************************************//**
+ * @param	line	The command line
+ * @return	false if the command was quit
+ ************************************************************************************************/
+bool Debugger::command(const string& line) {
+	istringstream iss(line);
+	string cmd, arg;
+	iss >> cmd >> arg;
+
+	const bool running = status == Result::success || status == Result::breakpoint;
+	size_t addr = 0;
+
+	if (cmd.empty())
+		;
+
+	else if (cmd == "q" || cmd == "quit")
+		return false;
+
+	else if (cmd == "b" || cmd == "break") {
+		if (!where(arg, addr))
+			out << "invalid location '" << arg << "'\n";
+		else if (breaks.find(addr) == breaks.end()) {
+			breaks[addr] = machine.patch(addr, Instr(OpCode::BREAK));
+			out << "breakpoint at " << addr << "\n";
+		}
+
+	} else if (cmd == "d" || cmd == "delete") {
+		const auto it = where(arg, addr) ? breaks.find(addr) : breaks.end();
+		if (it == breaks.end())
+			out << "no breakpoint at '" << arg << "'\n";
+		else {
+			machine.patch(addr, it->second);
+			breaks.erase(it);
+		}
+
+	} else if (cmd == "i" || cmd == "info") {
+		for (const auto& brk : breaks)
+			disasm(out, brk.first, brk.second);
+
+	} else if (!running && (cmd == "c" || cmd == "continue" || cmd == "s" || cmd == "step"))
+		out << "the program isn't running\n";
+
+	else if (cmd == "c" || cmd == "continue") {
+		if (next() == Result::success)
+			status = machine.run();
+		stopped();
+
+	} else if (cmd == "s" || cmd == "step") {
+		unsigned n = arg.empty() ? 1 : strtoul(arg.c_str(), nullptr, 10);
+		while (n-- > 0 && next() == Result::success)
+			;
+		stopped();
+
+	} else if (cmd == "f" || cmd == "frame")
+		machine.frame(out);
+
+	else if (cmd == "p" || cmd == "print") {
+		unsigned n = 1;
+		iss >> n;
+
+		Datum value;
+		for (addr = strtoul(arg.c_str(), nullptr, 10); n-- > 0; ++addr)
+			if (machine.read(addr, value))
+				out << "    " << setw(5) << addr << ": " << setw(10) << value << "\n";
+			else {
+				out << "invalid address " << addr << "\n";
+				break;
+			}
+
+	} else
+		out << "unknown command '" << cmd << "'; break, delete, info, continue, step, frame, print or quit\n";
+
+	return true;
+}
+
+// public
+
+/********************************************************************************************//**
+ * @param	machine	The machine to debug on
+ * @param	index	The source line of each instruction
+ * @param	subrs	The subroutine names, by entry point
+ * @param	in		Command input, apart from the program's standard input
+ * @param	out		Command output
+ ************************************************************************************************/
+Debugger::Debugger(	PInterp&				machine,
+					const vector<unsigned>&	index,
+					const SubrMap&			subrs,
+					istream&				in,
+					ostream&				out)
+	: machine(machine), index{index}, subrs{subrs}, in(in), out(out), status{Result::success}
+{
+}
+
+/********************************************************************************************//**
+ * Load program, and then read, and execute, commands until quit, or the end of input.
+ *
+ * @param	program	The program to debug
+ * @return	Result::success if the program ran to completion, or was quit, or its fault
+ ************************************************************************************************/
+Result Debugger::operator()(ProgramPtr program) {
+	machine.load(program);
+	breaks.clear();
+	status = Result::success;
+
+	stopped();
+
+	string line;
+	for (out << "(pdb) " << flush; getline(in, line); out << "(pdb) " << flush)
+		if (!command(line))
+			break;
+
+	return status == Result::halted || status == Result::breakpoint ? Result::success : status;
+}
@@ -0,0 +1,70 @@
+/********************************************************************************************//**
+ * @file debugger.h
+ *
+ * A breakpoint debugger for the P machine.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	DEBUGGER_H
+#define DEBUGGER_H
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "interp.h"
+
+/********************************************************************************************//**
+ * A Breakpoint Debugger
+ *
+ * Breakpoints are set by patching the target instruction with BREAK, so the program runs at full
+ * speed between breakpoints. On continuing from a breakpoint, the original instruction is
+ * restored, executed, and the BREAK put back. The first patch gives the machine a private copy
+ * of the code, so a shared program is never modified.
+ *
+ * Commands are read from in, one per line; in must not be the program's standard input, which
+ * GET reads, or commands, and input, would be interleaved:
+ *
+ * Command              | Action
+ * -------------------- | ---------------------------------------------------------
+ * b[reak] where        | Set a breakpoint at an address, subroutine, or :line
+ * d[elete] where       | Delete a breakpoint
+ * i[nfo]               | List the breakpoints
+ * c[ontinue]           | Run to the next breakpoint, or the end of the program
+ * s[tep] [n]           | Execute n, default 1, instructions
+ * f[rame]              | Write the current activation frame, as --trace does
+ * p[rint] addr [n]     | Write n, default 1, Datums starting at addr
+ * q[uit]               | Stop debugging
+ ************************************************************************************************/
+class Debugger {
+public:
+	/// Construct a debugger for machine...
+	Debugger(	PInterp&					machine,
+				const std::vector<unsigned>&	index,
+				const SubrMap&				subrs,
+				std::istream&				in,
+				std::ostream&				out = std::cout);
+	virtual ~Debugger() {}
+
+	/// Debug a program...
+	Result operator()(ProgramPtr program);
+
+private:
+	PInterp&				machine;		///< The machine being debugged
+	std::vector<unsigned>	index;			///< Source line numbers, by instruction address
+	SubrMap					subrs;			///< Subroutine names, by entry point
+	std::istream&			in;				///< Command input
+	std::ostream&			out;			///< Command output
+	std::map<size_t, Instr>	breaks;			///< Original instructions, by breakpoint address
+	Result					status;			///< The machine's last result
+
+	bool where(const std::string& arg, size_t& addr);	///< Parse a breakpoint location
+	Result next();							///< Execute one instruction, stepping over a breakpoint
+	void stopped();							///< Report where the machine stopped
+	bool command(const std::string& line);	///< Execute a command
+};
+
+#endif
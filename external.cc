@@ -0,0 +1,239 @@
+/********************************************************************************************//**
+ * @file external.cc
+ *
+ * class External implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include <dlfcn.h>
+
+#include <cassert>
+#include <map>
+
+#include "external.h"
+
+using namespace std;
+
+/// A C function returning an integer, or nothing
+typedef int64_t (*IntFunction)(	int64_t, int64_t, int64_t, int64_t, int64_t, int64_t,
+								double, double, double, double, double, double, double, double);
+
+/// A C function returning a real
+typedef double (*RealFunction)(	int64_t, int64_t, int64_t, int64_t, int64_t, int64_t,
+								double, double, double, double, double, double, double, double);
+
+/********************************************************************************************//**
+ * @param	datum	A Boolean, Character, Integer or LongInt
+ * @throws	Result::illegalOp if datum is a Real
+ * @return	datum's value, as an integer
+ ************************************************************************************************/
+static int64_t integral(const Datum& datum) {
+	switch (datum.kind()) {
+	case Datum::Boolean:	return datum.boolean();
+	case Datum::Character:	return datum.character();
+	default:				return datum.longint();
+	}
+}
+
+// private static
+
+vector<External> External::bindings;
+
+// public static
+
+/********************************************************************************************//**
+ * Libraries are opened once, and never closed. The empty library name refers to the
+ * interpreter itself, and the libraries it's linked with, e.g., the C library.
+ *
+ * @param		library		The shared library's file name
+ * @param		symbol		The C function's name
+ * @param		params		The parameters
+ * @param		function	Returns a value?
+ * @param		result		The kind of the return value, if function
+ * @param[out]	error		Why the binding failed
+ *
+ * @return	The binding's index, or size() if the library, or symbol, couldn't be found
+ ************************************************************************************************/
+size_t External::bind(	const	string&		library,
+						const	string&		symbol,
+						const	ParamVec&	params,
+								bool		function,
+								Datum::Kind	result,
+								string&		error)
+{
+	static map<string, void*> handles;		// Open libraries, by name
+
+	unsigned nInts = 0, nReals = 0;
+	for (const auto& param : params)
+		if (param.kind == Datum::Real && !param.array && !param.ref)
+			++nReals;
+		else
+			++nInts;
+
+	if (nInts > MaxInts || nReals > MaxReals) {
+		error = "too many parameters for an external subroutine";
+		return size();
+	}
+
+#if !defined(__x86_64__) && !defined(__aarch64__)
+	error = "external subroutines aren't supported on this platform";
+	return size();
+#endif
+
+	void*& handle = handles[library];
+	if (handle == nullptr)
+		handle = dlopen(library.empty() ? nullptr : library.c_str(), RTLD_NOW);
+	if (handle == nullptr) {
+		error = dlerror();
+		return size();
+	}
+
+	dlerror();								// Clear any previous error
+	void* const sym = dlsym(handle, symbol.c_str());
+	if (sym == nullptr) {
+		const char* const msg = dlerror();
+		error = msg != nullptr ? msg : "undefined symbol: " + symbol;
+		return size();
+	}
+
+	External ext;
+	ext.lib = library;
+	ext.symbol = symbol;
+	ext.fn = reinterpret_cast<Function>(sym);
+	ext._params = params;
+	ext._function = function;
+	ext.result = result;
+	bindings.push_back(ext);
+
+	return bindings.size() - 1;
+}
+
+/********************************************************************************************//**
+ * @return	The number of bindings
+ ************************************************************************************************/
+size_t External::size()								{	return bindings.size();		}
+
+/********************************************************************************************//**
+ * @param	index	A binding index, as returned by bind()
+ * @return	The binding
+ ************************************************************************************************/
+const External& External::at(size_t index)			{	return bindings.at(index);	}
+
+// public
+
+/********************************************************************************************//**
+ * @return	The number of stack Datums the parameters occupy
+ ************************************************************************************************/
+size_t External::stackSize() const {
+	size_t n = 0;
+	for (const auto& param : _params)
+		n += param.size();
+
+	return n;
+}
+
+/********************************************************************************************//**
+ * @param	args	The first element of each argument, in P machine memory. Each array, or var
+ *					parameter, must have param.count valid elements.
+ * @throws	Result::illegalOp if an argument isn't of the parameter's kind
+ * @return	The return value, if function(), otherwise Datum(0)
+ ************************************************************************************************/
+Datum External::call(const ArgVec& args) const {
+	assert(args.size() == _params.size());
+
+	/// Converted copies of an array, or var, argument; just one is used, depending on kind
+	struct Buffer {
+		vector<int>		ints;
+		vector<char>	chars;
+		vector<int64_t>	longs;
+		vector<double>	reals;
+	};
+
+	int64_t ints[MaxInts] = {};				// The integer, and pointer, arguments
+	double reals[MaxReals] = {};			// The real arguments
+	unsigned nInts = 0, nReals = 0;
+	vector<Buffer> buffers(_params.size());
+
+	for (size_t k = 0; k < _params.size(); ++k) {
+		const Param& param = _params[k];
+		const Datum* const arg = args[k];
+		Buffer& buf = buffers[k];
+
+		if (!param.array && !param.ref) {	// Passed by value, in a register
+			if (param.kind == Datum::Real)
+				reals[nReals++] = arg->real();
+			else
+				ints[nInts++] = integral(*arg);
+			continue;
+		}
+
+		void* ptr = nullptr;				// Passed as a pointer to a converted copy
+		switch (param.kind) {
+		case Datum::Real:
+			for (size_t i = 0; i < param.count; ++i)
+				buf.reals.push_back(arg[i].real());
+			ptr = buf.reals.data();
+			break;
+
+		case Datum::LongInt:
+			for (size_t i = 0; i < param.count; ++i)
+				buf.longs.push_back(arg[i].longint());
+			ptr = buf.longs.data();
+			break;
+
+		case Datum::Character:				// NUL terminated, for C string functions
+			for (size_t i = 0; i < param.count; ++i)
+				buf.chars.push_back(integral(arg[i]));
+			buf.chars.push_back('\0');
+			ptr = buf.chars.data();
+			break;
+
+		default:							// Boolean, or Integer
+			for (size_t i = 0; i < param.count; ++i)
+				buf.ints.push_back(integral(arg[i]));
+			ptr = buf.ints.data();
+			break;
+		}
+		ints[nInts++] = reinterpret_cast<intptr_t>(ptr);
+	}
+
+	Datum value(0);
+	if (_function && result == Datum::Real)
+		value = reinterpret_cast<RealFunction>(fn)(
+			ints[0], ints[1], ints[2], ints[3], ints[4], ints[5],
+			reals[0], reals[1], reals[2], reals[3], reals[4], reals[5], reals[6], reals[7]);
+
+	else {
+		const int64_t r = reinterpret_cast<IntFunction>(fn)(
+			ints[0], ints[1], ints[2], ints[3], ints[4], ints[5],
+			reals[0], reals[1], reals[2], reals[3], reals[4], reals[5], reals[6], reals[7]);
+
+		if (_function)
+			switch (result) {
+			case Datum::Boolean:	value = Datum(static_cast<unsigned char>(r) != 0);	break;
+			case Datum::Character:	value = Datum(static_cast<char>(r));			break;
+			case Datum::LongInt:	value = Datum(r);								break;
+			default:				value = Datum(static_cast<int>(r));				break;
+			}
+	}
+
+	for (size_t k = 0; k < _params.size(); ++k) {	// Copy back var parameters
+		const Param& param = _params[k];
+		const Buffer& buf = buffers[k];
+		Datum* const arg = args[k];
+
+		if (param.ref)
+			for (size_t i = 0; i < param.count; ++i)
+				switch (param.kind) {
+				case Datum::Real:		arg[i] = Datum(buf.reals[i]);			break;
+				case Datum::LongInt:	arg[i] = Datum(buf.longs[i]);			break;
+				case Datum::Character:	arg[i] = Datum(buf.chars[i]);			break;
+				case Datum::Boolean:	arg[i] = Datum(buf.ints[i] != 0);		break;
+				default:				arg[i] = Datum(buf.ints[i]);			break;
+				}
+	}
+
+	return value;
+}
@@ -0,0 +1,96 @@
+/********************************************************************************************//**
+ * @file external.h
+ *
+ * External, native C, subroutines.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	EXTERNAL_H
+#define EXTERNAL_H
+
+#include <string>
+#include <vector>
+
+#include "datum.h"
+
+/********************************************************************************************//**
+ * An External Subroutine
+ *
+ * A P procedure, or function, declared "is external", bound to a C function in a shared library,
+ * loaded via dlopen(). The compiler binds each external, and emits CALLX with the binding's
+ * index; CALLX passes the parameters, as located on the stack, to call().
+ *
+ * Parameters are marshaled from Datums by kind; Boolean and Integer as int, Character as char,
+ * LongInt as int64_t, and Real as double. Arrays, and var parameters, are passed as pointers to
+ * converted buffers, which are copied back, after the call, for var parameters.
+ *
+ * The call is made through a function pointer taking MaxInts integer, and MaxReals double,
+ * arguments; the integer, and pointer, arguments are passed in order in the integer registers,
+ * and the reals in the floating point registers, as the x86-64 and AArch64 C calling
+ * conventions do for any function with no more than that many of each.
+ ************************************************************************************************/
+class External {
+public:
+	enum Limits {
+		MaxInts		= 6,					///< Maximum number of integer, or pointer, parameters
+		MaxReals	= 8						///< Maximum number of real parameters
+	};
+
+	/// A parameter description
+	struct Param {
+		Datum::Kind		kind;				///< The kind of each element
+		size_t			count;				///< Number of elements
+		bool			array;				///< Passed as a pointer to count elements?
+		bool			ref;				///< A var parameter, copied back after the call?
+
+		/// Return the number of stack Datums the parameter occupies
+		size_t size() const					{	return ref ? 1 : count;		}
+	};
+
+	typedef std::vector<Param> ParamVec;	///< A vector of parameter descriptions
+
+	/// A located argument; its first element, in P machine memory
+	typedef std::vector<Datum*> ArgVec;
+
+	/// Bind a subroutine to a symbol in a shared library...
+	static size_t bind(	const	std::string&	library,
+						const	std::string&	symbol,
+						const	ParamVec&		params,
+								bool			function,
+								Datum::Kind		result,
+								std::string&	error);
+
+	static size_t size();					///< Return the number of bindings
+	static const External& at(size_t index);	///< Return a binding
+
+	const std::string& library() const		{	return lib;			}	///< Return the library name
+	const std::string& name() const			{	return symbol;		}	///< Return the symbol name
+	const ParamVec& params() const			{	return _params;		}	///< Return the parameters
+	bool function() const					{	return _function;	}	///< Returns a value?
+	Datum::Kind returns() const				{	return result;		}	///< Return the result's kind
+
+	/// Return the number of stack Datums the parameters occupy
+	size_t stackSize() const;
+
+	/// Call the function, with the located arguments...
+	Datum call(const ArgVec& args) const;
+
+private:
+	/// A generic C function; the integer, and then the real, arguments
+	typedef void (*Function)();
+
+	static std::vector<External>	bindings;	///< Every binding, by index
+
+	std::string		lib;					///< The shared library's file name
+	std::string		symbol;					///< The C function's name
+	Function		fn;						///< The C function
+	ParamVec		_params;				///< The parameters
+	bool			_function;				///< Returns a value?
+	Datum::Kind		result;					///< The kind of the return value
+
+	External() : fn{nullptr}, _function{false}, result{Datum::Integer} {}
+};
+
+#endif
@@ -46,6 +46,42 @@ size_t FreeStore::addr() const					{	return initAddr;	}
  ************************************************************************************************/
 size_t FreeStore::size() const					{	return initSize;	}
 
+/********************************************************************************************//**
+ * @return The total size of the allocated blocks, in Datums
+ ************************************************************************************************/
+size_t FreeStore::used() const {
+	size_t n = 0;
+	for (const auto& blk : allocated)
+		n += blk.second;
+
+	return n;
+}
+
+/********************************************************************************************//**
+ * The blocks must lie within the arena, and not overlap.
+ *
+ * @param	free	The free block list
+ * @param	used	The allocated block list
+ * @return	false, leaving the lists unchanged, if the blocks aren't valid
+ ************************************************************************************************/
+bool FreeStore::restore(const FreeStoreMap& free, const FreeStoreMap& used) {
+	FreeStoreMap all(free);
+	for (const auto& blk : used)
+		if (!all.insert(blk).second)
+			return false;
+
+	size_t next = initAddr;					// Blocks are ordered by address...
+	for (const auto& blk : all) {
+		if (blk.first < next || blk.second > initAddr + initSize - blk.first)
+			return false;
+		next = blk.first + blk.second;
+	}
+
+	freeStore = free;
+	allocated = used;
+	return true;
+}
+
 /********************************************************************************************//**
  * @param	size	Number of Datums's to allocate
  * @return The starting address of the allocated block, or zero if insufficient free-space.
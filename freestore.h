@@ -20,6 +20,11 @@
  * best-fit, and blocks are split to requested size. Blocks are automatically merged when freed.
  ************************************************************************************************/
 class FreeStore {
+public:
+	/// Map blocks by starging address
+	typedef std::map<size_t, size_t> FreeStoreMap;
+
+private:
 	/// A block range; its starting address and number of Datums
 	struct Block {
     	size_t  addr;						///< Address of the block
@@ -30,9 +35,6 @@ class FreeStore {
     	virtual ~Block() {}
 	};
 
-	/// Map blocks by starging address
-	typedef std::map<size_t, size_t> FreeStoreMap;
-
 	size_t			initAddr;				///< Free store starting address
 	size_t			initSize;				///< Free store maximum size
 	FreeStoreMap	freeStore;				///< Free block list
@@ -44,6 +46,13 @@ public:
 
 	size_t addr() const;					///< Return the base address of the arena
 	size_t size() const;					///< Return the size of the arena, in Datum's
+	size_t used() const;					///< Return the number of Datum's allocated
+
+	const FreeStoreMap& freeBlocks() const	{	return freeStore;	}	///< Return the free block list
+	const FreeStoreMap& usedBlocks() const	{	return allocated;	}	///< Return the allocated block list
+
+	/// Replace the block lists, e.g., with those of a startup image...
+	bool restore(const FreeStoreMap& free, const FreeStoreMap& used);
 	
 	size_t alloc(size_t size);				///< Allocate a block of Datum's from the free list
 	bool free(unsigned addr);				///< Return a previously allocated block to free list
@@ -11,10 +11,12 @@
  *                         [ sub-decl-lst ';'             ]
  *                         { "begin" stmt-lst "end"  } ;
  *        const-decl-lst = "const" const-decl { ';' const-decl } ;
- *            const-decl = ident '=' const-expr ;
+ *            const-decl = ident [ ':' type ] '=' const-init ;
+ *            const-init = const-expr | string | '(' const-init { ',' const-init } ')' ;
  *         type-decl-lst = type-decl { ';' type-decl } ;
  *             type-decl = "type" "is" type ;
- *          var-decl-blk = "var" var-decl-lst ;
+ *          var-decl-blk = "var" var-init-lst ;
+ *          var-init-lst = var-decl [ '=' const-init ] { ';' var-decl [ '=' const-init ] } ;
  *          var-decl-lst = var-decl { ';' var-decl } ;
  *              var-decl = ident-lst : type ;
  *                  type = simple-type | structured-type | pointer-type ;
@@ -23,12 +25,17 @@
  *          ordinal-type = '(' ident-lst ')' | const-expr ".." const-expr                   |
  *                         "boolean" | "integer" | "natual" | "positive" | "character" ;
  *       structured-type = "array" '[' ordinal-type-lst ']' "of" type                       |
- *                         "record" field-lst "end" ;
+ *                         "record" field-lst [ variant-part ] "end" ;
  *             field-lst = var-decl-lst ;
+ *          variant-part = "case" [ ident ':' ] ordinal-type "of" variant { ';' variant } ;
+ *               variant = const-expr { ',' const-expr } ':' '(' field-lst ')' ;
  *          pointer-type = '^' ident ;
  *          sub-decl-lst = func-decl | proc-decl ;
- *             proc-decl = "procedure" ident param-lst "is" block-decl "endproc" ;
- *             func-decl = "function"  ident param-lst ':' type "is" block-decl "endfunc" ; 
+ *             proc-decl = "procedure" ident param-lst "is" block-decl "endproc"          |
+ *                         "procedure" ident param-lst "is" external-decl ;
+ *             func-decl = "function"  ident param-lst ':' type "is" block-decl "endfunc" |
+ *                         "function"  ident param-lst ':' type "is" external-decl ;
+ *         external-decl = "external" string [ ',' string ] ;
  *             param-lst = '(' [ param-decl-lst ] ')' ;
  *        param-decl-lst = param-decl { ';' param-decl } ;
  *            param-decl = [ "var" ] ident-lst : type ;
@@ -41,6 +48,7 @@
  *            while-stmt = "while" expr "loop" stmt-lst "endloop" ;
  *              for-stmt = "for" ident "in" [ "reverse" ] ordinal-type
  *                            "loop" stmt "endloop" ;
+ *             with-stmt = "with" variable { ',' variable } "do" stmt-lst "end" ;
  *           return-stmt = "return" [ expr ] ;
  *                  stmt = [  variable ':=' expr                                        |
  *                            ident '(' [ expr-lst ] ')'                                |
@@ -48,12 +56,13 @@
  *                            while-stmt                                                |
  *                            "repeat" stmt "until" expr endloop                        |
  *                            for-stmt                                                  |
+ *                            with-stmt                                                 |
  *                            return-stmt ] ;
  *            const-expr = [ '+' | '-' ] number | ident | character | string ;
  *            const-expr = const-simple-expr { expr-op const-simple-expr } ;
  *     const-simple-expr = [ simple-expr-pre] const-term { simple-expr-op const-term } ;
  *            const-term = const-fact { term-op  const-fact } ;
- *            const-fact = ident | attribute | number | '(' const-expr ')' ;
+ *            const-fact = ident | attribute | number | character | '(' const-expr ')' ;
  *              expr-lst = expr { ',' expr } ;
  *                  expr = simple-expr { expr-op simple-expr } ;
  *               expr-op = '<' | "<=" | '=' | ">=" | '>' | "<>" simple-expr ;
@@ -0,0 +1,347 @@
+/********************************************************************************************//**
+ * @file image.cc
+ *
+ * class Image implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#include "external.h"
+#include "image.h"
+
+using namespace std;
+
+namespace {
+	/// Write value, in native byte order
+	template <class T> void put(ostream& out, const T& value) {
+		out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	/// Read value, in native byte order; returns false on end of file
+	template <class T> bool get(istream& in, T& value) {
+		return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+	}
+
+	/// Write a count, or address
+	void putSize(ostream& out, size_t n)		{	put(out, static_cast<uint64_t>(n));	}
+
+	/// Read a count, or address, of at most limit
+	bool getSize(istream& in, size_t& n, uint64_t limit = UINT32_MAX) {
+		uint64_t value = 0;
+		if (!get(in, value) || value > limit)
+			return false;
+
+		n = static_cast<size_t>(value);
+		return true;
+	}
+
+	/// Write a Datum; its kind, followed by its value
+	void putDatum(ostream& out, const Datum& value) {
+		put(out, static_cast<uint8_t>(value.kind()));
+		switch (value.kind()) {
+		case Datum::Boolean:	put(out, static_cast<int64_t>(value.boolean()));	break;
+		case Datum::Character:	put(out, static_cast<int64_t>(value.character()));	break;
+		case Datum::Integer:	put(out, static_cast<int64_t>(value.integer()));	break;
+		case Datum::LongInt:	put(out, value.longint());							break;
+		case Datum::Real:		put(out, value.real());								break;
+		}
+	}
+
+	/// Read a Datum
+	bool getDatum(istream& in, Datum& value) {
+		uint8_t kind = 0;
+		int64_t n = 0;
+		double r = 0;
+
+		if (!get(in, kind))
+			return false;
+
+		switch (kind) {
+		case Datum::Boolean:	if (!get(in, n)) return false;	value = Datum(n != 0);					break;
+		case Datum::Character:	if (!get(in, n)) return false;	value = Datum(static_cast<char>(n));	break;
+		case Datum::Integer:	if (!get(in, n)) return false;	value = Datum(static_cast<int>(n));		break;
+		case Datum::LongInt:	if (!get(in, n)) return false;	value = Datum(n);						break;
+		case Datum::Real:		if (!get(in, r)) return false;	value = Datum(r);						break;
+		default:				return false;
+		}
+
+		return true;
+	}
+
+	/// Write a count, followed by the Datums
+	void putData(ostream& out, const DatumVector& data) {
+		putSize(out, data.size());
+		for (const auto& value : data)
+			putDatum(out, value);
+	}
+
+	/// Read a count, followed by the Datums
+	bool getData(istream& in, DatumVector& data) {
+		size_t n = 0;
+		if (!getSize(in, n))
+			return false;
+
+		data.resize(n);
+		for (auto& value : data)
+			if (!getDatum(in, value))
+				return false;
+
+		return true;
+	}
+
+	/// Write a count, followed by the blocks' addresses, and sizes
+	void putBlocks(ostream& out, const FreeStore::FreeStoreMap& blocks) {
+		putSize(out, blocks.size());
+		for (const auto& blk : blocks) {
+			putSize(out, blk.first);
+			putSize(out, blk.second);
+		}
+	}
+
+	/// Read a count, followed by the blocks' addresses, and sizes
+	bool getBlocks(istream& in, FreeStore::FreeStoreMap& blocks) {
+		size_t n = 0;
+		if (!getSize(in, n))
+			return false;
+
+		blocks.clear();
+		while (n-- > 0) {
+			size_t addr = 0, size = 0;
+			if (!getSize(in, addr) || !getSize(in, size))
+				return false;
+			blocks[addr] = size;
+		}
+
+		return true;
+	}
+
+	/// Write a string; its length, followed by its characters
+	void putString(ostream& out, const string& str) {
+		putSize(out, str.size());
+		out.write(str.data(), str.size());
+	}
+
+	/// Read a string
+	bool getString(istream& in, string& str) {
+		size_t length = 0;
+		if (!getSize(in, length))
+			return false;
+
+		str.assign(length, '\0');
+		return length == 0 || static_cast<bool>(in.read(&str[0], length));
+	}
+
+	/// Write a count, followed by each External binding's library, symbol, and signature
+	void putExternals(ostream& out) {
+		putSize(out, External::size());
+		for (size_t i = 0; i < External::size(); ++i) {
+			const External& ext = External::at(i);
+			putString(out, ext.library());
+			putString(out, ext.name());
+			put(out, static_cast<uint8_t>(ext.function()));
+			put(out, static_cast<uint8_t>(ext.returns()));
+			putSize(out, ext.params().size());
+			for (const auto& param : ext.params()) {
+				put(out, static_cast<uint8_t>(param.kind));
+				putSize(out, param.count);
+				put(out, static_cast<uint8_t>(param.array));
+				put(out, static_cast<uint8_t>(param.ref));
+			}
+		}
+	}
+
+	/// Read a Datum kind
+	bool getKind(istream& in, Datum::Kind& kind) {
+		uint8_t value = 0;
+		if (!get(in, value) || value > Datum::LongInt)
+			return false;
+
+		kind = static_cast<Datum::Kind>(value);
+		return true;
+	}
+
+	/// Read a flag
+	bool getFlag(istream& in, bool& flag) {
+		uint8_t value = 0;
+		if (!get(in, value))
+			return false;
+
+		flag = value != 0;
+		return true;
+	}
+
+	/**
+	 * Read the External bindings, and bind each again, in this process, recording its new index
+	 * in indexes.
+	 */
+	bool getExternals(istream& in, vector<size_t>& indexes, string& error) {
+		size_t n = 0;
+		if (!getSize(in, n))
+			return false;
+
+		indexes.clear();
+		while (n-- > 0) {
+			string library, symbol;
+			bool function = false;
+			Datum::Kind result = Datum::Integer;
+			size_t nParams = 0;
+			if (!getString(in, library) || !getString(in, symbol) || !getFlag(in, function) ||
+					!getKind(in, result) || !getSize(in, nParams))
+				return false;
+
+			External::ParamVec params(nParams);
+			for (auto& param : params)
+				if (!getKind(in, param.kind) || !getSize(in, param.count) ||
+						!getFlag(in, param.array) || !getFlag(in, param.ref))
+					return false;
+
+			const size_t index = External::bind(library, symbol, params, function, result, error);
+			if (index == External::size()) {
+				error = "can't bind " + symbol + ": " + error;
+				return false;
+			}
+			indexes.push_back(index);
+		}
+
+		return true;
+	}
+}
+
+/********************************************************************************************//**
+ * class Image
+ ************************************************************************************************/
+
+// private static
+
+const char* const Image::magic = "P machine image 2\n";
+
+// public
+
+/********************************************************************************************//**
+ * Construct an empty image
+ ************************************************************************************************/
+Image::Image() : pc{0}, fp{0}, sp{0}, stackEnd{0}, heapAddr{0}, heapSize{0} {
+}
+
+/********************************************************************************************//**
+ * @param	path	The image file name
+ * @return	false if the image couldn't be written
+ ************************************************************************************************/
+bool Image::save(const string& path) const {
+	ofstream ofile(path, ios::binary);
+
+	ofile.write(magic, strlen(magic));
+
+	const InstrVector& code = program->code();
+	putSize(ofile, code.size());
+	for (const auto& instr : code) {
+		put(ofile, static_cast<uint8_t>(instr.op));
+		put(ofile, instr.level);
+		putDatum(ofile, instr.value);
+	}
+	putData(ofile, program->consts());
+	putExternals(ofile);
+
+	putSize(ofile, subrs.size());
+	for (const auto& subr : subrs) {
+		putSize(ofile, subr.first);
+		putSize(ofile, subr.second.size());
+		ofile.write(subr.second.data(), subr.second.size());
+	}
+
+	putSize(ofile, index.size());
+	for (auto line : index)
+		putSize(ofile, line);
+
+	for (auto reg : { pc, fp, sp, stackEnd, heapAddr, heapSize })
+		putSize(ofile, reg);
+
+	putData(ofile, data);
+	putBlocks(ofile, freeBlocks);
+	putBlocks(ofile, usedBlocks);
+	putData(ofile, heap);
+
+	return ofile.good();
+}
+
+/********************************************************************************************//**
+ * Checks the file's signature, and that its values, and opcodes, are in range, but not that the
+ * registers, and blocks, are consistent with the data segment; that's left to PInterp::resume().
+ * Each External binding is bound again, and CALLX instructions are renumbered to match.
+ *
+ * @param		path	The image file name
+ * @param[out]	error	Why an External binding failed, if it did
+ * @return	false if the image couldn't be read, isn't a P machine image, or an External
+ *			binding failed
+ ************************************************************************************************/
+bool Image::load(const string& path, string& error) {
+	ifstream ifile(path, ios::binary);
+
+	string signature(strlen(magic), '\0');
+	if (!ifile.read(&signature[0], signature.size()) || signature != magic)
+		return false;
+
+	size_t n = 0;
+	if (!getSize(ifile, n))
+		return false;
+
+	InstrVector code(n);
+	for (auto& instr : code) {
+		uint8_t op = 0;
+		if (!get(ifile, op) || op > static_cast<uint8_t>(OpCode::HALT) ||
+				!get(ifile, instr.level) || !getDatum(ifile, instr.value))
+			return false;
+		instr.op = static_cast<OpCode>(op);
+	}
+
+	DatumVector consts;
+	vector<size_t> externals;
+	if (!getData(ifile, consts) || !getExternals(ifile, externals, error))
+		return false;
+
+	for (auto& instr : code)
+		if (instr.op == OpCode::CALLX) {
+			if (instr.value.natural() >= externals.size())
+				return false;
+			instr.value = Datum(externals[instr.value.natural()]);
+		}
+	program = Program::make(move(code), move(consts));
+
+	if (!getSize(ifile, n))
+		return false;
+	subrs.clear();
+	while (n-- > 0) {
+		size_t entry = 0, length = 0;
+		if (!getSize(ifile, entry) || !getSize(ifile, length))
+			return false;
+
+		string name(length, '\0');
+		if (length > 0 && !ifile.read(&name[0], length))
+			return false;
+		subrs[entry] = name;
+	}
+
+	if (!getSize(ifile, n))
+		return false;
+	index.resize(n);
+	for (auto& line : index) {
+		size_t value = 0;
+		if (!getSize(ifile, value))
+			return false;
+		line = value;
+	}
+
+	for (auto reg : { &pc, &fp, &sp, &stackEnd, &heapAddr, &heapSize })
+		if (!getSize(ifile, *reg))
+			return false;
+
+	return	getData(ifile, data)		&&
+			getBlocks(ifile, freeBlocks)	&&
+			getBlocks(ifile, usedBlocks)	&&
+			getData(ifile, heap);
+}
@@ -0,0 +1,62 @@
+/********************************************************************************************//**
+ * @file image.h
+ *
+ * Pre-initialized startup images of P machine programs.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	IMAGE_H
+#define IMAGE_H
+
+#include <string>
+#include <vector>
+
+#include "freestore.h"
+#include "program.h"
+
+/********************************************************************************************//**
+ * A Startup Image
+ *
+ * A program, and the state of a machine running it, taken when the program executed the ready
+ * statement; its registers, the data segment's constants and stack, from 0 to sp, the free
+ * store's block lists, the contents of its allocated blocks, and the library, symbol, and
+ * signature of each external subroutine, which are bound again when it's loaded. A program that
+ * spends a while initializing tables, before it reads any input, can be run from the image,
+ * skipping the initialization.
+ *
+ * Images are saved in the native byte order, and Datum sizes, of the machine that wrote them;
+ * they're a cache, not an interchange format. The stack is placed at the same address, so the
+ * image may only be resumed on machines with the same page size.
+ ************************************************************************************************/
+class Image {
+public:
+	ProgramPtr				program;		///< The code, and initial constant, segments
+	SubrMap					subrs;			///< Subroutine names, by entry point
+	std::vector<unsigned>	index;			///< Source line numbers, indexed by instruction address
+	size_t					pc;				///< Program counter; the instruction following ready
+	size_t					fp;				///< Frame pointer
+	size_t					sp;				///< Stack pointer
+	size_t					stackEnd;		///< One past the end of the stack; the guard page
+	size_t					heapAddr;		///< Free store starting address
+	size_t					heapSize;		///< Free store size, in Datums
+	DatumVector				data;			///< The data segment, from 0 to sp
+	FreeStore::FreeStoreMap	freeBlocks;		///< The free store's free blocks
+	FreeStore::FreeStoreMap	usedBlocks;		///< The free store's allocated blocks
+	DatumVector				heap;			///< The contents of usedBlocks, in address order
+
+	Image();
+	virtual ~Image() {}
+
+	/// Write the image to path...
+	bool save(const std::string& path) const;
+
+	/// Read the image from path, binding its External subroutines...
+	bool load(const std::string& path, std::string& error);
+
+private:
+	static const char* const magic;			///< The image file signature
+};
+
+#endif
@@ -32,6 +32,9 @@ const OpCodeInfo::InfoMap OpCodeInfo::opInfoTbl {
 
 	{ OpCode::ITOR,		OpCodeInfo{ "itor",		1			} },
 	{ OpCode::ITOR2,	OpCodeInfo{ "itor2",	2			} },
+	{ OpCode::ITOL,		OpCodeInfo{ "itol",		1			} },
+	{ OpCode::ITOL2,	OpCodeInfo{ "itol2",	2			} },
+	{ OpCode::LTOI,		OpCodeInfo{ "ltoi",		1			} },
 	{ OpCode::ROUND,	OpCodeInfo{ "round",	1			} },
 	{ OpCode::TRUNC,	OpCodeInfo{ "trunc",	1			} },
 	{ OpCode::ABS,		OpCodeInfo{	"abs",		1			} },
@@ -54,6 +57,8 @@ const OpCodeInfo::InfoMap OpCodeInfo::opInfoTbl {
 	{ OpCode::GETLN,	OpCodeInfo{ "getln",	2			} },
 	{ OpCode::PUT,		OpCodeInfo{ "put",		4			} },
 	{ OpCode::PUTLN,	OpCodeInfo{ "putln",	4			} },
+	{ OpCode::PUTS,		OpCodeInfo{ "puts",		0			} },
+	{ OpCode::PUTSLN,	OpCodeInfo{ "putsln",	0			} },
 	{ OpCode::NEW,		OpCodeInfo{ "new",		1			} },
 	{ OpCode::DISPOSE,	OpCodeInfo{ "dispose",	1			} },
 
@@ -65,7 +70,7 @@ const OpCodeInfo::InfoMap OpCodeInfo::opInfoTbl {
 	{ OpCode::DIV,		OpCodeInfo{ "div",		2			} },
 	{ OpCode::REM,		OpCodeInfo{ "rem",		2			} },
 
-	{ OpCode::BNOT,		OpCodeInfo{ "bitand",	1			} },
+	{ OpCode::BNOT,		OpCodeInfo{ "bitnot",	1			} },
 	{ OpCode::BAND,		OpCodeInfo{ "bitand",	2			} },
 	{ OpCode::BOR,		OpCodeInfo{ "bitor",	2			} },
 	{ OpCode::BXOR,		OpCodeInfo{ "bitxor",	2			} },
@@ -96,6 +101,7 @@ const OpCodeInfo::InfoMap OpCodeInfo::opInfoTbl {
 
 	{ OpCode::CALL,		OpCodeInfo{ "call",		2			} },
 	{ OpCode::CALLI,	OpCodeInfo{ "calli",	0			} },
+	{ OpCode::CALLX,	OpCodeInfo{ "callx",	0			} },
 
 	{ OpCode::ENTER,	OpCodeInfo{ "enter",	0			} },	// Size isn't staticly know
 	{ OpCode::RET,		OpCodeInfo{ "ret",		FrameSize	} },
@@ -105,10 +111,16 @@ const OpCodeInfo::InfoMap OpCodeInfo::opInfoTbl {
 	{ OpCode::JUMPI,	OpCodeInfo{ "jumpi",	0			} },
 	{ OpCode::JNEQ,		OpCodeInfo{ "jneq",		1			} },
 	{ OpCode::JNEQI,	OpCodeInfo{ "jneqi",	0			} },
+	{ OpCode::FORPREP,	OpCodeInfo{ "forprep",	1			} },	// Pops first
+	{ OpCode::FORLOOP,	OpCodeInfo{ "forloop",	0			} },	// Pops addr, limit only on exit
 
 	{ OpCode::LLIMIT,	OpCodeInfo{ "llimit",	1			} },
 	{ OpCode::ULIMIT,	OpCodeInfo{ "ulimit",	1			} },
 
+	{ OpCode::NOP,		OpCodeInfo{ "nop",		0			} },
+	{ OpCode::READY,	OpCodeInfo{ "ready",	0			} },
+	{ OpCode::BREAK,	OpCodeInfo{ "break",	0			} },
+
 	{ OpCode::HALT,		OpCodeInfo{ "halt",		0			} }
 };
 
@@ -131,23 +143,11 @@ const OpCodeInfo& OpCodeInfo::info(OpCode op) {
 }
 
 /********************************************************************************************//**
- * @param	out		Where to write the results
- * @param	loc		Address of the instruction
- * @param	instr	The instruction to disassemble
- * @param	label	Display label
- * @return 	loc+1
+ * @param	op	An opcode
+ * @return	The number of operands op takes; 0, 1 (value), or 2 (level, value)
  ************************************************************************************************/
-unsigned disasm(ostream& out, unsigned loc, const Instr& instr, const string label) {
-	out << fixed;
-
-	const int level = instr.level;		// so we don't display level as a character
-
-	if (label.size())
-		out << label << ": ";
-
-	out << setw(5) << loc << ": " << OpCodeInfo::info(instr.op).name();
-
-	switch(instr.op) {
+unsigned nOperands(OpCode op) {
+	switch(op) {
 	case OpCode::ASSIGN:
 	case OpCode::COPY:
 	case OpCode::ENTER:
@@ -155,19 +155,53 @@ unsigned disasm(ostream& out, unsigned loc, const Instr& instr, const string lab
 	case OpCode::GET:
 	case OpCode::LLIMIT:
 	case OpCode::ULIMIT:
+	case OpCode::CALLX:
 	case OpCode::POP:
 	case OpCode::PRED:
 	case OpCode::PUSH:
+	case OpCode::PUTS:
+	case OpCode::PUTSLN:
 	case OpCode::SUCC:
 	case OpCode::JUMPI:
 	case OpCode::JNEQI:
 	case OpCode::RET:
 	case OpCode::RETF:
-		out << " " << instr.value;
-		break;
+		return 1;
 
 	case OpCode::PUSHVAR:
 	case OpCode::CALLI:
+	case OpCode::FORPREP:
+	case OpCode::FORLOOP:
+		return 2;
+
+	default:								// The rest don't use level, address or value
+		return 0;
+	}
+}
+
+/********************************************************************************************//**
+ * @param	out		Where to write the results
+ * @param	loc		Address of the instruction
+ * @param	instr	The instruction to disassemble
+ * @param	label	Display label
+ * @return 	loc+1
+ ************************************************************************************************/
+unsigned disasm(ostream& out, unsigned loc, const Instr& instr, const string label) {
+	out << fixed;
+
+	const int level = instr.level;		// so we don't display level as a character
+
+	if (label.size())
+		out << label << ": ";
+
+	out << setw(5) << loc << ": " << OpCodeInfo::info(instr.op).name();
+
+	switch(nOperands(instr.op)) {
+	case 1:
+		out << " " << instr.value;
+		break;
+
+	case 2:
 		out << " "	<< level << ", " << instr.value;
 		break;
 
@@ -41,6 +41,9 @@ enum class OpCode : unsigned char {
 	NEG,		///< NEG - Negate TOS
 	ITOR,		///< ITOR - Convert TOS to real
 	ITOR2,		///< ITOR2 - Convert TOS-1 to real
+	ITOL,		///< ITOL - Convert TOS to long integer
+	ITOL2,		///< ITOL2 - Convert TOS-1 to long integer
+	LTOI,		///< LTOI - Convert TOS to integer; OutOfRange if it doesn't fit
 	ROUND,		///< ROUND - Round TOS to nearest integer
 	TRUNC,		///< TRUNC - Truncate TOS to integer
 	ABS,		///< ABS - Replace TOS with its absolute value
@@ -61,6 +64,8 @@ enum class OpCode : unsigned char {
 	GETLN,		///< GETLN - Read one line from standard input
 	PUT,		///< PUT - Write one or more values on standard output
 	PUTLN,		///< PUTLN - Write one or more values, followed by a newline, on standard output
+	PUTS,		///< PUTS ,addr - Write the string at constant segment address addr on standard output
+	PUTSLN,		///< PUTSLN ,addr - Write the string at addr, followed by a newline, on standard output
 	NEW,		///< NEW   - Allocate dynamic store; n=pop(); allocate n dataums, push(addr) or zero if insufficient space
 	DISPOSE,	///< DISPOSE - Dispose of allocated dynamic store; free pop()
 
@@ -98,6 +103,7 @@ enum class OpCode : unsigned char {
 
 	CALL,		///< Call TOS-1,TOS - Call a subroutine, pushing a new activation Frame
 	CALLI,		///< Call level, address - Call a subroutine, pushing a new activation frame
+	CALLX,		///< CALLX ,n - Call external subroutine n; pop its parameters, push its result, if any
 
 	ENTER,		///< ENTER ,n - Allocate n locals on the stack
 	RET,		///< Return from procedure; unlink Frame
@@ -108,12 +114,22 @@ enum class OpCode : unsigned char {
 	JNEQ,		///< Jump if condition is false
 	JNEQI,		///< Jump if condition is false
 
+	FORPREP,	///< FORPREP inc,exit - Start a for loop; TOS is (addr,first,limit), jump to exit if empty
+	FORLOOP,	///< FORLOOP inc,body - Step a for loop; TOS is (addr,limit), jump to body if not done
+
 	LLIMIT,		///< Check array index; out-of-range error if TOS <  addr
 	ULIMIT,		///< Check array index; out-of-range error if TOS >  addr
 
+	NOP,		///< No operation; place holder for elided instructions
+	READY,		///< READY - Initialized; stop for a startup snapshot, if taking one, otherwise, no operation
+	BREAK,		///< Breakpoint; stop the machine, leaving pc at the breakpoint
+
 	HALT		///< Halt the machine
 };
 
+/// Subroutine names, by entry point address
+typedef std::map<size_t, std::string> SubrMap;
+
 /// Return the ordinal value for op
 inline unsigned ordinal(OpCode op)			{	return static_cast<unsigned>(op);	}
 
@@ -170,6 +186,11 @@ struct Instr {
  ************************************************************************************************/
 typedef std::vector<Instr>					InstrVector;
 
+/********************************************************************************************//**
+ * Return the number of operands op takes; 0, 1 (value), or 2 (level, value)
+ ************************************************************************************************/
+unsigned nOperands(OpCode op);
+
 /********************************************************************************************//**
  * Disassemble an instruction...
  ************************************************************************************************/
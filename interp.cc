@@ -12,13 +12,18 @@
 #include <cmath>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <vector>
 
+#include "external.h"
 #include "interp.h"
 
 using namespace std;
 using namespace std::rel_ops;
 
+thread_local PInterp* PInterp::active = nullptr;
+struct sigaction PInterp::oldSegv;
+
 // private:
 
 /********************************************************************************************//**
@@ -34,43 +39,7 @@ void PInterp::dump() {
 
 	if (!trace) return;
 
-	static vector<string> labels = {
-		"(base)",
-		"(saved fp)",
-		"(raddr)",
-		"(rvalue)"
-	};
-	auto it = labels.begin();
-
-	// Dump the current activation frame, followed by locals and temps...
-
-	assert(sp >= fp);
-	cout    << "fp: " 	<< setw(5)	<< fp << ": "
-			<< right 	<< setw(10)	<< stack[fp];
-
-	if (it != labels.end())
-		cout << ' ' << *it++;
-	cout << endl;
-
-	for (auto bl = fp+1; bl < sp; ++bl) {
-		cout
-			<<	"    "	<< setw(5)	<< bl << ": "
-			<< right	<< setw(10) << stack[bl];
-
-		if (it != labels.end())
-			cout << ' ' << *it++;
-		cout << endl;
-	}
-
-	cout    << "sp: " 	<< setw(5) 	<< sp << ": "
-			<< right	<< setw(10) << stack[sp];
-
-	if (it != labels.end())
-		cout << ' ' << *it++;
-	cout << endl;
-
-	disasm(cout, pc, code[pc], "pc");
-
+	frame(cout);
 	cout << endl;
 }
 
@@ -97,6 +66,23 @@ bool PInterp::rangeCheck(size_t begin, size_t end) {
 		return false;
 }
 
+/********************************************************************************************//**
+ * Checks to see if the memory range described by [begin, end] is valid, and writable, i.e.,
+ * valid and not within the constant segment.
+ *
+ * @param	begin	Start of the memory range
+ * @param 	end		One past the end of the memory range
+ * @return	true if [begin,end) describes a valid, writable, memory range
+ ************************************************************************************************/
+bool PInterp::writeCheck(size_t begin, size_t end) {
+	if (begin < constSize) {
+		cerr << "attempt to write to the constant segment @" << begin << "!\n";
+		return false;
+	}
+
+	return rangeCheck(begin, end);
+}
+
 // protected:
 
 /********************************************************************************************//**
@@ -154,6 +140,9 @@ PInterp::InstrPtr PInterp::instrTbl[] = {
 	&PInterp::NEG,
 	&PInterp::ITOR,
 	&PInterp::ITOR2,
+	&PInterp::ITOL,
+	&PInterp::ITOL2,
+	&PInterp::LTOI,
 	&PInterp::ROUND,
 	&PInterp::TRUNC,
 	&PInterp::ABS,
@@ -171,6 +160,8 @@ PInterp::InstrPtr PInterp::instrTbl[] = {
 	&PInterp::GETLN,
 	&PInterp::PUT,
 	&PInterp::PUTLN,
+	&PInterp::PUTS,
+	&PInterp::PUTSLN,
 	&PInterp::NEW,
 	&PInterp::DISPOSE,
 	&PInterp::ADD,
@@ -201,6 +192,7 @@ PInterp::InstrPtr PInterp::instrTbl[] = {
 	&PInterp::COPY,
 	&PInterp::CALL,
 	&PInterp::CALLI,
+	&PInterp::CALLX,
 	&PInterp::ENTER,
 	&PInterp::RET,
 	&PInterp::RETF,
@@ -208,8 +200,13 @@ PInterp::InstrPtr PInterp::instrTbl[] = {
 	&PInterp::JUMPI,
 	&PInterp::JNEQ,
 	&PInterp::JNEQI,
+	&PInterp::FORPREP,
+	&PInterp::FORLOOP,
 	&PInterp::LLIMIT,
 	&PInterp::ULIMIT,
+	&PInterp::NOP,
+	&PInterp::READY,
+	&PInterp::BREAK,
 	&PInterp::HALT
 };
 
@@ -233,14 +230,14 @@ Result PInterp::NOT() {
 }
 
 /********************************************************************************************//**
- * Convert the TOS interger value to real
- * @return	badDataType if TOS isn't an Integer
+ * Convert the TOS interger, or long integer, value to real
+ * @return	badDataType if TOS isn't an Integer or LongInt
  ************************************************************************************************/
 Result PInterp::ITOR() {
 	Datum& TOS = tos();
 
-	if (TOS.kind() == Datum::Integer) {
-		TOS = TOS.integer() * 1.0;
+	if (TOS.integral()) {
+		TOS = TOS.real();
 		return Result::success;
 
 	} else
@@ -258,6 +255,49 @@ Result PInterp::ITOR2() {
 	return r;
 }
 
+/********************************************************************************************//**
+ * Convert the TOS interger value to a long integer
+ * @return	badDataType if TOS isn't an Integer
+ ************************************************************************************************/
+Result PInterp::ITOL() {
+	Datum& TOS = tos();
+
+	if (TOS.kind() == Datum::Integer) {
+		TOS = TOS.longint();
+		return Result::success;
+
+	} else
+		return Result::badDataType;
+}
+
+/********************************************************************************************//**
+ * Convert the TOS-1 interger value to a long integer, preserving the TOS value.
+ * @return	badDataType if TOS isn't an Integer
+ ************************************************************************************************/
+Result PInterp::ITOL2() {
+	Datum savedTOS = pop();
+	Result r = ITOL();
+	push(savedTOS);
+	return r;
+}
+
+/********************************************************************************************//**
+ * Convert the TOS long integer value to an integer
+ * @return	badDataType if TOS isn't a LongInt, outOfRange if it's value doesn't fit in an Integer
+ ************************************************************************************************/
+Result PInterp::LTOI() {
+	Datum& TOS = tos();
+
+	if (TOS.kind() != Datum::LongInt)
+		return Result::badDataType;
+
+	else if (TOS.longint() < numeric_limits<int>::min() || TOS.longint() > numeric_limits<int>::max())
+		return Result::outOfRange;
+
+	TOS = static_cast<int>(TOS.longint());
+	return Result::success;
+}
+
 /********************************************************************************************//**
  * Round the TOS real value to the nearest integer
  * @return	badDataType if TOS isn't a Real
@@ -298,6 +338,8 @@ Result PInterp::ABS() {
 
 	if (TOS.kind() == Datum::Integer)
 		TOS = abs(TOS.integer());
+	else if (TOS.kind() == Datum::LongInt)
+		TOS = TOS.longint() < 0 ? -TOS.longint() : TOS.longint();
 	else if (TOS.kind() == Datum::Real)
 		TOS = fabs(TOS.real());
 	else
@@ -314,8 +356,8 @@ Result PInterp::ATAN() {
 	Datum& TOS = tos();
 	Result r = Result::success;
 
-	if (TOS.kind() == Datum::Integer)
-		TOS = atan(TOS.integer());
+	if (TOS.integral())
+		TOS = atan(TOS.real());
 	else if (TOS.kind() == Datum::Real)
 		TOS = atan(TOS.real());
 	else
@@ -332,8 +374,8 @@ Result PInterp::EXP() {
 	Datum& TOS = tos();
 	Result r = Result::success;
 
-	if (TOS.kind() == Datum::Integer)
-		TOS = exp(TOS.integer());
+	if (TOS.integral())
+		TOS = exp(TOS.real());
 	else if (TOS.kind() == Datum::Real)
 		TOS = exp(TOS.real());
 	else
@@ -361,13 +403,13 @@ Result PInterp::LOG() {
 		} else 
 			TOS = log(TOS.real());
 
-	} else if (TOS.kind() == Datum::Integer) {
-		if (TOS.kind() == Datum::Integer && TOS.integer() == 0) {
+	} else if (TOS.integral()) {
+		if (TOS.zero()) {
 			cerr << "Attempt to take log(0) @ pc (" << prevPc << ")!\n";
 			r = Result::divideByZero;
 
 		} else 
-			TOS = log(TOS.integer());
+			TOS = log(TOS.real());
 	}
 
 	return r;
@@ -389,8 +431,8 @@ Result PInterp::DUP() {
 Result PInterp::ODD() {
 	Datum& TOS = tos();
 
-	if (TOS.kind() == Datum::Integer) {
-		TOS = (TOS.integer() & 1) ? true : false;
+	if (TOS.integral()) {
+		TOS = (TOS.longint() & 1) ? true : false;
 		return Result::success;
 
 	} else
@@ -424,8 +466,8 @@ Result PInterp::SIN() {
 	Datum& TOS = tos();
 	Result r = Result::success;
 
-	if (TOS.kind() == Datum::Integer)
-		TOS = sin(TOS.integer());
+	if (TOS.integral())
+		TOS = sin(TOS.real());
 	else if (TOS.kind() == Datum::Real)
 		TOS = sin(stack[sp].real());
 	else
@@ -445,6 +487,8 @@ Result PInterp::SQR() {
 	// note that Datum lacks a *= operator
 	if (TOS.kind() == Datum::Integer)
 		TOS = TOS.integer() * TOS.integer();
+	else if (TOS.kind() == Datum::LongInt)
+		TOS = TOS.longint() * TOS.longint();
 	else if (TOS.kind() == Datum::Real)
 		TOS = TOS.real() * TOS.real();
 	else
@@ -461,8 +505,8 @@ Result PInterp::SQRT() {
 	Datum& TOS = tos();
 	Result r = Result::success;
 
-	if (TOS.kind() == Datum::Integer)
-		TOS = sqrt(TOS.integer());
+	if (TOS.integral())
+		TOS = sqrt(TOS.real());
 	else if (TOS.kind() == Datum::Real)
 		TOS = sqrt(TOS.real());
 	else
@@ -506,6 +550,7 @@ Result PInterp::GET() {
 		case Datum::Boolean:	r = get<bool>();	break;
 		case Datum::Character:	r = get<char>();	break;
 		case Datum::Integer:	r = get<int>();		break;
+		case Datum::LongInt:	r = get<int64_t>();	break;
 		case Datum::Real:		r = get<double>();	break;
 		default:
 			cerr << "GET unsupported type: " << ir.value << endl;
@@ -563,21 +608,43 @@ Result PInterp::put() {
 	} else
 		n = nValue.integer();
 
+	if (r == Result::success)
+		r = write(cout, &stack[sp+1-n], n, w, p);
+	pop(n);
+
+	return r;
+}
+
+/********************************************************************************************//**
+ * Writes a value, as PUTx does; if n is greater than 1, values is an array, where an array of
+ * characters is written as a string.
+ *
+ * @param	out		Where to write the value
+ * @param	values	The value's n Datums
+ * @param	n		The number of Datums in the value
+ * @param	w		The width of the field to write each Datum in
+ * @param	p		The precision of each Datum, if it's a Real
+ * @return	Result::badDataType if a Datum's kind is unknown
+ ************************************************************************************************/
+Result PInterp::write(ostream& out, const Datum* values, size_t n, int w, int p) {
+	Result r = Result::success;
+
 	for (unsigned i = 0; i < n && r == Result::success; ++i) {
-		const Datum& value = stack[sp+i+1-n];
+		const Datum& value = values[i];
 
 		if (n > 1 && i == 0 && value.kind() != Datum::Character)
-			cout << '[';					// prefix for non-character arrays
+			out << '[';						// prefix for non-character arrays
 
 		switch(value.kind()) {
-		case Datum::Boolean:	cout << boolalpha << value.boolean();					break;
-		case Datum::Character:	cout << setw(w) << value.character();					break;
-		case Datum::Integer:	cout << setw(w) << setprecision(p) << value.integer();	break;
+		case Datum::Boolean:	out << boolalpha << value.boolean();					break;
+		case Datum::Character:	out << setw(w) << value.character();					break;
+		case Datum::Integer:	out << setw(w) << setprecision(p) << value.integer();	break;
+		case Datum::LongInt:	out << setw(w) << value.longint();						break;
 		case Datum::Real:
 			if (p == 0)
-				cout << setw(w) << scientific << setprecision(6) << value.real();
+				out << setw(w) << scientific << setprecision(6) << value.real();
 			else
-				cout << setw(w) << fixed << setprecision(p) << value.real();
+				out << setw(w) << fixed << setprecision(p) << value.real();
 			break;
 
 		default:
@@ -587,15 +654,33 @@ Result PInterp::put() {
 
 		// Seperator, post-fix for non-character arrays
 		if (n > 1 && i < n-1 && value.kind() != Datum::Character)
-			cout << ',';
+			out << ',';
 		else if (n > 1 && i == n-1 && value.kind() != Datum::Character)
-			cout << ']';
+			out << ']';
 	}
-	pop(n);
 
 	return r;
 }
 
+/********************************************************************************************//**
+ * Writes the string at ir.value, a constant segment address, on the standard output stream. The
+ * string is a character count, followed by the characters, which the program encoded as it was
+ * made; it's written in a single write.
+ *
+ * @return	Result::outOfRange if the string isn't in the constant segment, Result::illegalOp if
+ *			it isn't a count followed by characters.
+ ************************************************************************************************/
+Result PInterp::puts() {
+	const Program::Literal* lit = program->literal(ir.value.natural());
+	if (lit == nullptr)
+		return Result::outOfRange;
+	else if (Result::success != lit->result)
+		return lit->result;
+
+	cout.write(lit->text.data(), lit->text.size());
+	return Result::success;
+}
+
 /********************************************************************************************//**
  * Writes one expresson, followed by a newline, on the standard output stream.
  *
@@ -627,6 +712,27 @@ Result PInterp::PUTLN() {
 	return r;
 }
 
+/********************************************************************************************//**
+ * @see puts()
+ *
+ * @return	puts();
+ ************************************************************************************************/
+Result PInterp::PUTS() {
+	return puts();
+}
+
+/********************************************************************************************//**
+ * @see puts()
+ *
+ * @return	puts();
+ ************************************************************************************************/
+Result PInterp::PUTSLN() {
+	const Result r = puts();
+	if (r == Result::success)
+		cout << '\n';
+	return r;
+}
+
 /********************************************************************************************//**
  * Replaces the TOS, which is the number of Datums to allocate on the heap, and if successful,
  * replaces the TOS with the address of the new block, or zero if there was insufficient space
@@ -642,7 +748,12 @@ Result PInterp::NEW() {
 		return Result::badDataType;
 	}
 
-	push(heap.alloc(pop().natural()));
+	const size_t size = pop().natural();
+	const size_t addr = heap.alloc(size);
+	if (heapProfiler != nullptr && addr != 0)
+		heapProfiler->alloc(addr, size, prevPc);
+
+	push(addr);
 	if (trace)
 		heap.dump(cout);					// Dump the new heap state...
 
@@ -671,6 +782,9 @@ Result PInterp::DISPOSE() {
 		return Result::freeStoreError;
 	}
 
+	if (heapProfiler != nullptr)
+		heapProfiler->free(addr);
+
 	if (trace)
 		heap.dump(cout);					// Dump the new heap state...
 
@@ -766,7 +880,7 @@ Result PInterp::DIV() {
 		cerr << "Attempt to divide by zero @ pc (" << prevPc << ")!\n";
 		r= Result::divideByZero;
 
-	} else if (rhs.kind() == Datum::Integer && rhs.integer() == 0) {
+	} else if (rhs.integral() && rhs.zero()) {
 		cerr << "Attempt to divide by zero @ pc (" << prevPc << ")!\n";
 		r = Result::divideByZero;
 
@@ -790,11 +904,11 @@ Result PInterp::REM() {
 	const	Datum	lhs = pop();
 			Result	r	= Result::success;
 
-	if (lhs.kind() != Datum::Integer || rhs.kind() != Datum::Integer) {
+	if (!lhs.integral() || lhs.kind() != rhs.kind()) {
 		cerr << "Attampt to calulate reminder with non-integer value\n";
 		r =  Result::badDataType;
 
-	} else if (rhs.integer() == 0) {
+	} else if (rhs.zero()) {
 		cerr << "Attempt to divide by zero @ pc (" << prevPc << ")!\n";
 		r = Result::divideByZero;
 
@@ -1201,7 +1315,7 @@ Result PInterp::ASSIGN() {
 		return Result::stackUnderflow;
 
 	const size_t dst = stack[sp - n].natural();
-	if (!rangeCheck(dst, dst + n))
+	if (!writeCheck(dst, dst + n))
 		return Result::stackUnderflow;
 
 	lastWrite = dst + n - 1;
@@ -1229,7 +1343,7 @@ Result PInterp::COPY() {
 		r = Result::stackUnderflow;
 
 	size_t dst = pop().natural();
-	if (!rangeCheck(dst, dst + n))
+	if (!writeCheck(dst, dst + n))
 		r = Result::stackUnderflow;
 
 	lastWrite = dst + n;
@@ -1285,6 +1399,45 @@ Result PInterp::CALLI() {
 	return Result::success;
 }
 
+/********************************************************************************************//**
+ * Call external subroutine ir.value, passing it the parameters on the stack; values in place,
+ * and var parameters by the address on the stack. The parameters are popped, and the result,
+ * if it's a function, pushed.
+ *
+ * @return	success, stackUnderflow if the parameters aren't all on the stack, outOfRange if a
+ *			var parameter's address isn't valid, or badFetch if there's no such subroutine.
+ ************************************************************************************************/
+Result PInterp::CALLX() {
+	if (ir.value.natural() >= External::size())
+		return Result::badFetch;
+
+	const External& ext = External::at(ir.value.natural());
+	const size_t n = ext.stackSize();
+	if (sp < n)
+		return Result::stackUnderflow;
+
+	External::ArgVec args;					// Locate each argument...
+	size_t arg = sp - n + 1;
+	for (const auto& param : ext.params()) {
+		size_t addr = arg;
+		if (param.ref) {
+			addr = stack[arg].natural();
+			if (!writeCheck(addr, addr + param.count))
+				return Result::outOfRange;
+		}
+
+		args.push_back(&stack[addr]);
+		arg += param.size();
+	}
+
+	const Datum result = ext.call(args);
+	pop(n);
+	if (ext.function())
+		push(result);
+
+	return Result::success;
+}
+
 /********************************************************************************************//**
  * Unlinks the stack frame, setting the return address as the next instruciton.
  * @return	success.
@@ -1313,11 +1466,14 @@ Result PInterp::RETF() {
 
 /********************************************************************************************//**
  * Allocates ir.value Datums for local variables on the stack.
- * @return	success.
+ * @return	success, or stackOverflow if the frame would extend past the guard page.
  ************************************************************************************************/
 Result PInterp::ENTER() {
-	sp += ir.value.integer();
+	const size_t n = ir.value.integer();
+	if (sp + n >= stackEnd)
+		return Result::stackOverflow;
 
+	sp += n;
 	return Result::success;
 }
 
@@ -1372,6 +1528,85 @@ Result PInterp::JNEQI() {
 	return Result::success;
 }
 
+/********************************************************************************************//**
+ * @param	value	A Boolean, Character, Integer or LongInt
+ * @throws	Result::illegalOp if value is a Real
+ * @return	value's ordinal value
+ ************************************************************************************************/
+static int64_t ordinal(const Datum& value) {
+	switch (value.kind()) {
+	case Datum::Boolean:	return value.boolean();
+	case Datum::Character:	return value.character();
+	default:				return value.longint();
+	}
+}
+
+/********************************************************************************************//**
+ * Start a for loop. TOS is (addr,first,limit), where addr is the iterator's address, first its
+ * initial value, of the iterator's kind, and limit its final ordinal value. The loop runs up,
+ * if ir.level is positive, otherwise down. If the range is empty, pops all three, and jumps to
+ * ir.value, otherwise, assigns first to the iterator, leaving (addr,limit) for FORLOOP.
+ *
+ * @return	stackUnderflow if the stack underflowed, outOfRange if addr isn't writable.
+ ************************************************************************************************/
+Result PInterp::FORPREP() {
+	if (sp < 3)
+		return Result::stackUnderflow;
+
+	const Datum limit = pop();
+	const Datum first = pop();
+	const size_t addr = tos().natural();
+
+	if (ir.level > 0 ? ordinal(first) > ordinal(limit) : ordinal(first) < ordinal(limit)) {
+		pop();
+		pc = ir.value.natural();
+
+	} else if (!writeCheck(addr, addr + 1))
+		return Result::outOfRange;
+
+	else {
+		stack[addr] = first;
+		lastWrite = addr;
+		push(limit);
+	}
+
+	return Result::success;
+}
+
+/********************************************************************************************//**
+ * Step a for loop. TOS is (addr,limit), as left by FORPREP. If the iterator has reached limit,
+ * pops both, otherwise, steps the iterator by ir.level, keeping its kind, and jumps to ir.value.
+ * The test precedes the step, so the last value of the iterator's type is never stepped past.
+ *
+ * @return	stackUnderflow if the stack underflowed, outOfRange if addr isn't writable.
+ ************************************************************************************************/
+Result PInterp::FORLOOP() {
+	if (sp < 2)
+		return Result::stackUnderflow;
+
+	const size_t addr = stack[sp - 1].natural();
+	if (!writeCheck(addr, addr + 1))
+		return Result::outOfRange;
+
+	Datum& iter = stack[addr];
+	const int64_t value = ordinal(iter);
+	if (ir.level > 0 ? value >= ordinal(tos()) : value <= ordinal(tos())) {
+		pop(2);
+		return Result::success;
+	}
+
+	switch (iter.kind()) {
+	case Datum::Boolean:	iter = Datum(ir.level > 0);								break;
+	case Datum::Character:	iter = Datum(static_cast<char>(value + ir.level));		break;
+	case Datum::LongInt:	iter = Datum(static_cast<int64_t>(value + ir.level));	break;
+	default:				iter = Datum(static_cast<int>(value + ir.level));		break;
+	}
+	lastWrite = addr;
+	pc = ir.value.natural();
+
+	return Result::success;
+}
+
 /********************************************************************************************//**
  * @note	The TOS is not consumed.
  * @return	BadDataType if TOS isn't an Integer or a Boolean, outOfRange if the check failed.
@@ -1414,6 +1649,35 @@ Result PInterp::ULIMIT() {
 		return TOS > ir.value ? Result::outOfRange : Result::success;
 }
 
+/********************************************************************************************//**
+ * @return	success
+ ************************************************************************************************/
+Result PInterp::NOP() {
+	return Result::success;
+}
+
+/********************************************************************************************//**
+ * Marks the end of the program's initialization; stops the machine, with pc at the following
+ * instruction, if taking a startup image, otherwise does nothing.
+ *
+ * @return	ready, or success
+ ************************************************************************************************/
+Result PInterp::READY() {
+	return readyStop ? Result::ready : Result::success;
+}
+
+/********************************************************************************************//**
+ * Stops the machine with pc left at the breakpoint, and uncounted, so that the original
+ * instruction can be restored, and execution continued.
+ *
+ * @return	breakpoint
+ ************************************************************************************************/
+Result PInterp::BREAK() {
+	pc = prevPc;
+	--ncycles;
+	return Result::breakpoint;
+}
+
 /********************************************************************************************//**
  * @return	halted
  ************************************************************************************************/
@@ -1428,7 +1692,7 @@ Result PInterp::step() {
 	Result r = Result::success;
 
 	prevPc = pc++;							// Fetch the next instruction...
-	ir = code[prevPc];
+	ir = (*code)[prevPc];
 	++ncycles;
 
 	if (sp < OpCodeInfo::info(ir.op).nElements()) {
@@ -1447,35 +1711,132 @@ Result PInterp::step() {
 }
 
 /********************************************************************************************//**
- *  @return	Result::success, or ...
+ * Walk the activation frames, from the current one up to, but not including, the initial frame,
+ * collecting return addresses, and pass them, along with pc, on to the profiler.
  ************************************************************************************************/
-Result PInterp::run() {
-	if (trace) {
-		cout << "Reg  Addr Value/Instr\n"
-			 << "---------------------\n";
-		heap.dump(cout);					// Dump the initial heap state...
+void PInterp::sample() {
+	returns.clear();
+
+	for (size_t frame = fp; frame > constSize && frame + FrameRetAddr < stack.size(); ) {
+		const Datum& raddr = stack[frame + FrameRetAddr];
+		const Datum& oldFp = stack[frame + FrameOldFp];
+		if (raddr.kind() != Datum::Integer || oldFp.kind() != Datum::Integer || oldFp.natural() >= frame)
+			break;							// Not a valid frame
+
+		returns.push_back(raddr.natural());
+		frame = oldFp.natural();
 	}
 
+	profiler->sample(pc, returns);
+}
+
+/********************************************************************************************//**
+ * SIGSEGV handler; if the fault is on the faulting thread's active machine's guard page, jump
+ * back to guarded(), otherwise restore the previous action, and return to fault again.
+ ************************************************************************************************/
+void PInterp::guardHandler(int sig, siginfo_t* info, void*) {
+	if (active != nullptr && active->stack.guarded(info->si_addr))
+		siglongjmp(active->overflow, 1);
+
+	sigaction(sig, &oldSegv, nullptr);
+}
+
+/********************************************************************************************//**
+ * The handler is installed with SA_NODEFER, so SIGSEGV isn't blocked while it runs, and
+ * guarded() needn't save, and restore, the signal mask around each call.
+ *
+ * @return	true
+ ************************************************************************************************/
+bool PInterp::installGuardHandler() {
+	struct sigaction action;
+	action.sa_sigaction = guardHandler;
+	action.sa_flags = SA_SIGINFO | SA_NODEFER;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGSEGV, &action, &oldSegv);
+
+	return true;
+}
+
+/********************************************************************************************//**
+ * @return	Result::success, or ...
+ ************************************************************************************************/
+Result PInterp::execute() {
 	Result status = Result::success;
-	try {
-		do {
-			if (pc >= code.size()) {
-				cerr << "pc (" << pc << ") is out of range: [0.." << code.size() << ")!\n";
-				status = Result::badFetch;
+	do {
+		if (pc >= code->size()) {
+			cerr << "pc (" << pc << ") is out of range: [0.." << code->size() << ")!\n";
+			status = Result::badFetch;
+
+		} else {
+			if (profiler != nullptr && Profiler::due())
+				sample();
+			if (ngramProfiler != nullptr)
+				ngramProfiler->note(pc, (*code)[pc]);
+			if (publisher != nullptr && Metrics::due())
+				publish();
+			dump();								// Dump state and disasm the next instruction
+			status = step();
+		}
 
-			} else {
-				dump();							// Dump state and disasm the next instruction
-				status = step();
-			}
+	} while (Result::success == status);
 
-		} while (Result::success == status);
+	return status;
+}
+
+/********************************************************************************************//**
+ * Call f as this thread's active machine, converting a touch of the guard page into
+ * Result::stackOverflow, and a thrown Result into a returned one. guardHandler() is installed
+ * by the first call, and left installed; machines on other threads have their own active
+ * machine.
+ *
+ * @note	guardHandler() may longjmp out of f, so nothing on the path to a stack access may
+ *			own a resource.
+ * @param	f	The member to call; execute() or step()
+ * @return	f's result
+ ************************************************************************************************/
+Result PInterp::guarded(InstrPtr f) {
+	static const bool installed = installGuardHandler();
+	(void) installed;
+
+	PInterp* const previous = active;
+	active = this;
+
+	Result status = Result::success;
+	if (sigsetjmp(overflow, 0) != 0)
+		status = Result::stackOverflow;		// Touched the guard page
+
+	else try {
+		status = (this->*f)();
 
 	} catch (Result result) {
 		cerr << result << " @pc " << prevPc << ", sp: " << sp << endl;
 		status = result;
 	}
 
-	if (status != Result::success && status != Result::halted)
+	active = previous;
+
+	return status;
+}
+
+/********************************************************************************************//**
+ * Runs from the current state until the machine halts, faults, hits a breakpoint, or, if
+ * stopping there, the ready statement.
+ *
+ *  @return	Result::halted, Result::breakpoint, Result::ready, or ...
+ ************************************************************************************************/
+Result PInterp::run() {
+	if (trace) {
+		cout << "Reg  Addr Value/Instr\n"
+			 << "---------------------\n";
+		heap.dump(cout);					// Dump the initial heap state...
+	}
+
+	const Result status = guarded(&PInterp::execute);
+	if (status == Result::stackOverflow)	// sp is at the guard page, which depends on the page size
+		cerr << "runtime error @pc " << prevPc << ": " << status << endl;
+
+	else if (status != Result::success && status != Result::halted && status != Result::breakpoint &&
+			status != Result::ready)
 		cerr << "runtime error @pc " << prevPc << ", sp: " << sp << ": " << status << endl;
 
 	return status;
@@ -1488,13 +1849,23 @@ Result PInterp::run() {
  *
  * @param stackSz	Size of the evaluation & call stack, in Datums.
  * @param fstoreSz	Size of the free store, in Datums.
- ************************************************************************************************/
-PInterp::PInterp(unsigned stackSz, unsigned fstoreSz)
-	:	stackSize{stackSz},
-		stack(stackSize + fstoreSz, Datum(-1)),
+ * @param huge		Use huge pages for the data segment if true.
+ ************************************************************************************************/
+PInterp::PInterp(unsigned stackSz, unsigned fstoreSz, bool huge)
+	:	program{Program::make(InstrVector())},
+		code{&program->code()},
+		constSize{0},
+		stackSize{stackSz},
+		stack(stackSize + fstoreSz, huge),
 		heap(stackSz, fstoreSz),
+		stackEnd{stackSz},
 		trace(false),
-		ncycles(0)
+		readyStop(false),
+		ncycles(0),
+		profiler(nullptr),
+		heapProfiler(nullptr),
+		ngramProfiler(nullptr),
+		publisher(nullptr)
 {
 	reset();
 }
@@ -1506,10 +1877,51 @@ PInterp::PInterp(unsigned stackSz, unsigned fstoreSz)
  *  @return	The number of machine cycles run
  ************************************************************************************************/
 Result PInterp::operator()(const InstrVector& prog, bool trce) {
-	trace = trce;
-	code = prog;
+	return (*this)(prog, DatumVector(), trce);
+}
 
-	reset();
+/********************************************************************************************//**
+ * Loads, and runs, the program.
+ *
+ *	@param	prog	The program to run
+ *	@param	consts	The program's constant segment
+ *	@param 	trce	True for trace/debugging messages
+ * 
+ *  @return	The number of machine cycles run
+ ************************************************************************************************/
+Result PInterp::operator()(const InstrVector& prog, const DatumVector& consts, bool trce) {
+	return (*this)(Program::make(prog, consts), trce);
+}
+
+/********************************************************************************************//**
+ * Loads, and runs, a shared program.
+ *
+ *	@param	prog	The program to run
+ *	@param 	trce	True for trace/debugging messages
+ * 
+ *  @return	The number of machine cycles run
+ ************************************************************************************************/
+Result PInterp::operator()(ProgramPtr prog, bool trce) {
+	load(prog, trce);
+
+	auto result = run();
+	if (Result::halted == result)
+		result = Result::success;			// halted is normal!
+
+	return result;
+}
+
+/********************************************************************************************//**
+ * Resumes, and runs, a startup image.
+ *
+ *	@param	image	The image to run
+ *	@param 	trce	True for trace/debugging messages
+ * 
+ *  @return	The number of machine cycles run
+ ************************************************************************************************/
+Result PInterp::operator()(const Image& image, bool trce) {
+	if (!resume(image, trce))
+		return Result::badImage;
 
 	auto result = run();
 	if (Result::halted == result)
@@ -1518,19 +1930,310 @@ Result PInterp::operator()(const InstrVector& prog, bool trce) {
 	return result;
 }
 
+/********************************************************************************************//**
+ *	@param	prog	The program to run
+ *	@param	consts	The program's constant segment
+ *	@param 	trce	True for trace/debugging messages
+ ************************************************************************************************/
+void PInterp::load(const InstrVector& prog, const DatumVector& consts, bool trce) {
+	load(Program::make(prog, consts), trce);
+}
+
+/********************************************************************************************//**
+ * Shares prog's code segment. Relocates the stack and free store to follow the constant segment,
+ * which is copied to [0, consts.size()). The end of the stack is rounded up to a page boundary,
+ * and followed by a guard page.
+ *
+ *	@param	prog	The program to run
+ *	@param 	trce	True for trace/debugging messages
+ ************************************************************************************************/
+void PInterp::load(ProgramPtr prog, bool trce) {
+	trace = trce;
+	program = prog;
+	code = &program->code();
+	patched.clear();
+
+	const DatumVector& consts = program->consts();
+	const size_t fstoreSize = heap.size();
+	constSize = consts.size();
+	const size_t page = DataSegment::pageSize();
+	stackEnd = (constSize + stackSize + page - 1) / page * page;
+	stack.resize(stackEnd + page + fstoreSize);
+	stack.guard(stackEnd, page);
+	heap = FreeStore(stackEnd + page, fstoreSize);
+	copy(consts.begin(), consts.end(), stack.begin());
+
+	reset();
+}
+
+/********************************************************************************************//**
+ * Execute the next instruction, as run() would, but without tracing or profiling; for harnesses
+ * that drive the machine an instruction at a time.
+ *
+ * @return	Result::success, Result::halted, or ...
+ ************************************************************************************************/
+Result PInterp::single() {
+	lastWrite.invalidate();
+
+	if (pc >= code->size()) {
+		cerr << "pc (" << pc << ") is out of range: [0.." << code->size() << ")!\n";
+		return Result::badFetch;
+	}
+
+	return guarded(&PInterp::step);
+}
+
+/********************************************************************************************//**
+ * The first patch makes a private copy of the code, leaving the shared program untouched.
+ *
+ * @param	addr	The instruction address, which must be within the code segment
+ * @param	instr	The replacement instruction
+ * @return	The original instruction
+ ************************************************************************************************/
+Instr PInterp::patch(size_t addr, const Instr& instr) {
+	assert(addr < code->size());
+
+	if (code != &patched) {
+		patched = *code;
+		code = &patched;
+	}
+
+	const Instr original = patched[addr];
+	patched[addr] = instr;
+	return original;
+}
+
+/********************************************************************************************//**
+ * Write the current activation frame, followed by locals and temps, and disassemble the next
+ * instruction, as unpatched, in the trace format.
+ *
+ * @param	out	Where to write the frame
+ ************************************************************************************************/
+void PInterp::frame(ostream& out) const {
+	static vector<string> labels = {
+		"(base)",
+		"(saved fp)",
+		"(raddr)",
+		"(rvalue)"
+	};
+	auto it = labels.begin();
+
+	assert(sp >= fp);
+	out     << "fp: " 	<< setw(5)	<< fp << ": "
+			<< right 	<< setw(10)	<< stack[fp];
+
+	if (it != labels.end())
+		out << ' ' << *it++;
+	out << endl;
+
+	for (auto bl = fp+1; bl < sp; ++bl) {
+		out
+			<<	"    "	<< setw(5)	<< bl << ": "
+			<< right	<< setw(10) << stack[bl];
+
+		if (it != labels.end())
+			out << ' ' << *it++;
+		out << endl;
+	}
+
+	out     << "sp: " 	<< setw(5) 	<< sp << ": "
+			<< right	<< setw(10) << stack[sp];
+
+	if (it != labels.end())
+		out << ' ' << *it++;
+	out << endl;
+
+	if (pc < program->code().size())		// the original, not any breakpoint
+		disasm(out, pc, program->code()[pc], "pc");
+}
+
+/********************************************************************************************//**
+ * @param		addr	A data address
+ * @param[out]	value	The value at addr
+ * @return	true if addr is within the data segment, and not the guard page
+ ************************************************************************************************/
+bool PInterp::read(size_t addr, Datum& value) const {
+	if (addr >= stack.size() || stack.guarded(&stack[addr]))
+		return false;
+
+	value = stack[addr];
+	return true;
+}
+
+/********************************************************************************************//**
+ * The strings written by PUTSx are the program's, so writes to them aren't seen by PUTSx.
+ *
+ * @param	addr	A data address
+ * @param	value	The value to write at addr
+ * @return	true if addr is within the data segment, and not the guard page
+ ************************************************************************************************/
+bool PInterp::write(size_t addr, const Datum& value) {
+	if (addr >= stack.size() || stack.guarded(&stack[addr]))
+		return false;
+
+	stack[addr] = value;
+	return true;
+}
+
+/********************************************************************************************//**
+ * Replace the loaded program with prog, which extends it, keeping the data segment, and set the
+ * registers to continue at addr; e.g., to run code appended by an incremental compile.
+ *
+ * @param	prog		The extended program
+ * @param	addr		The next instruction address
+ * @param	framePtr	The frame pointer
+ * @param	stackPtr	The stack pointer
+ ************************************************************************************************/
+void PInterp::jump(ProgramPtr prog, size_t addr, size_t framePtr, size_t stackPtr) {
+	program = prog;
+	code = &program->code();
+	patched.clear();
+
+	prevPc = pc = addr;
+	fp = framePtr;
+	sp = stackPtr;
+}
+
+/********************************************************************************************//**
+ * @param[out]	addr	The address written
+ * @param[out]	value	The value written
+ * @return	true if the last instruction executed wrote to memory
+ ************************************************************************************************/
+bool PInterp::written(size_t& addr, Datum& value) const {
+	if (!lastWrite.valid())
+		return false;
+
+	addr = lastWrite;
+	value = stack[addr];
+	return true;
+}
+
 /********************************************************************************************//**
  ************************************************************************************************/
 void PInterp::reset() {
 	prevPc = pc = 0;
 
-	fp = 0;											// Setup the initial activacation frame
-	for (sp = fp; sp < FrameSize; ++sp)
+	fp = constSize;									// Setup the initial activacation frame
+	for (sp = fp; sp < fp + FrameSize; ++sp)
 		stack[sp] = 0;
 	sp = fp + FrameSize - 1;
 
 	ncycles = 0;
 }
 
+/********************************************************************************************//**
+ * Reset the machine for another run of the loaded program; the free store is emptied, the
+ * constant segment restored, and the rest of the data segment zeroed, as by load(), so that
+ * each run starts from the same state. Unlike load(), the data segment isn't remapped; whole
+ * pages are just released, to be faulted back in as touched.
+ ************************************************************************************************/
+void PInterp::restart() {
+	const DatumVector& consts = program->consts();
+	heap = FreeStore(heap.addr(), heap.size());
+	stack.clear(constSize);
+	copy(consts.begin(), consts.end(), stack.begin());
+
+	reset();
+}
+
+/********************************************************************************************//**
+ * Only the live part of the data segment is saved; the constants, and stack, up to sp, and the
+ * free store's allocated blocks.
+ *
+ * @param[out]	image	The startup image; its subroutine names, and source index, are left as is
+ ************************************************************************************************/
+void PInterp::snapshot(Image& image) const {
+	image.program = program;
+	image.pc = pc;
+	image.fp = fp;
+	image.sp = sp;
+	image.stackEnd = stackEnd;
+	image.heapAddr = heap.addr();
+	image.heapSize = heap.size();
+	image.data.assign(&stack[0], &stack[0] + sp + 1);
+
+	image.freeBlocks = heap.freeBlocks();
+	image.usedBlocks = heap.usedBlocks();
+	image.heap.clear();
+	for (const auto& blk : image.usedBlocks)
+		image.heap.insert(image.heap.end(), &stack[blk.first], &stack[blk.first] + blk.second);
+}
+
+/********************************************************************************************//**
+ * Loads the image's program, and lays out the data segment as it was when the image was taken,
+ * which requires the same page size, and then restores the registers, the live data, and the
+ * free store. The stack, and free store, sizes are the image's. As with restart(), the data
+ * segment isn't remapped if it's already laid out that way, e.g., when resuming the same image
+ * again, but everything above sp, including the free blocks, is zeroed, so each resume starts
+ * from the image's state, not the previous run's.
+ *
+ * @param	image	The startup image
+ * @param 	trce	True for trace/debugging messages
+ * @return	false, with an error message, if the image doesn't fit its data segment layout.
+ ************************************************************************************************/
+bool PInterp::resume(const Image& image, bool trce) {
+	const DatumVector& consts = image.program->consts();
+	const size_t page = DataSegment::pageSize();
+	size_t heapUsed = 0;
+	for (const auto& blk : image.usedBlocks)
+		heapUsed += blk.second;
+
+	if (image.stackEnd % page != 0 || image.heapAddr != image.stackEnd + page) {
+		cerr << "image data segment layout doesn't fit a page size of " << page << "!\n";
+		return false;
+
+	} else if (	image.sp >= image.stackEnd || image.fp > image.sp || image.fp < consts.size() ||
+				image.data.size() != image.sp + 1 || image.heap.size() != heapUsed ||
+				image.pc >= image.program->code().size()) {
+		cerr << "image registers, or data, are inconsistent!\n";
+		return false;
+	}
+
+	trace = trce;
+	program = image.program;
+	code = &program->code();
+	patched.clear();
+
+	constSize = consts.size();
+	if (stackEnd != image.stackEnd || stack.size() != image.heapAddr + image.heapSize) {
+		stackEnd = image.stackEnd;
+		stack.resize(image.heapAddr + image.heapSize);
+		stack.guard(stackEnd, page);
+	}
+	heap = FreeStore(image.heapAddr, image.heapSize);
+	if (!heap.restore(image.freeBlocks, image.usedBlocks)) {
+		cerr << "image free store blocks are inconsistent!\n";
+		return false;
+	}
+
+	stack.clear(image.sp + 1);				// Nothing above sp, or in free blocks, survives
+	copy(image.data.begin(), image.data.end(), stack.begin());
+	auto value = image.heap.begin();
+	for (const auto& blk : image.usedBlocks) {
+		copy(value, value + blk.second, stack.begin() + blk.first);
+		value += blk.second;
+	}
+
+	prevPc = pc = image.pc;
+	fp = image.fp;
+	sp = image.sp;
+	ncycles = 0;
+	lastWrite.invalidate();
+
+	return true;
+}
+
+/********************************************************************************************//**
+ * @param	state	"running", "halted", or why the machine stopped
+ * @return	false if there's no publisher, or the snapshot couldn't be written
+ ************************************************************************************************/
+bool PInterp::publish(const string& state) {
+	if (publisher == nullptr)
+		return false;
+
+	return publisher->publish(state, ncycles, sp - constSize, heap.used(), prevPc);
+}
+
 /********************************************************************************************//**
  * @return number of machien cycles run so far
  ************************************************************************************************/
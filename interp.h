@@ -10,12 +10,20 @@
 #ifndef	PINTERP_H
 #define PINTERP_H
 
+#include <csetjmp>
+#include <csignal>
 #include <iostream>
 #include <cstdint>
+#include <string>
 #include <vector>
 
+#include "datasegment.h"
 #include "freestore.h"
+#include "image.h"
 #include "instr.h"
+#include "metrics.h"
+#include "profile.h"
+#include "program.h"
 #include "results.h"
 
 /********************************************************************************************//**
@@ -26,26 +34,102 @@
  *
  * @section Memory-map
  *
- * Code and data each exist in their own namespaces. The data namespace is divided into three
+ * Code and data each exist in their own namespaces. The code namespace is a shared, immutable,
+ * Program, so any number of machines may run the same program without copies. The data namespace is divided into three
  * fixed length segments; the the constants segment, followed by the evaluation/call stack
  * (originized by call activation frames [blocks]), followed by the heap (free store). The size of
  *  each are set at construction, and reset by operator()();
  *
+ * The data namespace is a DataSegment; a lazily faulted in mmap region, optionally using huge
+ * pages, so that large heaps cost nothing until used.
+ *
+ * The stack is rounded up to a page boundary, and followed by a guard page. Rather than
+ * checking each push, stack overflow is detected by the SIGSEGV raised on touching the guard,
+ * which run() converts into Result::stackOverflow. ENTER still checks, as a large frame could
+ * otherwise step over the guard.
+ *
  * Address range            | Region    | Notes
  * ------------------------ | --------- | ------------------------------
- * stackSze..heap.size()-1  | Heap      | Maintained by heap(stackSz, fstoreSz)
- * 0..stackSize-1   		| Stack     | Evaluation and call stack
+ * heap.addr()..+fstoreSz-1 | Heap      | Maintained by heap(stackEnd+page, fstoreSz)
+ * stackEnd..+page-1        | Guard     | Inaccessible
+ * constSz..stackEnd-1		| Stack     | Evaluation and call stack
+ * 0..constSz-1   			| Constants | Read-only, loaded by operator()()
  ********************************************************************************************//**/
 class PInterp {
 public:
-	PInterp(unsigned stackSz = 1024, unsigned fstoreSz = 3*1024);
+	PInterp(unsigned stackSz = 1024, unsigned fstoreSz = 3*1024, bool huge = false);
 	virtual ~PInterp() {}
 
 	/// Load a applicaton and start the pl/0 machine running...
 	Result operator()(const InstrVector& prog, bool t = false);
+	/// Load a applicaton, and its constant segment, and start the pl/0 machine running...
+	Result operator()(const InstrVector& prog, const DatumVector& consts, bool t = false);
+	/// Load a shared program, and start the machine running...
+	Result operator()(ProgramPtr prog, bool t = false);
+	/// Resume a startup image, and continue the machine running...
+	Result operator()(const Image& image, bool t = false);
 	void reset();							///< Reset the machine back to it's initial state.
+	void restart();							///< Reset the machine, and its free store, for another run
 	size_t cycles() const;					///< Return number of machine cycles run so far
 
+	/// Set, or clear, the sampling profiler
+	void profile(Profiler* prof)			{	profiler = prof;	}
+
+	/// Set, or clear, the heap allocation-site profiler
+	void heapProfile(HeapProfiler* prof)	{	heapProfiler = prof;	}
+
+	/// Set, or clear, the opcode n-gram profiler
+	void ngramProfile(NgramProfiler* prof)	{	ngramProfiler = prof;	}
+
+	/// Set, or clear, the live metrics publisher
+	void metrics(Metrics* pub)				{	publisher = pub;	}
+
+	/// Publish a snapshot of the machine's state to the metrics publisher...
+	bool publish(const std::string& state = "running");
+
+	/// Stop, with Result::ready, at the ready statement if true, otherwise continue past it
+	void stopAtReady(bool on)				{	readyStop = on;		}
+
+	/// Save the machine's state, stopped at ready, in a startup image...
+	void snapshot(Image& image) const;
+
+	/// Restore the machine's state from a startup image...
+	bool resume(const Image& image, bool t = false);
+
+	/// Load a applicaton, and its constant segment, and reset the machine...
+	void load(const InstrVector& prog, const DatumVector& consts, bool t = false);
+	void load(ProgramPtr prog, bool t = false);	///< Load a shared program, and reset the machine...
+	const ProgramPtr& loaded() const		{	return program;	}	///< Return the loaded program
+	Result single();						///< Execute a single instruction...
+	Result run();							///< Run the machine, from its current state...
+
+	/// Replace the instruction at addr, returning the original...
+	Instr patch(size_t addr, const Instr& instr);
+
+	/// Write the current activation frame, and next instruction...
+	void frame(std::ostream& out) const;
+
+	/// Return true, and the value, if addr is a readable data address
+	bool read(size_t addr, Datum& value) const;
+
+	/// Write value to addr, which may be in the constant segment, returning false if invalid
+	bool write(size_t addr, const Datum& value);
+
+	/// Continue with an extension of the loaded program, keeping the data segment...
+	void jump(ProgramPtr prog, size_t addr, size_t framePtr, size_t stackPtr);
+
+	size_t pcReg() const					{	return pc;		}	///< Return the program counter
+	size_t spReg() const					{	return sp;		}	///< Return the stack pointer
+	size_t fpReg() const					{	return fp;		}	///< Return the frame pointer
+	const Instr& irReg() const				{	return ir;		}	///< Return the last instruction executed
+	size_t prevPcReg() const				{	return prevPc;	}	///< Return the last instruction's address
+
+	/// Return true, and the address and value, if the last instruction wrote to memory
+	bool written(size_t& addr, Datum& value) const;
+
+	/// Write a value, of n Datums, in a field of width w, and precision p, as PUTx does...
+	static Result write(std::ostream& out, const Datum* values, size_t n, int w, int p);
+
 protected:
 	/// A DatumVector iterator
 	typedef	DatumVector::iterator DatumVecIter;
@@ -53,6 +137,9 @@ protected:
 	/// Return true if the specified memory range is valid
 	bool rangeCheck(size_t begin, size_t end);
 
+	/// Return true if the specified memory range is valid, and writable
+	bool writeCheck(size_t begin, size_t end);
+
 	size_t base(size_t nlevel);				///< Find the activation base 'nlevel' levels up the stack...
 	Datum& tos();							///< Return the top-of-stack
 	const Datum& tos() const;				///< Return the top-of-stack
@@ -67,12 +154,16 @@ protected:
 
 	template <class T> Result get();		///< Read a value from standard input
 	Result put();							///< Process PUTx instructions
+	Result puts();							///< Process PUTSx instructions
 
 	// The instructions...
 
 	Result NEG();							///< Negative
 	Result ITOR();							///< Convert to real
 	Result ITOR2();							///< Convert to real
+	Result ITOL();							///< Convert to long integer
+	Result ITOL2();							///< Convert to long integer
+	Result LTOI();							///< Convert to integer
 	Result ROUND();							///< Convert to integer by rounding 
 	Result TRUNC();							///< Convert to interger by truncation
 	Result ABS();							///< Absolute value
@@ -90,6 +181,8 @@ protected:
 	Result GETLN();							///< Read line from standard input
 	Result PUT();							///< Write expression on standard output
 	Result PUTLN();							///< Write expression, followed by newline, on standard output
+	Result PUTS();							///< Write a constant string on standard output
+	Result PUTSLN();						///< Write a constant string, followed by newline, on standard output
 	Result NEW();							///< Allocate space
 	Result DISPOSE();						///< Free space
 	Result ADD();							///< Addition
@@ -120,6 +213,7 @@ protected:
 	Result COPY();							///< Copy N Datums...
 	Result CALL(); 							///< Call a subroutine...
 	Result CALLI();							///< Call a subroutine
+	Result CALLX();							///< Call an external subroutine
 	Result RET();							///< Return from procedure...
 	Result RETF();							///< Return from a function...
 	Result ENTER();							///< Enter sub-routine, allocate space for locals
@@ -127,12 +221,19 @@ protected:
 	Result JUMPI();							///< Jump
 	Result JNEQ();							///< Jump if condition is false
 	Result JNEQI();							///< Jump if condition is false
+	Result FORPREP();						///< Start a counted for loop
+	Result FORLOOP();						///< Step a counted for loop
 	Result LLIMIT();						///< Check lower limit
 	Result ULIMIT();						///< Check upper limit
+	Result NOP();							///< No operation
+	Result READY();							///< Initialization is complete
+	Result BREAK();							///< Breakpoint
 	Result HALT();							///< Stop the machine
 
 	Result step();							///< Single step the machine...
-	Result run();							///< Run the machine...
+	Result execute();						///< Execute instructions until a fault or halt
+	Result guarded(InstrPtr f);				///< Call f, catching stack overflow and thrown results
+	void sample();							///< Pass a sample to the profiler
 
 private:
 	/// A Effective Address that maybe invalidated
@@ -156,10 +257,14 @@ private:
 		void invalidate() 					{	val = false;	}
 	};
 
-	InstrVector	code;						///< Code segment, indexed by pc
+	ProgramPtr	program;					///< The loaded program
+	const InstrVector* code;				///< program's, or the patched, code segment, indexed by pc
+	InstrVector	patched;					///< Private copy of the code, made by the first patch()
+	size_t		constSize;					///< The size of the constant segment, in Datums.
 	unsigned	stackSize;					///< The size of the stack segment, in Datums.
-	DatumVector	stack;						///< Data segment (stack + free-store), indexed by fp and sp
+	DataSegment	stack;						///< Data segment (constants + stack + free-store), indexed by fp and sp
 	FreeStore	heap;						///< Dynamic memory heap
+	size_t		stackEnd;					///< One past the end of the stack; the guard page
 	size_t		pc;							///< Program counter register; index of *next* instruction in code[]
 	size_t		prevPc;						///< Previous PC register; index of the *current* instruction in code
 	size_t		fp;							///< Frame pointer register; index of the current mark block/frame in stack[]
@@ -167,7 +272,19 @@ private:
 	Instr		ir;							///< *Current* instruction register (code[pc-1])
 	EAddr		lastWrite;					///< Last write effective address (to stack[]), if valid
 	bool		trace;						///< Trace run if true
-	unsigned  	ncycles;					///< Number of machine cycles run since the last reset
+	bool		readyStop;					///< Stop at READY if true
+	size_t		ncycles;					///< Number of machine cycles run since the last reset
+	Profiler*	profiler;					///< Sampling profiler, if any
+	HeapProfiler* heapProfiler;				///< Heap allocation-site profiler, if any
+	NgramProfiler* ngramProfiler;			///< Opcode n-gram profiler, if any
+	Metrics*	publisher;					///< Live metrics publisher, if any
+	std::vector<size_t> returns;			///< Return addresses for the next sample
+	sigjmp_buf	overflow;					///< Where to go on touching the guard page
+
+	static thread_local PInterp* active;	///< This thread's running machine, for guardHandler()
+	static struct sigaction oldSegv;		///< The SIGSEGV action replaced by guardHandler()
+	static void guardHandler(int sig, siginfo_t* info, void* context);
+	static bool installGuardHandler();		///< Install guardHandler(), once per process
 
 	void dump();
 };
@@ -176,10 +293,7 @@ private:
  * @param value	Datum to push on to the stack
  ************************************************************************************************/
 template <class T> void PInterp::push(const T& value) {
-	if (sp >= heap.addr())
-		throw Result::outOfRange;
-	else
-		stack[++sp] = Datum(value);
+	stack[++sp] = Datum(value);				// Overflow is caught by the guard page
 }
 
 /********************************************************************************************//**
@@ -222,7 +336,7 @@ template <class T> Result PInterp::get() {
 			n = nValue.integer();
 			addr = addrValue.natural();
 
-			if (!rangeCheck(addr, addr+n)) {
+			if (!writeCheck(addr, addr+n)) {
 				std::cerr << "Stack underflow evaluating " << n << "Datums \n";
 				r = Result::stackUnderflow;
 
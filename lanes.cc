@@ -0,0 +1,953 @@
+/********************************************************************************************//**
+ * @file lanes.cc
+ *
+ * class Lanes implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "interp.h"
+#include "lanes.h"
+
+using namespace std;
+using namespace std::rel_ops;
+
+/// Return value's ordinal, as the for loop instructions compare them
+static int64_t ordinal(const Datum& value) {
+	switch (value.kind()) {
+	case Datum::Boolean:	return value.boolean();
+	case Datum::Character:	return value.character();
+	default:				return value.longint();
+	}
+}
+
+// private
+
+/********************************************************************************************//**
+ * @param	fp		The group's frame pointer
+ * @param	nlevel	Number of levels down
+ * @param	lane	The lane
+ * @throws	Result::outOfRange if a static link is off the stack
+ * @return	The base, nlevel's down lane's stack
+ ************************************************************************************************/
+size_t Lanes::base(size_t fp, size_t nlevel, unsigned lane) {
+	auto b = fp;
+	for (; nlevel > 0; --nlevel)
+		if ((b = at(b, lane).natural()) >= stackEnd)
+			throw Result::outOfRange;
+
+	return b;
+}
+
+/********************************************************************************************//**
+ * @param	begin	Start of the memory range
+ * @param 	end		One past the end of the memory range
+ * @param	sp		The stack pointer
+ * @return	true if [begin,end) is within [0, sp]
+ ************************************************************************************************/
+bool Lanes::rangeCheck(size_t begin, size_t end, size_t sp) {
+	return begin <= end && begin < sp + 1 && end <= sp + 1;
+}
+
+/********************************************************************************************//**
+ * @param	begin	Start of the memory range
+ * @param 	end		One past the end of the memory range
+ * @param	sp		The stack pointer
+ * @return	true if [begin,end) is within [0, sp], and not in the constant segment
+ ************************************************************************************************/
+bool Lanes::writeCheck(size_t begin, size_t end, size_t sp) const {
+	return begin >= constSize && rangeCheck(begin, end, sp);
+}
+
+/********************************************************************************************//**
+ * @param	lane	The lane to stop
+ * @param	g		The lane's group
+ * @param	r		Result::halted, or why the lane faulted
+ ************************************************************************************************/
+void Lanes::stop(unsigned lane, const Group& g, Result r) {
+	lanes[lane].result = r;
+	lanes[lane].pc = prevPc;
+	lanes[lane].sp = g.sp;
+}
+
+/********************************************************************************************//**
+ * @param	g	The group to stop, which is left empty
+ * @param	r	Result::halted, or why the group faulted
+ ************************************************************************************************/
+void Lanes::stop(Group& g, Result r) {
+	for (const auto lane : g.lanes)
+		stop(lane, g, r);
+	g.lanes.clear();
+}
+
+/********************************************************************************************//**
+ * Each call of f is for a single lane, and must leave the group's registers as they are; they're
+ * updated, for every lane, by the caller. f may throw a Result, as Datum's operators do.
+ *
+ * @param	g	The group
+ * @param	f	Result f(unsigned lane); Result::success, or why the lane faulted
+ ************************************************************************************************/
+template <class F> void Lanes::each(Group& g, F f) {
+	size_t n = 0;							// Lanes still running...
+
+	for (const auto lane : g.lanes) {
+		Result r = Result::success;
+		try {
+			r = f(lane);
+
+		} catch (Result result) {
+			r = result;
+		}
+
+		if (r == Result::success)
+			g.lanes[n++] = lane;
+		else
+			stop(lane, g, r);
+	}
+
+	g.lanes.resize(n);
+}
+
+/********************************************************************************************//**
+ * Each call of f is for a single lane, and sets the lane's registers, which start as the
+ * group's. g keeps the lanes with the first lane's registers, and the others are split off into
+ * spawned, a group for each set of registers.
+ *
+ * @param	g	The group
+ * @param	f	Result f(unsigned lane, Regs& regs); Result::success, or why the lane faulted
+ ************************************************************************************************/
+template <class F> void Lanes::branch(Group& g, F f) {
+	const Regs initial { g.pc, g.fp, g.sp };
+	Regs first = initial;
+	size_t n = 0;							// Lanes following the first...
+
+	for (const auto lane : g.lanes) {
+		Regs regs = initial;
+		Result r = Result::success;
+		try {
+			r = f(lane, regs);
+
+		} catch (Result result) {
+			r = result;
+		}
+
+		if (r != Result::success) {
+			stop(lane, g, r);
+			continue;
+
+		} else if (n == 0)
+			first = regs;
+
+		if (regs.pc == first.pc && regs.fp == first.fp && regs.sp == first.sp) {
+			g.lanes[n++] = lane;
+			continue;
+		}
+
+		auto it = find_if(spawned.begin(), spawned.end(), [&regs](const Group& s) {
+			return s.pc == regs.pc && s.fp == regs.fp && s.sp == regs.sp;
+		});
+		if (it == spawned.end())
+			it = spawned.insert(spawned.end(), Group{ regs.pc, regs.fp, regs.sp, {} });
+		it->lanes.push_back(lane);
+	}
+
+	g.lanes.resize(n);
+	g.pc = first.pc;
+	g.fp = first.fp;
+	g.sp = first.sp;
+}
+
+/********************************************************************************************//**
+ * Reads as GET does, from the lane's record rather than standard input.
+ *
+ * @param	lane	The lane
+ * @param	addr	The destination's starting address
+ * @param	n		The number of values to read
+ * @return	Result::success
+ ************************************************************************************************/
+template <class T> Result Lanes::get(unsigned lane, size_t addr, size_t n) {
+	for (size_t i = 0; i < n; ++i) {
+		T v = T();							// last value read...
+		lanes[lane].in >> v;
+		at(addr + i, lane) = v;
+	}
+
+	return Result::success;
+}
+
+/********************************************************************************************//**
+ * The stacks follow the constants, as in PInterp, with FrameSize Datums to spare, for the pushes
+ * of a single instruction; step() checks for overflow after each instruction.
+ *
+ * @param	prog	The program
+ ************************************************************************************************/
+void Lanes::load(ProgramPtr prog) {
+	program = prog;
+	const DatumVector& consts = program->consts();
+	constSize = consts.size();
+	stackEnd = constSize + stackSize;
+	data.resize((stackEnd + FrameSize) * width);
+
+	for (size_t addr = 0; addr < constSize; ++addr)
+		for (unsigned lane = 0; lane < width; ++lane)
+			at(addr, lane) = consts[addr];
+}
+
+/********************************************************************************************//**
+ * @param	g	Merge each other group at the same pc, fp and sp, into groups[g]
+ ************************************************************************************************/
+void Lanes::merge(size_t g) {
+	for (size_t i = groups.size(); i-- > 0; ) {
+		if (i == g || groups[i].pc != groups[g].pc || groups[i].fp != groups[g].fp ||
+				groups[i].sp != groups[g].sp)
+			continue;
+
+		vector<unsigned> merged;
+		merged.reserve(groups[g].lanes.size() + groups[i].lanes.size());
+		std::merge(	groups[g].lanes.begin(), groups[g].lanes.end(),
+					groups[i].lanes.begin(), groups[i].lanes.end(), back_inserter(merged));
+		groups[g].lanes.swap(merged);
+
+		groups.erase(groups.begin() + i);
+		if (i < g)
+			--g;
+	}
+}
+
+/********************************************************************************************//**
+ * Starts every lane with a zeroed stack, and the initial activation frame, as PInterp::reset()
+ * does, in a single group, and runs the group with the lowest pc, until every lane has stopped.
+ *
+ * @param	nLanes	The number of lanes to run
+ ************************************************************************************************/
+void Lanes::run(size_t nLanes) {
+	data.clear(constSize * width);
+
+	groups.assign(1, Group{ 0, constSize, constSize + FrameSize - 1, {} });
+	for (unsigned lane = 0; lane < nLanes; ++lane)
+		groups.front().lanes.push_back(lane);
+
+	while (!groups.empty()) {
+		size_t g = 0;
+		for (size_t i = 1; i < groups.size(); ++i)
+			if (groups[i].pc < groups[g].pc)
+				g = i;
+
+		step(groups[g]);
+
+		if (groups[g].lanes.empty())
+			groups.erase(groups.begin() + g);
+		else if (groups.size() > 1 || !spawned.empty())
+			merge(g);
+
+		for (auto& s : spawned)
+			if (!s.lanes.empty())
+				groups.push_back(move(s));
+		spawned.clear();
+	}
+}
+
+/********************************************************************************************//**
+ * Executes the instruction at g.pc, for each of g's lanes. Checks as PInterp::step(), and each
+ * of its instructions, do, other than the messages; a lane's fault is reported once it stops.
+ *
+ * @param	g	The group
+ ************************************************************************************************/
+void Lanes::step(Group& g) {
+	const InstrVector& code = program->code();
+	if (g.pc >= code.size()) {
+		prevPc = g.pc;
+		stop(g, Result::badFetch);
+		return;
+	}
+
+	prevPc = g.pc++;
+	const Instr& ir = code[prevPc];
+	const size_t sp = g.sp;
+	++ndispatched;
+	nexecuted += g.lanes.size();
+
+	if (sp < OpCodeInfo::info(ir.op).nElements()) {
+		stop(g, Result::stackUnderflow);
+		return;
+	}
+
+	switch (ir.op) {
+	case OpCode::NEG:
+		each(g, [&](unsigned l) -> Result {
+			Datum& TOS = at(sp, l);
+			if (!TOS.numeric())
+				return Result::badDataType;
+			TOS = -TOS;
+			return Result::success;
+		});
+		break;
+
+	case OpCode::ITOR:
+	case OpCode::ITOR2: {
+		const size_t addr = ir.op == OpCode::ITOR ? sp : sp - 1;
+		each(g, [&](unsigned l) -> Result {
+			Datum& value = at(addr, l);
+			if (!value.integral())
+				return Result::badDataType;
+			value = value.real();
+			return Result::success;
+		});
+		break;
+	}
+
+	case OpCode::ITOL:
+	case OpCode::ITOL2: {
+		const size_t addr = ir.op == OpCode::ITOL ? sp : sp - 1;
+		each(g, [&](unsigned l) -> Result {
+			Datum& value = at(addr, l);
+			if (value.kind() != Datum::Integer)
+				return Result::badDataType;
+			value = value.longint();
+			return Result::success;
+		});
+		break;
+	}
+
+	case OpCode::LTOI:
+		each(g, [&](unsigned l) -> Result {
+			Datum& TOS = at(sp, l);
+			if (TOS.kind() != Datum::LongInt)
+				return Result::badDataType;
+			else if (TOS.longint() < numeric_limits<int>::min() || TOS.longint() > numeric_limits<int>::max())
+				return Result::outOfRange;
+			TOS = static_cast<int>(TOS.longint());
+			return Result::success;
+		});
+		break;
+
+	case OpCode::ROUND:
+	case OpCode::TRUNC:
+		each(g, [&](unsigned l) -> Result {
+			Datum& TOS = at(sp, l);
+			if (TOS.kind() != Datum::Real)
+				return Result::badDataType;
+			TOS = static_cast<int>(ir.op == OpCode::ROUND ? round(TOS.real()) : TOS.real());
+			return Result::success;
+		});
+		break;
+
+	case OpCode::ABS:
+		each(g, [&](unsigned l) -> Result {
+			Datum& TOS = at(sp, l);
+			if (TOS.kind() == Datum::Integer)
+				TOS = abs(TOS.integer());
+			else if (TOS.kind() == Datum::LongInt)
+				TOS = TOS.longint() < 0 ? -TOS.longint() : TOS.longint();
+			else if (TOS.kind() == Datum::Real)
+				TOS = fabs(TOS.real());
+			else
+				return Result::badDataType;
+			return Result::success;
+		});
+		break;
+
+	case OpCode::ATAN:
+	case OpCode::EXP:
+	case OpCode::SIN:
+	case OpCode::SQRT:
+		each(g, [&](unsigned l) -> Result {
+			Datum& TOS = at(sp, l);
+			if (!TOS.numeric())
+				return Result::badDataType;
+
+			const double x = TOS.real();
+			switch (ir.op) {
+			case OpCode::ATAN:	TOS = atan(x);	break;
+			case OpCode::EXP:	TOS = exp(x);	break;
+			case OpCode::SIN:	TOS = sin(x);	break;
+			default:			TOS = sqrt(x);	break;
+			}
+			return Result::success;
+		});
+		break;
+
+	case OpCode::LOG:
+		each(g, [&](unsigned l) -> Result {
+			Datum& TOS = at(sp, l);
+			if (!TOS.numeric())
+				return Result::badDataType;
+			else if (TOS.kind() == Datum::Real ? TOS.real() == 0.0 : TOS.zero())
+				return Result::divideByZero;
+			TOS = log(TOS.real());
+			return Result::success;
+		});
+		break;
+
+	case OpCode::DUP:
+		for (const auto l : g.lanes)
+			at(sp + 1, l) = at(sp, l);
+		++g.sp;
+		break;
+
+	case OpCode::ODD:
+		each(g, [&](unsigned l) -> Result {
+			Datum& TOS = at(sp, l);
+			if (!TOS.integral())
+				return Result::badDataType;
+			TOS = (TOS.longint() & 1) ? true : false;
+			return Result::success;
+		});
+		break;
+
+	case OpCode::PRED:
+		each(g, [&](unsigned l) -> Result {
+			Datum& TOS = at(sp, l);
+			Result r = Result::success;
+			if (!TOS.numeric())
+				r = Result::badDataType;
+			else if (TOS <= ir.value)
+				r = Result::outOfRange;
+			--TOS;
+			return r;
+		});
+		break;
+
+	case OpCode::SUCC:
+		each(g, [&](unsigned l) -> Result {
+			Datum& TOS = at(sp, l);
+			Result r = Result::success;
+			if (TOS >= ir.value)
+				r = Result::outOfRange;
+			++TOS;
+			return r;
+		});
+		break;
+
+	case OpCode::SQR:
+		each(g, [&](unsigned l) -> Result {
+			Datum& TOS = at(sp, l);
+			if (TOS.kind() == Datum::Integer)
+				TOS = TOS.integer() * TOS.integer();
+			else if (TOS.kind() == Datum::LongInt)
+				TOS = TOS.longint() * TOS.longint();
+			else if (TOS.kind() == Datum::Real)
+				TOS = TOS.real() * TOS.real();
+			else
+				return Result::badDataType;
+			return Result::success;
+		});
+		break;
+
+	case OpCode::GET:
+		if (ir.value.kind() != Datum::Integer) {
+			stop(g, Result::badDataType);
+			break;
+		}
+
+		each(g, [&](unsigned l) -> Result {
+			const Datum& nValue = at(sp, l);
+			const Datum& addrValue = at(sp - 1, l);
+			if (nValue.kind() != Datum::Integer || nValue.integer() < 0 ||
+					addrValue.kind() != Datum::Integer || addrValue.integer() < 0)
+				return Result::badDataType;
+
+			const size_t n = nValue.natural(), addr = addrValue.natural();
+			if (!writeCheck(addr, addr + n, sp - 2))
+				return Result::stackUnderflow;
+
+			switch (ir.value.natural()) {
+			case Datum::Boolean:	return get<bool>(l, addr, n);
+			case Datum::Character:	return get<char>(l, addr, n);
+			case Datum::Integer:	return get<int>(l, addr, n);
+			case Datum::LongInt:	return get<int64_t>(l, addr, n);
+			case Datum::Real:		return get<double>(l, addr, n);
+			default:				return Result::badDataType;
+			}
+		});
+		g.sp -= 2;
+		break;
+
+	case OpCode::PUT:
+	case OpCode::PUTLN:
+		branch(g, [&](unsigned l, Regs& regs) -> Result {
+			const Datum& prec = at(sp, l);
+			const Datum& width = at(sp - 1, l);
+			const Datum& nValue = at(sp - 2, l);
+			if (prec.kind() != Datum::Integer || width.kind() != Datum::Integer ||
+					nValue.kind() != Datum::Integer || nValue.integer() < 0)
+				return Result::badDataType;
+
+			const size_t n = nValue.natural();
+			if (sp < 3 || n > sp - 3)
+				return Result::stackUnderflow;
+
+			DatumVector values(n);
+			for (size_t i = 0; i < n; ++i)
+				values[i] = at(sp - 2 - n + i, l);
+
+			ostream& out = lanes[l].out;
+			const Result r = PInterp::write(out, values.data(), n, width.integer(), prec.integer());
+			if (ir.op == OpCode::PUTLN)
+				out << '\n';
+
+			regs.sp = sp - 3 - n;
+			return r;
+		});
+		break;
+
+	case OpCode::PUTS:
+	case OpCode::PUTSLN: {
+		const Program::Literal* lit = program->literal(ir.value.natural());
+		if (lit == nullptr || Result::success != lit->result) {
+			stop(g, lit == nullptr ? Result::outOfRange : lit->result);
+			break;
+		}
+
+		for (const auto l : g.lanes) {
+			lanes[l].out.write(lit->text.data(), lit->text.size());
+			if (ir.op == OpCode::PUTSLN)
+				lanes[l].out << '\n';
+		}
+		break;
+	}
+
+	case OpCode::ADD:
+	case OpCode::SUB:
+	case OpCode::MUL:
+	case OpCode::BAND:
+	case OpCode::BOR:
+	case OpCode::BXOR:
+	case OpCode::SHIFTL:
+	case OpCode::SHIFTR:
+		each(g, [&](unsigned l) -> Result {
+			Datum& lhs = at(sp - 1, l);
+			const Datum& rhs = at(sp, l);
+			if (!lhs.numeric() || !rhs.numeric())
+				return Result::badDataType;
+
+			switch (ir.op) {
+			case OpCode::ADD:		lhs = lhs + rhs;	break;
+			case OpCode::SUB:		lhs = lhs - rhs;	break;
+			case OpCode::MUL:		lhs = lhs * rhs;	break;
+			case OpCode::BAND:		lhs = lhs & rhs;	break;
+			case OpCode::BOR:		lhs = lhs | rhs;	break;
+			case OpCode::BXOR:		lhs = lhs ^ rhs;	break;
+			case OpCode::SHIFTL:	lhs = lhs << rhs;	break;
+			default:				lhs = lhs >> rhs;	break;
+			}
+			return Result::success;
+		});
+		--g.sp;
+		break;
+
+	case OpCode::DIV:
+		each(g, [&](unsigned l) -> Result {
+			Datum& lhs = at(sp - 1, l);
+			const Datum& rhs = at(sp, l);
+			if (!lhs.numeric() || !rhs.numeric())
+				return Result::badDataType;
+			else if (rhs.kind() == Datum::Real ? rhs.real() == 0.0 : rhs.integral() && rhs.zero())
+				return Result::divideByZero;
+			lhs = lhs / rhs;
+			return Result::success;
+		});
+		--g.sp;
+		break;
+
+	case OpCode::REM:
+		each(g, [&](unsigned l) -> Result {
+			Datum& lhs = at(sp - 1, l);
+			const Datum& rhs = at(sp, l);
+			if (!lhs.integral() || lhs.kind() != rhs.kind())
+				return Result::badDataType;
+			else if (rhs.zero())
+				return Result::divideByZero;
+			lhs = lhs % rhs;
+			return Result::success;
+		});
+		--g.sp;
+		break;
+
+	case OpCode::BNOT:
+		each(g, [&](unsigned l) -> Result {
+			Datum& TOS = at(sp, l);
+			if (!TOS.numeric())
+				return Result::badDataType;
+			TOS = ~TOS;
+			return Result::success;
+		});
+		break;
+
+	case OpCode::LT:
+	case OpCode::LTE:
+	case OpCode::EQU:
+	case OpCode::GTE:
+	case OpCode::GT:
+	case OpCode::NEQ:
+		each(g, [&](unsigned l) -> Result {
+			Datum& lhs = at(sp - 1, l);
+			const Datum& rhs = at(sp, l);
+			if (!lhs.numeric() || !rhs.numeric())
+				return Result::badDataType;
+
+			bool value = false;
+			switch (ir.op) {
+			case OpCode::LT:	value = lhs < rhs;		break;
+			case OpCode::LTE:	value = lhs <= rhs;		break;
+			case OpCode::EQU:	value = lhs == rhs;		break;
+			case OpCode::GTE:	value = lhs >= rhs;		break;
+			case OpCode::GT:	value = lhs > rhs;		break;
+			default:			value = lhs != rhs;		break;
+			}
+			lhs = value;
+			return Result::success;
+		});
+		--g.sp;
+		break;
+
+	case OpCode::OR:
+	case OpCode::AND:
+		each(g, [&](unsigned l) -> Result {
+			Datum& lhs = at(sp - 1, l);
+			const Datum& rhs = at(sp, l);
+			if (lhs.kind() != Datum::Boolean || rhs.kind() != Datum::Boolean)
+				return Result::badDataType;
+			lhs = ir.op == OpCode::OR ? (lhs || rhs) : (lhs && rhs);
+			return Result::success;
+		});
+		--g.sp;
+		break;
+
+	case OpCode::NOT:
+		each(g, [&](unsigned l) -> Result {
+			Datum& TOS = at(sp, l);
+			if (TOS.kind() != Datum::Boolean)
+				return Result::badDataType;
+			TOS = !TOS.boolean();
+			return Result::success;
+		});
+		break;
+
+	case OpCode::POP:
+		if (ir.value < Datum(0) || sp < ir.value.natural())
+			stop(g, Result::stackUnderflow);
+		else
+			g.sp -= ir.value.natural();
+		break;
+
+	case OpCode::PUSH:
+		for (const auto l : g.lanes)
+			at(sp + 1, l) = ir.value;
+		++g.sp;
+		break;
+
+	case OpCode::PUSHVAR:
+		each(g, [&](unsigned l) -> Result {
+			at(sp + 1, l) = base(g.fp, ir.level, l) + ir.value.integer();
+			return Result::success;
+		});
+		++g.sp;
+		break;
+
+	case OpCode::EVAL: {
+		const size_t n = ir.value.natural();
+		if (sp < n) {
+			stop(g, Result::stackUnderflow);
+			break;
+
+		} else if (sp - 1 + n >= stackEnd) {
+			stop(g, Result::stackOverflow);
+			break;
+		}
+
+		each(g, [&](unsigned l) -> Result {
+			const size_t src = at(sp, l).natural();
+			if (!rangeCheck(src, src + n, sp - 1))
+				return Result::stackUnderflow;
+			for (size_t i = 0; i < n; ++i)
+				at(sp + i, l) = at(src + i, l);
+			return Result::success;
+		});
+		g.sp = sp - 1 + n;
+		break;
+	}
+
+	case OpCode::ASSIGN: {
+		const size_t n = ir.value.natural();
+		if (sp < n) {
+			stop(g, Result::stackUnderflow);
+			break;
+		}
+
+		each(g, [&](unsigned l) -> Result {
+			const size_t dst = at(sp - n, l).natural();
+			if (!writeCheck(dst, dst + n, sp))
+				return Result::stackUnderflow;
+			for (size_t i = 0; i < n; ++i)
+				at(dst + i, l) = at(sp - n + 1 + i, l);
+			return Result::success;
+		});
+		g.sp -= n + 1;
+		break;
+	}
+
+	case OpCode::COPY: {
+		const size_t n = ir.value.natural();
+		each(g, [&](unsigned l) -> Result {
+			const size_t src = at(sp, l).natural();
+			const size_t dst = at(sp - 1, l).natural();
+			if (!rangeCheck(src, src + n, sp - 1) || !writeCheck(dst, dst + n, sp - 2))
+				return Result::stackUnderflow;
+			for (size_t i = 0; i < n; ++i)
+				at(dst + i, l) = at(src + i, l);
+			return Result::success;
+		});
+		g.sp -= 2;
+		break;
+	}
+
+	case OpCode::CALL:
+		branch(g, [&](unsigned l, Regs& regs) -> Result {
+			const size_t addr = at(sp, l).natural();
+			const size_t frame = sp - 1;	// Replacing the address, and level
+			at(frame, l) = base(g.fp, at(sp - 1, l).integer(), l);
+			at(frame + FrameOldFp, l) = g.fp;
+			at(frame + FrameRetAddr, l) = g.pc;
+			at(frame + FrameRetVal, l) = 0ul;
+
+			regs.pc = addr;
+			regs.fp = frame;
+			regs.sp = frame + FrameRetVal;
+			return Result::success;
+		});
+		break;
+
+	case OpCode::CALLI:
+		each(g, [&](unsigned l) -> Result {
+			at(sp + 1, l) = base(g.fp, ir.level, l);
+			at(sp + 1 + FrameOldFp, l) = g.fp;
+			at(sp + 1 + FrameRetAddr, l) = g.pc;
+			at(sp + 1 + FrameRetVal, l) = 0ul;
+			return Result::success;
+		});
+		g.fp = sp + 1;
+		g.sp = g.fp + FrameRetVal;
+		g.pc = ir.value.natural();
+		break;
+
+	case OpCode::RET:
+	case OpCode::RETF:
+		branch(g, [&](unsigned l, Regs& regs) -> Result {
+			const Datum value = at(g.fp + FrameRetVal, l);
+
+			regs.sp = g.fp - 1 - ir.value.natural();
+			regs.pc = at(g.fp + FrameRetAddr, l).natural();
+			regs.fp = at(g.fp + FrameOldFp, l).natural();
+			if (ir.op == OpCode::RETF)
+				at(++regs.sp, l) = value;
+			return Result::success;
+		});
+		break;
+
+	case OpCode::ENTER:
+		if (sp + ir.value.integer() >= stackEnd)
+			stop(g, Result::stackOverflow);
+		else
+			g.sp += ir.value.integer();
+		break;
+
+	case OpCode::JUMP:
+		branch(g, [&](unsigned l, Regs& regs) -> Result {
+			regs.pc = at(sp, l).natural();
+			regs.sp = sp - 1;
+			return Result::success;
+		});
+		break;
+
+	case OpCode::JUMPI:
+		g.pc = ir.value.natural();
+		break;
+
+	case OpCode::JNEQ:
+	case OpCode::JNEQI:
+		branch(g, [&](unsigned l, Regs& regs) -> Result {
+			const bool immediate = ir.op == OpCode::JNEQI;
+			const Datum& value = at(immediate ? sp : sp - 1, l);
+			if (value.kind() != Datum::Boolean)
+				return Result::badDataType;
+
+			regs.sp = immediate ? sp - 1 : sp - 2;
+			if (value.boolean() == false)
+				regs.pc = immediate ? ir.value.natural() : at(sp, l).natural();
+			return Result::success;
+		});
+		break;
+
+	case OpCode::FORPREP:
+		branch(g, [&](unsigned l, Regs& regs) -> Result {
+			const Datum limit = at(sp, l);
+			const Datum first = at(sp - 1, l);
+			const size_t addr = at(sp - 2, l).natural();
+
+			if (ir.level > 0 ? ordinal(first) > ordinal(limit) : ordinal(first) < ordinal(limit)) {
+				regs.sp = sp - 3;
+				regs.pc = ir.value.natural();
+
+			} else if (!writeCheck(addr, addr + 1, sp - 2))
+				return Result::outOfRange;
+
+			else {
+				at(addr, l) = first;
+				at(sp - 1, l) = limit;
+				regs.sp = sp - 1;
+			}
+			return Result::success;
+		});
+		break;
+
+	case OpCode::FORLOOP:
+		branch(g, [&](unsigned l, Regs& regs) -> Result {
+			const size_t addr = at(sp - 1, l).natural();
+			if (!writeCheck(addr, addr + 1, sp))
+				return Result::outOfRange;
+
+			Datum& iter = at(addr, l);
+			const int64_t value = ordinal(iter);
+			if (ir.level > 0 ? value >= ordinal(at(sp, l)) : value <= ordinal(at(sp, l))) {
+				regs.sp = sp - 2;
+				return Result::success;
+			}
+
+			switch (iter.kind()) {
+			case Datum::Boolean:	iter = Datum(ir.level > 0);								break;
+			case Datum::Character:	iter = Datum(static_cast<char>(value + ir.level));		break;
+			case Datum::LongInt:	iter = Datum(static_cast<int64_t>(value + ir.level));	break;
+			default:				iter = Datum(static_cast<int>(value + ir.level));		break;
+			}
+			regs.pc = ir.value.natural();
+			return Result::success;
+		});
+		break;
+
+	case OpCode::LLIMIT:
+	case OpCode::ULIMIT:
+		each(g, [&](unsigned l) -> Result {
+			const Datum& TOS = at(sp, l);
+			if (!TOS.ordinal())
+				return Result::badDataType;
+
+			Datum i = TOS;
+			if (TOS.kind() == Datum::Boolean)
+				i = Datum(TOS.boolean() ? 1 : 0);
+			else if (TOS.kind() == Datum::Character)
+				i = Datum(static_cast<size_t>(TOS.character()));
+
+			const bool out = ir.op == OpCode::LLIMIT ? i < ir.value : i > ir.value;
+			return out ? Result::outOfRange : Result::success;
+		});
+		break;
+
+	case OpCode::NOP:
+	case OpCode::READY:
+		break;
+
+	case OpCode::HALT:
+		stop(g, Result::halted);
+		break;
+
+	default:								// Not supported()
+		stop(g, Result::unknownInstr);
+		break;
+	}
+
+	if (g.sp >= stackEnd)
+		stop(g, Result::stackOverflow);
+	for (auto& s : spawned)
+		if (s.sp >= stackEnd)
+			stop(s, Result::stackOverflow);
+}
+
+// public
+
+/********************************************************************************************//**
+ * @param	n		The number of lanes
+ * @param	stackSz	The size of each lane's stack, in Datums
+ ************************************************************************************************/
+Lanes::Lanes(unsigned n, unsigned stackSz)
+	:	width{max(n, 1u)},
+		stackSize{stackSz},
+		constSize{0},
+		stackEnd{0},
+		lanes(width),
+		prevPc{0},
+		ndispatched{0},
+		nexecuted{0}
+{
+}
+
+/********************************************************************************************//**
+ * @param	prog	The program
+ * @return	true if every instruction in prog has a lane handler
+ ************************************************************************************************/
+bool Lanes::supported(const Program& prog) {
+	for (const auto& instr : prog.code())
+		switch (instr.op) {
+		case OpCode::GETLN:
+		case OpCode::NEW:
+		case OpCode::DISPOSE:
+		case OpCode::CALLX:
+		case OpCode::BREAK:
+			return false;
+
+		default:
+			if (instr.op > OpCode::HALT)
+				return false;
+		}
+
+	return true;
+}
+
+/********************************************************************************************//**
+ * Runs the records N at a time; each lane's output is written, and its fault, if any, reported
+ * on standard error, as PInterp::run() does, in record order.
+ *
+ * @param	prog	The program, which must be supported()
+ * @param	records	Each lane's standard input
+ * @param	out		Where to write each lane's output
+ * @return	Each record's result; Result::halted, or the fault
+ ************************************************************************************************/
+vector<Result> Lanes::operator()(ProgramPtr prog, const vector<string>& records, ostream& out) {
+	if (prog.get() != program.get())
+		load(prog);
+
+	vector<Result> results;
+	for (size_t first = 0; first < records.size(); first += width) {
+		const size_t n = min<size_t>(width, records.size() - first);
+		for (size_t l = 0; l < n; ++l) {
+			Lane& lane = lanes[l];
+			lane.in.clear();
+			lane.in.str(records[first + l]);
+			lane.out.str("");
+			lane.result = Result::success;
+		}
+
+		run(n);
+
+		for (size_t l = 0; l < n; ++l) {
+			const Lane& lane = lanes[l];
+			out << lane.out.str();
+			if (lane.result == Result::stackOverflow) {
+				out.flush();
+				cerr << "runtime error @pc " << lane.pc << ": " << lane.result << endl;
+
+			} else if (lane.result != Result::halted) {
+				out.flush();
+				cerr << "runtime error @pc " << lane.pc << ", sp: " << lane.sp << ": " << lane.result << endl;
+			}
+			results.push_back(lane.result);
+		}
+	}
+
+	return results;
+}
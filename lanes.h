@@ -0,0 +1,124 @@
+/********************************************************************************************//**
+ * @file lanes.h
+ *
+ * Data-parallel execution of a program over a batch of input records.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	LANES_H
+#define LANES_H
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "datasegment.h"
+#include "program.h"
+#include "results.h"
+
+/********************************************************************************************//**
+ * A Lockstep, Multi-Instance, Machine
+ *
+ * Runs up to N instances, or lanes, of the same program in lockstep, each over its own input
+ * record; an instruction is fetched, and dispatched, once for a group of lanes, and its handler
+ * loops over the group's lanes.
+ *
+ * The lanes' data segments are laid out structure-of-arrays; lane l's Datum at address a is at
+ * a * N + l, so each handler's loop over a group walks consecutive Datums. The constants are
+ * replicated in each lane. There's no free store, so programs that use NEW, DISPOSE or CALLX
+ * aren't supported(); nor is GETLN, or BREAK.
+ *
+ * A group's lanes share pc, fp and sp. A branch, call or return whose target depends on the
+ * lanes' data splits the group into one group for each target; a lane that faults is dropped
+ * from its group, as is one that halts. Groups are scheduled lowest pc first, so that the lanes
+ * that skipped ahead wait for the others, and groups that arrive at the same pc, fp and sp are
+ * merged again.
+ *
+ * Each lane's output is captured, and written, in lane order, once every lane has stopped, so
+ * the output is the same as running the records one after another.
+ ************************************************************************************************/
+class Lanes {
+public:
+	/// Construct a machine of n lanes, each with a stack of stackSz Datums
+	Lanes(unsigned n, unsigned stackSz = 1024);
+	virtual ~Lanes() {}
+
+	/// Can prog run on lanes?
+	static bool supported(const Program& prog);
+
+	/// Run prog once for each record, at most N at a time, writing their output on out...
+	std::vector<Result> operator()(ProgramPtr prog, const std::vector<std::string>& records, std::ostream& out);
+
+	size_t dispatched() const			{	return ndispatched;	}	///< Return the instructions dispatched
+	size_t executed() const				{	return nexecuted;	}	///< Return the lane instructions executed
+
+private:
+	/// A group of lanes, at the same pc, fp and sp
+	struct Group {
+		size_t					pc;			///< Program counter
+		size_t					fp;			///< Frame pointer
+		size_t					sp;			///< Stack pointer
+		std::vector<unsigned>	lanes;		///< The group's lanes, in ascending order
+	};
+
+	/// A lane's registers, after a branch
+	struct Regs {
+		size_t					pc;			///< Program counter
+		size_t					fp;			///< Frame pointer
+		size_t					sp;			///< Stack pointer
+	};
+
+	/// A lane's input, output, and how it stopped
+	struct Lane {
+		std::istringstream		in;			///< The lane's record
+		std::ostringstream		out;		///< Captured output
+		Result					result;		///< halted, or the fault
+		size_t					pc;			///< Address of the last instruction executed
+		size_t					sp;			///< The stack pointer, when it stopped
+	};
+
+	unsigned				width;			///< Number of lanes
+	unsigned				stackSize;		///< Size of each lane's stack, in Datums
+	ProgramPtr				program;		///< The loaded program
+	size_t					constSize;		///< Size of the constant segment, in Datums
+	size_t					stackEnd;		///< One past the end of each lane's stack
+	DataSegment				data;			///< Every lane's data segment, structure-of-arrays
+	std::vector<Lane>		lanes;			///< The lanes, for the current records
+	std::vector<Group>		groups;			///< Groups that haven't stopped
+	std::vector<Group>		spawned;		///< Groups split off by the last instruction
+	size_t					prevPc;			///< Address of the instruction being executed
+	size_t					ndispatched;	///< Instructions dispatched, for any number of lanes
+	size_t					nexecuted;		///< Instructions executed, by each lane
+
+	/// Return lane's Datum at addr
+	Datum& at(size_t addr, unsigned lane)	{	return data[addr * width + lane];	}
+
+	void load(ProgramPtr prog);				///< Load prog, and lay out the data segments
+	void run(size_t nLanes);				///< Run nLanes lanes, until every lane stops
+	void step(Group& g);					///< Execute g's next instruction
+	void stop(Group& g, Result r);			///< Stop every lane in g
+	void stop(unsigned lane, const Group& g, Result r);	///< Stop a single lane
+	void merge(size_t g);					///< Merge groups at the same registers as groups[g]
+
+	size_t base(size_t fp, size_t nlevel, unsigned lane);	///< Find lane's activation base...
+
+	/// Return true if [begin, end) is on the stack, up to sp
+	static bool rangeCheck(size_t begin, size_t end, size_t sp);
+
+	/// Return true if [begin, end) is on the stack, up to sp, and writable
+	bool writeCheck(size_t begin, size_t end, size_t sp) const;
+
+	/// Apply f to each lane of g, dropping the lanes where it fails
+	template <class F> void each(Group& g, F f);
+
+	/// Apply f to each lane of g, each setting its registers; splitting g by register values
+	template <class F> void branch(Group& g, F f);
+
+	/// Read n values into lane's [addr, addr+n), from its record
+	template <class T> Result get(unsigned lane, size_t addr, size_t n);
+};
+
+#endif
@@ -0,0 +1,203 @@
+/********************************************************************************************//**
+ * @file lockstep.cc
+ *
+ * class Lockstep implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include <algorithm>
+
+#include "lockstep.h"
+
+using namespace std;
+
+/********************************************************************************************//**
+ * @param	a	An instruction
+ * @param	b	Another instruction
+ * @return	true if a and b are the same instruction
+ ************************************************************************************************/
+static bool same(const Instr& a, const Instr& b) {
+	return a.op == b.op && a.level == b.level && a.value == b.value;
+}
+
+/********************************************************************************************//**
+ * @param	str	A string
+ * @return	str, with newlines, and tabs, escaped
+ ************************************************************************************************/
+static string escape(const string& str) {
+	string s;
+	for (auto c : str)
+		switch (c) {
+		case '\n':	s += "\\n";	break;
+		case '\t':	s += "\\t";	break;
+		default:	s += c;		break;
+		}
+
+	return s;
+}
+
+// private
+
+/********************************************************************************************//**
+ * Execute a single instruction on run's machine, with its own input and output.
+ *
+ * @param	run	The run to step
+ * @return	The instructions result
+ ************************************************************************************************/
+Result Lockstep::step(Run& run) {
+	streambuf* const out = cout.rdbuf(run.out.rdbuf());
+	streambuf* const in = cin.rdbuf(run.in.rdbuf());
+
+	run.result = run.engine.machine.single();
+	++run.steps;
+
+	cout.rdbuf(out);
+	cin.rdbuf(in);
+
+	return run.result;
+}
+
+/********************************************************************************************//**
+ * Run until the next call, output instruction, or the end of the run.
+ *
+ * @param	run	The run to continue
+ * @return	A description of the synchronization point
+ ************************************************************************************************/
+string Lockstep::sync(Run& run) {
+	while (step(run) == Result::success) {
+		const OpCode op = run.engine.machine.irReg().op;
+		if (op == OpCode::CALL || op == OpCode::CALLI) {
+			const auto it = run.engine.subrs.find(run.engine.machine.pcReg());
+			if (it == run.engine.subrs.end())
+				return "call ?";
+
+			// A specialized clone, e.g., fib'1, is the same subroutine as the original, fib
+			return "call " + it->second.substr(0, it->second.find('\''));
+
+		} else if (op == OpCode::PUT || op == OpCode::PUTLN || op == OpCode::PUTS || op == OpCode::PUTSLN)
+			return "output \"" + escape(run.out.str()) + '"';
+	}
+
+	ostringstream oss;
+	oss << "end: " << (run.result == Result::halted ? Result::success : run.result);
+	return oss.str();
+}
+
+/********************************************************************************************//**
+ * Step both machines, comparing their states after every instruction.
+ *
+ * @param	report	Where to write the first divergence
+ * @return	true if the runs never diverged
+ ************************************************************************************************/
+bool Lockstep::compare(ostream& report) {
+	for (;;) {
+		const Result r = step(ref), c = step(cand);
+		const PInterp& rm = ref.engine.machine;
+		const PInterp& cm = cand.engine.machine;
+
+		size_t raddr = 0, caddr = 0;
+		Datum rvalue, cvalue;
+		const bool rw = rm.written(raddr, rvalue), cw = cm.written(caddr, cvalue);
+
+		if (r != c)
+			return diverged(report, "result");
+		else if (rm.pcReg() != cm.pcReg())
+			return diverged(report, "pc");
+		else if (rm.spReg() != cm.spReg())
+			return diverged(report, "sp");
+		else if (rm.fpReg() != cm.fpReg())
+			return diverged(report, "fp");
+		else if (rw != cw || raddr != caddr || !(rvalue == cvalue))
+			return diverged(report, "memory write");
+		else if (ref.out.tellp() != cand.out.tellp() || ref.out.str() != cand.out.str())
+			return diverged(report, "output");
+		else if (r != Result::success)
+			return true;
+	}
+}
+
+/********************************************************************************************//**
+ * @param	report	Where to write the report
+ * @param	what	What diverged
+ * @return	false
+ ************************************************************************************************/
+bool Lockstep::diverged(ostream& report, const string& what) {
+	report << "lockstep: " << what << " diverged after " << ref.steps << " " << ref.engine.name
+		   << ", and " << cand.steps << " " << cand.engine.name << ", instructions\n";
+	state(report, ref);
+	state(report, cand);
+	return false;
+}
+
+/********************************************************************************************//**
+ * @param	report	Where to write the state
+ * @param	run		The run to report on
+ ************************************************************************************************/
+void Lockstep::state(ostream& report, const Run& run) const {
+	const PInterp& m = run.engine.machine;
+
+	report	<< "  " << run.engine.name << ": " << run.result
+			<< ", pc: " << m.pcReg() << ", sp: " << m.spReg() << ", fp: " << m.fpReg();
+
+	size_t addr = 0;
+	Datum value;
+	if (m.written(addr, value))
+		report << ", wrote " << value << " @" << addr;
+
+	const string out = run.out.str();
+	const size_t n = min<size_t>(out.size(), 40);
+	report << ", output: \"" << (n < out.size() ? "..." : "") << escape(out.substr(out.size() - n)) << "\"\n";
+
+	report << "  last instruction ";
+	disasm(report, m.prevPcReg(), m.irReg());
+}
+
+// public
+
+/********************************************************************************************//**
+ * @param	reference	The reference engine
+ * @param	candidate	The candidate engine
+ * @param	input		Input for both engines
+ ************************************************************************************************/
+Lockstep::Lockstep(const Engine& reference, const Engine& candidate, const string& input)
+	: ref(reference, input), cand(candidate, input)
+{
+}
+
+/********************************************************************************************//**
+ * @param	report	Where to write the first divergence, or a summary
+ * @return	true if the runs never diverged
+ ************************************************************************************************/
+bool Lockstep::operator()(ostream& report) {
+	ref.engine.machine.load(ref.engine.program);
+	cand.engine.machine.load(cand.engine.program);
+
+	const InstrVector& rcode = ref.engine.program->code();
+	const InstrVector& ccode = cand.engine.program->code();
+	const bool lockstep = rcode.size() == ccode.size() &&
+		equal(rcode.begin(), rcode.end(), ccode.begin(), same);
+
+	bool ok = true;
+	if (lockstep)
+		ok = compare(report);
+
+	else for (;;) {
+		const string r = sync(ref), c = sync(cand);
+		if (r != c) {
+			ok = diverged(report, "synchronization point");
+			report << "  " << ref.engine.name << ": " << r << "\n"
+				   << "  " << cand.engine.name << ": " << c << "\n";
+			break;
+
+		} else if (ref.result != Result::success)
+			break;
+	}
+
+	if (ok)
+		report	<< "lockstep: " << (lockstep ? "identical code" : "differing code") << ", "
+				<< ref.steps << " " << ref.engine.name << ", and " << cand.steps << " "
+				<< cand.engine.name << ", instructions, no divergence\n";
+	return ok;
+}
@@ -0,0 +1,73 @@
+/********************************************************************************************//**
+ * @file lockstep.h
+ *
+ * Lockstep differential execution of a program on two P machines.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "interp.h"
+
+/********************************************************************************************//**
+ * A Lockstep Differential Harness
+ *
+ * Runs a reference engine, and a candidate engine, side by side, reporting the first point where
+ * they diverge. Each engine is a machine, and the code it runs; e.g., the same program compiled
+ * with, and without, optimizations.
+ *
+ * If both engines run the same code, they're compared after every instruction; pc, sp, fp, the
+ * result, the address and value written, if any, and the output. Otherwise they're compared at
+ * synchronization points; each call, by subroutine name, each output instruction, by the output
+ * so far, and the end of the run, by result.
+ *
+ * Each engine's output is captured, and each reads the same, captured, input.
+ ************************************************************************************************/
+class Lockstep {
+public:
+	/// An execution engine; a machine, and the program it runs
+	struct Engine {
+		std::string			name;			///< Engine name, for the report
+		PInterp&			machine;		///< The machine
+		ProgramPtr			program;		///< The program
+		const SubrMap&		subrs;			///< The program's subroutine names, by entry point
+	};
+
+	/// Construct a harness for a pair of engines, reading input
+	Lockstep(const Engine& reference, const Engine& candidate, const std::string& input = "");
+	virtual ~Lockstep() {}
+
+	/// Run both engines to completion, or divergence...
+	bool operator()(std::ostream& report);
+
+private:
+	/// An engine's run state
+	struct Run {
+		Engine				engine;			///< The engine
+		std::ostringstream	out;			///< Captured output
+		std::istringstream	in;				///< Input
+		size_t				steps;			///< Instructions executed
+		Result				result;			///< Result of the last instruction
+
+		Run(const Engine& e, const std::string& input)
+			: engine(e), in{input}, steps{0}, result{Result::success} {}
+	};
+
+	Run		ref;							///< The reference run
+	Run		cand;							///< The candidate run
+
+	Result step(Run& run);					///< Execute a single instruction
+	std::string sync(Run& run);				///< Run to the next synchronization point
+	bool compare(std::ostream& report);		///< Compare machine state after each instruction
+	bool diverged(std::ostream& report, const std::string& what);
+	void state(std::ostream& report, const Run& run) const;
+};
+
+#endif
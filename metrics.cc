@@ -0,0 +1,222 @@
+/********************************************************************************************//**
+ * @file metrics.cc
+ *
+ * class Metrics implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
+#include "metrics.h"
+
+using namespace std;
+
+/********************************************************************************************//**
+ * class Metrics::OutCounter
+ ************************************************************************************************/
+
+/********************************************************************************************//**
+ * @param	c	The character to write
+ * @return	c, or eof if target failed
+ ************************************************************************************************/
+Metrics::OutCounter::int_type Metrics::OutCounter::overflow(int_type c) {
+	if (traits_type::eq_int_type(c, traits_type::eof()))
+		return traits_type::not_eof(c);
+
+	const int_type r = target->sputc(traits_type::to_char_type(c));
+	if (!traits_type::eq_int_type(r, traits_type::eof()))
+		++count;
+
+	return r;
+}
+
+/********************************************************************************************//**
+ * @param	s	The characters to write
+ * @param	n	The number of characters
+ * @return	The number of characters written
+ ************************************************************************************************/
+streamsize Metrics::OutCounter::xsputn(const char* s, streamsize n) {
+	const streamsize r = target->sputn(s, n);
+	count += r;
+	return r;
+}
+
+/********************************************************************************************//**
+ * @return	target's result
+ ************************************************************************************************/
+int Metrics::OutCounter::sync()						{	return target->pubsync();	}
+
+/********************************************************************************************//**
+ * class Metrics::InCounter
+ ************************************************************************************************/
+
+/********************************************************************************************//**
+ * @return	The next character, without consuming it, or eof
+ ************************************************************************************************/
+Metrics::InCounter::int_type Metrics::InCounter::underflow()	{	return source->sgetc();	}
+
+/********************************************************************************************//**
+ * @return	The next character, consuming it, or eof
+ ************************************************************************************************/
+Metrics::InCounter::int_type Metrics::InCounter::uflow() {
+	const int_type c = source->sbumpc();
+	if (!traits_type::eq_int_type(c, traits_type::eof()))
+		++count;
+
+	return c;
+}
+
+/********************************************************************************************//**
+ * @return	The character put back, or eof if source couldn't put it back
+ ************************************************************************************************/
+Metrics::InCounter::int_type Metrics::InCounter::pbackfail(int_type) {
+	const int_type c = source->sungetc();
+	if (!traits_type::eq_int_type(c, traits_type::eof()) && count > 0)
+		--count;
+
+	return c;
+}
+
+/********************************************************************************************//**
+ * @return	source's estimate
+ ************************************************************************************************/
+streamsize Metrics::InCounter::showmanyc()			{	return source->in_avail();	}
+
+/********************************************************************************************//**
+ * class Metrics
+ ************************************************************************************************/
+
+// private static
+
+volatile sig_atomic_t Metrics::pending = 0;
+
+/********************************************************************************************//**
+ * Just note that a snapshot is due; the interpreter publishes it between instructions.
+ ************************************************************************************************/
+void Metrics::handler(int)							{	pending = 1;	}
+
+// public
+
+/********************************************************************************************//**
+ * @param	path	The metrics file
+ * @param	index	Source line numbers, indexed by instruction address
+ * @param	subrs	Subroutine names, by entry point
+ * @param	period	Seconds between snapshots
+ ************************************************************************************************/
+Metrics::Metrics(	const	string&				path,
+					const	vector<unsigned>&	index,
+					const	SubrMap&			subrs,
+							unsigned			period)
+	: path{path}, code{index, subrs}, period{period > 0 ? period : 1}, lastCycles{0}, running{false}
+{
+	oldAction.sa_handler = SIG_DFL;
+	sigemptyset(&oldAction.sa_mask);
+	oldAction.sa_flags = 0;
+}
+
+/********************************************************************************************//**
+ * Stops the interval timer, and I/O counting, if running
+ ************************************************************************************************/
+Metrics::~Metrics()									{	stop();			}
+
+/********************************************************************************************//**
+ * @return	false if the signal handler, or the interval timer, couldn't be set
+ ************************************************************************************************/
+bool Metrics::start() {
+	struct sigaction action;
+	action.sa_handler = handler;
+	sigemptyset(&action.sa_mask);
+	action.sa_flags = SA_RESTART;				// Don't interrupt reads from the standard input
+	if (sigaction(SIGALRM, &action, &oldAction) != 0)
+		return false;
+
+	struct itimerval timer;
+	timer.it_interval.tv_sec = period;
+	timer.it_interval.tv_usec = 0;
+	timer.it_value = timer.it_interval;
+	pending = 0;
+
+	if (setitimer(ITIMER_REAL, &timer, nullptr) != 0) {
+		sigaction(SIGALRM, &oldAction, nullptr);
+		return false;
+	}
+
+	cout.flush();
+	out.target = cout.rdbuf(&out);
+	in.source = cin.rdbuf(&in);
+	started = last = Clock::now();
+	running = true;
+
+	return true;
+}
+
+/********************************************************************************************//**
+ ************************************************************************************************/
+void Metrics::stop() {
+	if (!running)
+		return;
+
+	struct itimerval timer = {};
+	setitimer(ITIMER_REAL, &timer, nullptr);
+	sigaction(SIGALRM, &oldAction, nullptr);
+	pending = 0;
+
+	cout.flush();
+	cout.rdbuf(out.target);
+	cin.rdbuf(in.source);
+	running = false;
+}
+
+/********************************************************************************************//**
+ * @param	state	"running", "halted", or why the machine stopped
+ * @param	cycles	Machine cycles run so far
+ * @param	depth	The stack depth, in Datums
+ * @param	heap	Heap in use, in Datums
+ * @param	pc		The current instruction address
+ * @return	false if the snapshot couldn't be written
+ ************************************************************************************************/
+bool Metrics::publish(	const	string&	state,
+								size_t	cycles,
+								size_t	depth,
+								size_t	heap,
+								size_t	pc)
+{
+	pending = 0;
+
+	const Clock::time_point now = Clock::now();
+	const double interval = chrono::duration<double>(now - last).count();
+	const double rate = interval > 0 ? (cycles - lastCycles) / interval : 0.0;
+	const double epoch = chrono::duration<double>(chrono::system_clock::now().time_since_epoch()).count();
+
+	const string tmp = path + ".tmp";
+	{
+		ofstream ofile(tmp);
+		ofile	<< fixed << setprecision(3)
+				<< "pid "			<< getpid()									<< "\n"
+				<< "state "			<< state									<< "\n"
+				<< "time "			<< epoch									<< "\n"
+				<< "elapsed "		<< chrono::duration<double>(now - started).count() << "\n"
+				<< "cycles "		<< cycles									<< "\n"
+				<< "cycles/sec "	<< setprecision(0) << rate					<< "\n"
+				<< "stack "			<< depth									<< "\n"
+				<< "heap "			<< heap										<< "\n"
+				<< "subroutine "	<< code.name(pc)							<< "\n"
+				<< "line "			<< code.line(pc)							<< "\n"
+				<< "bytes-in "		<< in.count									<< "\n"
+				<< "bytes-out "		<< out.count								<< "\n";
+		if (!ofile)
+			return false;
+	}
+
+	last = now;
+	lastCycles = cycles;
+
+	return rename(tmp.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,121 @@
+/********************************************************************************************//**
+ * @file metrics.h
+ *
+ * Live run-time metrics for long running P machine programs.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	METRICS_H
+#define METRICS_H
+
+#include <signal.h>
+#include <chrono>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "profile.h"
+
+/********************************************************************************************//**
+ * A Live Metrics Publisher
+ *
+ * A POSIX interval timer (ITIMER_REAL) raises SIGALRM once every period; as with the Profiler,
+ * the handler just notes that a snapshot is due, and the interpreter calls publish() between
+ * instructions. Each snapshot is written to a temporary file, and then renamed over the metrics
+ * file, so that readers always see a complete snapshot. Placing the file in a tmpfs, e.g.,
+ * /dev/shm, keeps the updates in memory.
+ *
+ * A snapshot is a list of "name value" lines:
+ *
+ * Name         | Value
+ * ------------ | -------------------------------------------------------------
+ * pid          | The process id
+ * state        | running, halted, or the Result that stopped the machine
+ * time         | When the snapshot was taken, in seconds since the epoch
+ * elapsed      | Seconds since start()
+ * cycles       | Machine cycles run so far
+ * cycles/sec   | Cycles per second since the previous snapshot
+ * stack        | Stack depth, in Datums
+ * heap         | Heap in use, in Datums
+ * subroutine   | The subroutine being executed
+ * line         | The source line being executed
+ * bytes-in     | Bytes read from the standard input
+ * bytes-out    | Bytes written to the standard output
+ *
+ * A stalled program, e.g., one blocked on input, publishes nothing; its time stops advancing.
+ * Input and output are counted by interposing counting stream buffers on cin and cout, between
+ * start() and stop().
+ ************************************************************************************************/
+class Metrics {
+public:
+	/// Construct a metrics publisher for a program...
+	Metrics(	const	std::string&			path,
+				const	std::vector<unsigned>&	index,
+				const	SubrMap&				subrs,
+						unsigned				period = 1);
+	virtual ~Metrics();
+
+	bool start();							///< Start the interval timer, and I/O counting...
+	void stop();							///< Stop the interval timer, and I/O counting
+
+	/// Is a snapshot due?
+	static bool due()						{	return pending != 0;	}
+
+	/// Publish a snapshot of the machine's state...
+	bool publish(	const	std::string&	state,
+							size_t			cycles,
+							size_t			depth,
+							size_t			heap,
+							size_t			pc);
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	/// An output stream buffer that counts the characters written through it
+	class OutCounter : public std::streambuf {
+	public:
+		std::streambuf*	target;				///< Where the characters go
+		size_t			count;				///< Characters written so far
+
+		OutCounter() : target{nullptr}, count{0} {}
+
+	protected:
+		int_type overflow(int_type c) override;
+		std::streamsize xsputn(const char* s, std::streamsize n) override;
+		int sync() override;
+	};
+
+	/// An unbuffered input stream buffer that counts the characters read through it
+	class InCounter : public std::streambuf {
+	public:
+		std::streambuf*	source;				///< Where the characters come from
+		size_t			count;				///< Characters read so far
+
+		InCounter() : source{nullptr}, count{0} {}
+
+	protected:
+		int_type underflow() override;
+		int_type uflow() override;
+		int_type pbackfail(int_type c) override;
+		std::streamsize showmanyc() override;
+	};
+
+	static volatile sig_atomic_t pending;	///< Set by handler(), cleared by publish()
+	static void handler(int);				///< SIGALRM handler
+
+	std::string				path;			///< The metrics file
+	CodeIndex				code;			///< Source lines and subroutines by address
+	unsigned				period;			///< Seconds between snapshots
+	Clock::time_point		started;		///< When start() was called
+	Clock::time_point		last;			///< When the previous snapshot was taken
+	size_t					lastCycles;		///< Cycles at the previous snapshot
+	OutCounter				out;			///< Counts cout
+	InCounter				in;				///< Counts cin
+	bool					running;		///< Between start() and stop()?
+	struct sigaction		oldAction;		///< The previous SIGALRM action
+};
+
+#endif
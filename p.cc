@@ -5,44 +5,85 @@
  * compilier, and if no errors where encountered, passed the results to the interpreter.
  *
  * @example test/array.p
+ * @example test/asmkernel.p
+ * @example test/asmlink.p
+ * @example test/batch.p
+ * @example test/batchstate.p
  * @example test/bitwise.p
  * @example test/bool.p
  * @example test/builtins.p
  * @example test/character.p
+ * @example test/codereport.p
  * @example test/comment.p
  * @example test/divbyzero.p
  * @example test/eval.p
+ * @example test/external.p
  * @example test/fact.p
  * @example test/fahr.p
  * @example test/fib.p
  * @example test/for.p
+ * @example test/forloop.p
  * @example test/forrev.p
+ * @example test/heapprofile.p
+ * @example test/lanes.p
+ * @example test/longint.p
+ * @example test/metrics.p
  * @example test/min.p
+ * @example test/newlocal.p
+ * @example test/ngrams.p
+ * @example test/perfwarn.p
  * @example test/pointers.p
  * @example test/precedence.p
  * @example test/predfail.p
  * @example test/predsucc.p
  * @example test/proc.p
+ * @example test/propagate.p
  * @example test/rcrdtest.p
+ * @example test/ready.p
  * @example test/real.p
  * @example test/repeat.p
  * @example test/simple.p
+ * @example test/snapshot.p
+ * @example test/snapshot2.p
+ * @example test/stackoverflow.p
  * @example test/str.p
  * @example test/succfail.p
  * @example test/testif.p
  * @example test/test.p
  * @example test/typefail.p
+ * @example test/typedconst.p
  * @example test/typetest.p
+ * @example test/uninit.p
  * @example test/unknown.p
+ * @example test/variant.p
+ * @example test/variantfail.p
  * @example test/varparam.p
  * eexample test/while.p
+ * @example test/with.p
+ * @example test2/debug.p
  * @example test2/get.p
+ * @example test2/repl.p
  ************************************************************************************************/
 
+#include "assembler.h"
+#include "codereport.h"
 #include "comp.h"
+#include "debugger.h"
+#include "image.h"
 #include "interp.h"
+#include "lanes.h"
+#include "lockstep.h"
+#include "repl.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <sstream>
+#include <tuple>
 #include <vector>
 
 using namespace std;
@@ -52,6 +93,27 @@ static 	string	inputFile {"-"};				///< Source file name, or - for standard inpu
 static  bool	listing = false;				///< Generate listing if true
 static 	bool	verbose = false;				///< Verbose messages if true
 static	bool	trace = false;					///< Trace run if true
+static	bool	profile = false;				///< Profile run if true
+static	unsigned profileHz = 100;				///< Profile sampling rate
+static	bool	heapProfile = false;			///< Heap allocation-site profile if true
+static	bool	ngramProfile = false;			///< Opcode n-gram profile if true
+static	string	ngramFile;						///< Merge the n-gram profile into this file, if any
+static	string	metricsFile;					///< Publish live metrics to this file, if any
+static	unsigned metricsPeriod = 1;				///< Seconds between metrics snapshots
+static	unsigned heapSize = 3*1024;				///< Heap (free store) size, in Datums
+static	bool	hugePages = false;				///< Use huge pages for the data segment if true
+static	unsigned benchRuns = 0;					///< Benchmark run count, or 0 to just run
+static	string	batchFile;						///< Run once per record (line) of this file, if any
+static	unsigned laneCount = 1;					///< Run this many batch records at a time, in lockstep
+static	bool	lockstep = false;				///< Run optimized, and unoptimized, code in lockstep if true
+static	vector<string> asmFiles;				///< Assembly source files to link into the program
+static	bool	debug = false;					///< Run under the debugger if true
+static	string	debugScript {"/dev/tty"};		///< Where the debugger reads its commands
+static	bool	repl = false;					///< Run an interactive session if true
+static	bool	perfWarnings = false;			///< Write compiler performance warnings if true
+static	bool	codeReport = false;				///< Write a static code report, instead of running, if true
+static	string	snapshotFile;					///< Save a startup image, taken at ready, to this file, if any
+static	Image	image;							///< The startup image, if inputFile is one
 
 /********************************************************************************************//** 
  * Print a usage message on standard error output 
@@ -60,19 +122,78 @@ static void help() {
 	cerr << "Usage: " << progName << ": [options[ [filename]\n"
 		 << "Where options is zero or more of the following:\n"
 		 << "-? | --help    Print this message and exit.\n"
+		 << "-d | --debug   Run under the breakpoint debugger, reading commands from the terminal.\n"
+		 << "--debug-script=FILE\n"
+		 << "               Run under the breakpoint debugger, reading commands from FILE.\n"
 		 << "-l | --listing Generate listing.\n"
+		 << "-p | --profile Write a sampling profile on standard error at exit.\n"
+		 << "--profile-hz=N Set the profile sampling rate (default 100).\n"
+		 << "--heap-profile Write a heap allocation-site, and leak, report on standard error at exit.\n"
+		 << "--ngrams[=FILE]\n"
+		 << "               Write the most frequent opcode pairs, and triples, ranked by the cycles\n"
+		 << "               fusing them would save, on standard error at exit; merged into FILE.\n"
+		 << "--metrics=FILE Publish a snapshot of the run's progress to FILE, e.g., in /dev/shm, every\n"
+		 << "               second, and at exit.\n"
+		 << "--metrics-period=N\n"
+		 << "               Set the seconds between metrics snapshots (default 1).\n"
+		 << "--heap-size=N  Set the heap size, in Datums, with an optional K, M or G suffix (default 3K).\n"
+		 << "--huge-pages   Use huge pages for the data segment.\n"
+		 << "--bench N      Run the program N times, discarding output, and report timings.\n"
+		 << "--batch=FILE   Run the program once for each line of FILE, with the line as its input.\n"
+		 << "--lanes=N      Run N batch records at a time, in lockstep, sharing instruction dispatch.\n"
+		 << "--asm=FILE     Assemble FILE, and link its globals into the program, by name.\n"
+		 << "--repl         Start an interactive session; compile, and run, each input as it's entered.\n"
+		 << "--perf-warnings\n"
+		 << "               Warn of avoidable costs; large value parameters, new or dispose in loops,\n"
+		 << "               deep static link chains, and mixed type arithmetic in loops.\n"
+		 << "--code-report  Write each subroutine's size, instruction mix, limit checks, parameter and\n"
+		 << "               local variable sizes, and stack depth, instead of running the program.\n"
+		 << "--snapshot-at-ready=FILE\n"
+		 << "               Run the program until it executes ready, and save the machine's state as\n"
+		 << "               a startup image in FILE, instead of running it to completion.\n"
+		 << "--lockstep     Run the program, compiled with and without optimizations, in lockstep,\n"
+		 << "               reporting the first divergence.\n"
 		 << "-t | --trace   Set interpreter trace mode.\n"
 		 << "-v | --verbose Set compilier verbose mode.\n"
  		 << "-V | --version Print the program version.\n"
 		 << "\n"
-		 << "filename  The name of the source file, or '-' or '' for standard input.\n";
+		 << "filename  The name of the source file, or '-' or '' for standard input. Files ending\n"
+		 << "          in .pasm are assembled, rather than compiled. Files ending in .img are startup\n"
+		 << "          images, which continue from where the snapshot was taken.\n";
 }
 
 /********************************************************************************************//**
  * Print the version number as major.minor
  ************************************************************************************************/
 static void printVersion() {
-	cout << progName << ": verson: 0.47\n";
+	cout << progName << ": verson: 0.72\n";
+}
+
+/********************************************************************************************//** 
+ * Parse a size, with an optional K, M or G (binary) suffix, e.g., "64M"
+ *
+ * @param	str		The string to parse
+ * @param	size	The result, if successful
+ * @return	false if str isn't a valid size
+ ************************************************************************************************/
+static bool parseSize(const string& str, unsigned& size) {
+	char* end = nullptr;
+	unsigned long long n = strtoull(str.c_str(), &end, 10);
+	if (end == str.c_str())
+		return false;
+
+	switch (*end) {
+	case 'k': case 'K':	n <<= 10; ++end;	break;
+	case 'm': case 'M':	n <<= 20; ++end;	break;
+	case 'g': case 'G':	n <<= 30; ++end;	break;
+	default:								break;
+	}
+
+	if (*end != '\0' || n == 0 || n > static_cast<unsigned>(numeric_limits<int>::max()))
+		return false;
+
+	size = static_cast<unsigned>(n);
+	return true;
 }
 
 /********************************************************************************************//** 
@@ -81,7 +202,8 @@ static void printVersion() {
  * @return false if an command line syntax error is encounter, or help requested.
  ************************************************************************************************/
 static bool parseCommandline(const vector<string>& args) {
-	for (auto arg : args) {
+	for (auto it = args.begin(); it != args.end(); ++it) {
+		const string& arg = *it;
 		if (arg.empty())
 			continue;							// skip ""
 
@@ -92,10 +214,94 @@ static bool parseCommandline(const vector<string>& args) {
 			help();
 			return false;
 
+		} else if ("--debug" == arg)
+			debug = true;
+
+		else if (0 == arg.compare(0, 15, "--debug-script=")) {
+			debug = true;
+			debugScript = arg.substr(15);
+
 		} else if ("--listing" == arg)
 			listing = true;
 
-		else if ("--trace" == arg)
+		else if ("--profile" == arg)
+			profile = true;
+
+		else if ("--heap-profile" == arg)
+			heapProfile = true;
+
+		else if ("--ngrams" == arg)
+			ngramProfile = true;
+
+		else if (0 == arg.compare(0, 9, "--ngrams=")) {
+			ngramProfile = true;
+			ngramFile = arg.substr(9);
+
+		} else if (0 == arg.compare(0, 10, "--metrics="))
+			metricsFile = arg.substr(10);
+
+		else if (0 == arg.compare(0, 17, "--metrics-period=")) {
+			metricsPeriod = strtoul(arg.c_str() + 17, nullptr, 10);
+			if (metricsPeriod == 0) {
+				cerr << progName << ": metrics period must be greater than zero\n";
+				return false;
+			}
+
+		} else if (0 == arg.compare(0, 12, "--heap-size=")) {
+			if (!parseSize(arg.substr(12), heapSize)) {
+				cerr << progName << ": invalid heap size: " << arg.substr(12) << "\n";
+				return false;
+			}
+
+		} else if ("--huge-pages" == arg)
+			hugePages = true;
+
+		else if (0 == arg.compare(0, 6, "--asm="))
+			asmFiles.push_back(arg.substr(6));
+
+		else if ("--repl" == arg)
+			repl = true;
+
+		else if ("--lockstep" == arg)
+			lockstep = true;
+
+		else if ("--perf-warnings" == arg)
+			perfWarnings = true;
+
+		else if ("--code-report" == arg)
+			codeReport = true;
+
+		else if (0 == arg.compare(0, 20, "--snapshot-at-ready="))
+			snapshotFile = arg.substr(20);
+
+		else if (0 == arg.compare(0, 8, "--batch="))
+			batchFile = arg.substr(8);
+
+		else if (0 == arg.compare(0, 8, "--lanes=")) {
+			if ((laneCount = strtoul(arg.c_str() + 8, nullptr, 10)) == 0) {
+				cerr << progName << ": --lanes requires a lane count greater than zero\n";
+				return false;
+			}
+
+		}
+
+		else if ("--bench" == arg) {
+			if (++it == args.end() || (benchRuns = strtoul(it->c_str(), nullptr, 10)) == 0) {
+				cerr << progName << ": --bench requires a run count greater than zero\n";
+				return false;
+			}
+
+		}
+
+		else if (0 == arg.compare(0, 13, "--profile-hz=")) {
+			profile = true;
+			profileHz = strtoul(arg.c_str() + 13, nullptr, 10);
+			if (profileHz == 0) {
+				cerr << progName << ": profile rate must be greater than zero\n";
+				return false;
+			}
+
+		} else if ("--trace" == arg)
 			trace = true;						// Trace...
 
 		else if ("--verbose" == arg)
@@ -108,7 +314,9 @@ static bool parseCommandline(const vector<string>& args) {
 			for (unsigned n = 1; n < arg.size(); ++n)
 				switch(arg[n]) {
 				case '?':	help();				return false;
+				case 'd':	debug = true;		break;
 				case 'l':	listing = true;		break;
+				case 'p':	profile = true;		break;
 				case 't':	trace = true;		break;
 				case 'v':	verbose = true;		break;
 				case 'V':	printVersion();		break;
@@ -127,6 +335,346 @@ static bool parseCommandline(const vector<string>& args) {
 	return true;
 }
 
+/********************************************************************************************//** 
+ * Run a compiled program benchRuns times, with standard output discarded, and report the
+ * minimum, median and maximum run times, cycles, and nanoseconds per instruction.
+ *
+ * @note	The program is loaded once, and standard input read once; each run restarts the
+ *			machine, or resumes the startup image, and reads its own copy of the input, so every
+ *			run does the same work. Runs whose cycle counts differ fail the benchmark.
+ *
+ * @param	machine	The machine to run on
+ * @param	program	The program
+ * @return	The number of errors
+ ************************************************************************************************/
+static unsigned bench(PInterp& machine, ProgramPtr program) {
+	typedef chrono::steady_clock Clock;
+
+	string input;
+	const ProgramPtr prog = image.program != nullptr ? image.program : program;
+	const auto reads = [](const Instr& i) { return i.op == OpCode::GET || i.op == OpCode::GETLN; };
+	if (any_of(prog->code().begin(), prog->code().end(), reads))
+		input.assign(istreambuf_iterator<char>(cin), istreambuf_iterator<char>());
+
+	if (image.program == nullptr)
+		machine.load(program, trace);
+	else if (!machine.resume(image, trace))
+		return 1;
+
+	vector<pair<double, size_t>> runs;			// Run times, in nanoseconds, and cycles
+	Result r = Result::halted;
+
+	ostringstream discard;
+	streambuf* const out = cout.rdbuf(discard.rdbuf());
+	streambuf* const in = cin.rdbuf();
+	for (unsigned n = 0; n < benchRuns && Result::halted == r; ++n) {
+		istringstream runInput(input);
+		cin.rdbuf(runInput.rdbuf());
+
+		const auto start = Clock::now();
+		if (image.program == nullptr)
+			machine.restart();
+		else
+			machine.resume(image, trace);
+		r = machine.run();
+		const auto stop = Clock::now();
+
+		runs.emplace_back(chrono::duration<double, nano>(stop - start).count(), machine.cycles());
+		discard.str("");
+	}
+	cin.rdbuf(in);
+	cout.rdbuf(out);
+
+	if (Result::halted != r) {
+		cerr << progName << ": benchmark run " << runs.size() << " failed: " << r << "\n";
+		return 1;
+	}
+
+	const size_t cycles = runs.front().second;
+	for (size_t n = 1; n < runs.size(); ++n)
+		if (runs[n].second != cycles) {
+			cerr << progName << ": benchmark run " << n + 1 << " executed " << runs[n].second
+				 << " cycles, run 1 executed " << cycles << "\n";
+			return 1;
+		}
+
+	sort(runs.begin(), runs.end());
+	const auto nsPerInstr = [](const pair<double, size_t>& run)
+		{	return run.first / max<size_t>(run.second, 1);	};
+	const auto& mid = runs[runs.size() / 2];
+	const auto& lower = runs[(runs.size() - 1) / 2];
+
+	cout << progName << ": " << inputFile << ", " << runs.size() << " runs, " << cycles << " cycles\n"
+		 << setw(16) << "ms" << setw(11) << "ns/instr" << "\n" << fixed;
+	for (auto m : {	make_tuple("min", runs.front().first, nsPerInstr(runs.front())),
+					make_tuple("median", (lower.first + mid.first) / 2, (nsPerInstr(lower) + nsPerInstr(mid)) / 2),
+					make_tuple("max", runs.back().first, nsPerInstr(runs.back())) })
+		cout << setw(6) << left << get<0>(m) << right
+			 << setw(10) << setprecision(3) << get<1>(m) / 1e6
+			 << setw(11) << setprecision(2) << get<2>(m) << "\n";
+
+	return 0;
+}
+
+/********************************************************************************************//** 
+ * Run a compiled program once for each record of batchFile, laneCount records at a time, in
+ * lockstep.
+ *
+ * @param	program	The program, which must be Lanes::supported()
+ * @param	records	The open batchFile
+ * @return	The number of records whose run failed
+ ************************************************************************************************/
+static unsigned batchLanes(ProgramPtr program, istream& records) {
+	Lanes lanes(laneCount);
+	vector<string> group;
+	unsigned nRecords = 0, nFailed = 0;
+	string record;
+
+	for (;;) {
+		group.clear();
+		while (group.size() < laneCount && getline(records, record))
+			group.push_back(record);
+		if (group.empty())
+			break;
+
+		const vector<Result> results = lanes(program, group, cout);
+		cout.flush();
+		for (const auto r : results) {
+			++nRecords;
+			if (Result::halted != r) {
+				cerr << progName << ": record " << nRecords << " failed: " << r << "\n";
+				++nFailed;
+			}
+		}
+	}
+
+	if (verbose)
+		cout << progName << ": " << nRecords << " records, " << nFailed << " failed; "
+			 << lanes.dispatched() << " instructions dispatched, for " << lanes.executed() << " executed\n";
+
+	return nFailed;
+}
+
+/********************************************************************************************//** 
+ * Run a compiled program once for each record, a line, of batchFile, with the record as the
+ * program's standard input. The program is loaded once, and the machine restarted, or the
+ * startup image resumed, for each record, so a record costs neither compilation, process
+ *  startup, nor remapping the data segment; just its run. With --lanes, programs Lanes
+ * supports are run by batchLanes() instead.
+ *
+ * @param	machine	The machine to run on
+ * @param	program	The program
+ * @return	The number of records whose run failed, or 1 if batchFile couldn't be read
+ ************************************************************************************************/
+static unsigned batch(PInterp& machine, ProgramPtr program) {
+	ifstream records(batchFile);
+	if (!records.is_open()) {
+		cerr << progName << ": unable to read " << batchFile << "\n";
+		return 1;
+	}
+
+	if (laneCount > 1) {
+		if (image.program == nullptr && !trace && !profile && !heapProfile && !ngramProfile &&
+				metricsFile.empty() && Lanes::supported(*program))
+			return batchLanes(program, records);
+
+		else if (verbose)
+			cout << progName << ": --lanes doesn't support images, tracing, profiles, metrics, or"
+				 << " new, dispose, and external subroutines; running one record at a time\n";
+	}
+
+	unsigned nRecords = 0, nFailed = 0;
+	string record;
+
+	if (image.program == nullptr)
+		machine.load(program, trace);
+	else if (!machine.resume(image, trace))
+		return 1;
+
+	streambuf* const in = cin.rdbuf();
+	while (getline(records, record)) {
+		istringstream input(record);
+		cin.rdbuf(input.rdbuf());
+		if (image.program == nullptr)
+			machine.restart();
+		else
+			machine.resume(image, trace);
+		const Result r = machine.run();
+		cin.rdbuf(in);
+
+		++nRecords;
+		if (Result::halted != r) {
+			cerr << progName << ": record " << nRecords << " failed: " << r << "\n";
+			++nFailed;
+		}
+	}
+
+	if (verbose)
+		cout << progName << ": " << nRecords << " records, " << nFailed << " failed\n";
+
+	return nFailed;
+}
+
+/********************************************************************************************//** 
+ * Run a compiled program until it executes ready, and save the machine's state, as a startup
+ * image, in snapshotFile. A startup image is resumed, and run until it executes ready again.
+ *
+ * @param	machine	The machine to run on
+ * @param	program	The program
+ * @param	index	Source line numbers, indexed by instruction address
+ * @param	subrs	The program's subroutine names, by entry point
+ * @return	The number of errors
+ ************************************************************************************************/
+static unsigned snapshot(	PInterp&				machine,
+							ProgramPtr				program,
+					const	vector<unsigned>&		index,
+					const	SubrMap&				subrs)
+{
+	if (image.program == nullptr)
+		machine.load(program, trace);
+	else if (!machine.resume(image, trace))
+		return 1;
+
+	machine.stopAtReady(true);
+	const Result r = machine.run();
+	machine.stopAtReady(false);
+
+	if (Result::ready != r) {
+		if (Result::halted == r)
+			cerr << progName << ": " << inputFile << " halted without executing ready\n";
+		return 1;
+	}
+
+	Image snap;
+	machine.snapshot(snap);
+	snap.subrs = subrs;
+	snap.index = index;
+	if (!snap.save(snapshotFile)) {
+		cerr << progName << ": unable to write " << snapshotFile << "\n";
+		return 1;
+	}
+
+	if (verbose)
+		cout << progName << ": saved " << snapshotFile << " after " << machine.cycles() << " cycles\n";
+
+	return 0;
+}
+
+/********************************************************************************************//** 
+ * Assemble, and link, each of the asmFiles into a program
+ *
+ * @param	code	The program
+ * @param	subrs	The program's subroutine names, by entry point
+ * @param	list	Write a listing of the linked code if true
+ * @return	The number of errors
+ ************************************************************************************************/
+static unsigned linkAsm(InstrVector& code, SubrMap& subrs, bool list) {
+	unsigned nErrors = 0;
+
+	for (const auto& file : asmFiles) {
+		Assembler assembler;
+		const size_t base = code.size();
+		if (0 == (nErrors += assembler(file)))
+			nErrors += assembler.link(code, subrs);
+
+		if (list && 0 == nErrors) {
+			cout << "# " << file << "\n";
+			for (size_t loc = base; loc < code.size(); ++loc)
+				disasm(cout, loc, code[loc]);
+
+			for (size_t loc = 0; loc < base; ++loc)	// and the patched entry points
+				if (code[loc].op == OpCode::JUMPI && code[loc].value.natural() >= base)
+					disasm(cout, loc, code[loc], subrs[code[loc].value.natural()]);
+			cout << "\n";
+		}
+	}
+
+	return nErrors;
+}
+
+/********************************************************************************************//** 
+ * Compile, or assemble, the source, and link in the asmFiles, or load the startup image
+ *
+ * @param		comp	The compiler
+ * @param[out]	code	The program
+ * @param[out]	consts	The program's constant segment
+ * @param[out]	subrs	The program's subroutine names, by entry point
+ * @param		list	Write a listing if true
+ * @return	The number of errors
+ ************************************************************************************************/
+static unsigned build(PComp& comp, InstrVector& code, DatumVector& consts, SubrMap& subrs, bool list) {
+	const string suffix = ".pasm", imgSuffix = ".img";
+	unsigned nErrors = 0;
+
+	if (inputFile.size() > imgSuffix.size() && 0 == inputFile.compare(inputFile.size() - imgSuffix.size(), imgSuffix.size(), imgSuffix)) {
+		string error;
+		if (!image.load(inputFile, error)) {
+			if (error.empty())
+				cerr << progName << ": " << inputFile << " isn't a P machine image\n";
+			else
+				cerr << progName << ": " << inputFile << ": " << error << "\n";
+			image = Image();
+			nErrors = 1;
+
+		} else {								// Already linked
+			code = image.program->code();
+			consts = image.program->consts();
+			subrs = image.subrs;
+		}
+
+	} else if (inputFile.size() > suffix.size() && 0 == inputFile.compare(inputFile.size() - suffix.size(), suffix.size(), suffix)) {
+		const auto files = asmFiles;
+		asmFiles.insert(asmFiles.begin(), inputFile);	// The program starts at its first instruction
+		nErrors = linkAsm(code, subrs, list);
+		asmFiles = files;
+
+	} else {
+		comp.wholeProgram(asmFiles.empty());	// Assembler routines may call compiled ones
+		if (0 == (nErrors = comp(inputFile, code, consts, list, verbose))) {
+			subrs = comp.subroutines();
+			nErrors = linkAsm(code, subrs, list);
+		}
+	}
+
+	return nErrors;
+}
+
+/********************************************************************************************//** 
+ * Recompile the source without optimizations, and run both it, and the optimized program, in
+ * lockstep, reporting the first divergence on standard output. Standard input, if the program
+ * reads any, is read up front and given to both.
+ *
+ * @param	program	The optimized program
+ * @param	subrs	The optimized program's subroutine names
+ * @return	The number of errors
+ ************************************************************************************************/
+static unsigned runLockstep(ProgramPtr program, const SubrMap& subrs) {
+	if (inputFile == "-") {
+		cerr << progName << ": --lockstep needs to read the source twice, and can't use standard input\n";
+		return 1;
+	}
+
+	PComp		comp;
+	InstrVector	refCode;
+	DatumVector	refConsts;
+	SubrMap		refSubrs;
+	comp.optimize(false);
+	if (0 != build(comp, refCode, refConsts, refSubrs, false))
+		return 1;
+
+	string input;
+	const auto reads = [](const Instr& i) { return i.op == OpCode::GET || i.op == OpCode::GETLN; };
+	if (any_of(program->code().begin(), program->code().end(), reads))
+		input.assign(istreambuf_iterator<char>(cin), istreambuf_iterator<char>());
+
+	PInterp reference(1024, heapSize, hugePages), candidate(1024, heapSize, hugePages);
+	Lockstep harness(	{ "reference", reference, Program::make(refCode, refConsts), refSubrs },
+						{ "optimized", candidate, program, subrs },
+						input);
+
+	return harness(cout) ? 0 : 1;
+}
+
 /********************************************************************************************//** 
  * 'P' compiler and interpreter
  *
@@ -138,8 +686,9 @@ static bool parseCommandline(const vector<string>& args) {
  ************************************************************************************************/
 int main(int argc, char* argv[]) {
 	PComp		comp;							// The compiler...
-	PInterp 	machine;						// The machine...
 	InstrVector	code;							// Machine instructions...
+	DatumVector	consts;							// Constant segment...
+	SubrMap		subrs;							// Subroutine names...
 	unsigned 	nErrors = 0;
 
 	progName = argv[0];
@@ -148,10 +697,30 @@ int main(int argc, char* argv[]) {
 	for (int argn = 1; argn < argc; ++argn)
 		args.push_back(argv[argn]);
 
-	if (!parseCommandline(args))
+	const bool parsed = parseCommandline(args);
+	comp.perfWarnings(perfWarnings);
+
+	if (!parsed)
 		++nErrors;
+
+	else if (repl) {
+		Repl session(heapSize, hugePages);
+		nErrors = session(cin, cout);
+	}
 												// Compile the source, run if no errors
-	else if (0 == (nErrors = comp(inputFile, code, listing, verbose))) {
+	else if (0 == (nErrors = build(comp, code, consts, subrs, listing)) && codeReport)
+		CodeReport(code, subrs).report(cout, inputFile);
+
+	else if (0 == nErrors && image.program != nullptr && (lockstep || debug)) {
+		cerr << progName << ": --lockstep, and --debug, run the program from its start, not an image\n";
+		nErrors = 1;
+
+	} else if (0 == nErrors && lockstep)
+		nErrors = runLockstep(Program::make(code, consts), subrs);
+
+	else if (0 == nErrors) {
+		const ProgramPtr program = Program::make(move(code), move(consts));
+
 		if (verbose) {
 			if (inputFile == "-")
 				cout << progName << ": loading program from standard input, and starting P...\n";
@@ -159,10 +728,87 @@ int main(int argc, char* argv[]) {
 				cout << progName << ": loading program '" << inputFile << "', and starting P...\n";
 		}
 
-		const Result r = machine(code, trace);
+		PInterp machine(1024, heapSize, hugePages);	// The machine...
+		const vector<unsigned>& index = image.program != nullptr ? image.index : comp.sourceIndex();
+
+		Profiler profiler(index, subrs, profileHz);
+		if (profile) {
+			if (profiler.start())
+				machine.profile(&profiler);
+			else
+				cerr << progName << ": unable to start the profiler!\n";
+		}
+
+		HeapProfiler heapProfiler(index, subrs);
+		if (heapProfile)
+			machine.heapProfile(&heapProfiler);
+
+		NgramProfiler ngramProfiler;
+		if (ngramProfile) {
+			if (!ngramFile.empty() && !ngramProfiler.load(ngramFile))
+				cerr << progName << ": " << ngramFile << " isn't an n-gram profile, ignored!\n";
+			machine.ngramProfile(&ngramProfiler);
+		}
+
+		Metrics metrics(metricsFile, index, subrs, metricsPeriod);
+		if (!metricsFile.empty()) {
+			if (metrics.start())
+				machine.metrics(&metrics);
+			else
+				cerr << progName << ": unable to start publishing metrics!\n";
+		}
+
+		ifstream commands;						// Apart from the program's standard input
+		if (debug) {
+			commands.open(debugScript);
+			if (!commands.is_open())
+				cerr << progName << ": unable to read debugger commands from " << debugScript << "\n";
+		}
+		Debugger debugger(machine, index, subrs, commands);
+
+		Result r = Result::success;
+		if (!snapshotFile.empty())
+			nErrors = snapshot(machine, program, index, subrs);
+		else if (benchRuns > 0)
+			nErrors = bench(machine, program);
+		else if (!batchFile.empty())
+			nErrors = batch(machine, program);
+		else if (debug && !commands.is_open())
+			nErrors = 1;
+		else if (debug)
+			r = debugger(program);
+		else if (image.program != nullptr)
+			r = machine(image, trace);
+		else
+			r = machine(program, trace);
 		if (Result::success != r)
 			nErrors = static_cast<int> (r);		// Return error code 
 
+		if (!metricsFile.empty()) {
+			metrics.stop();
+			ostringstream state;				// Batch failures are counted, not returned
+			if (Result::success != r)
+				state << r;
+			else
+				state << (nErrors == 0 ? "halted" : "failed");
+			if (!machine.publish(state.str()))
+				cerr << progName << ": unable to write " << metricsFile << "!\n";
+		}
+
+		if (profile) {
+			profiler.stop();
+			profiler.report(cerr, inputFile);
+		}
+
+		if (heapProfile)
+			heapProfiler.report(cerr, inputFile);
+
+		if (ngramProfile) {
+			ngramProfiler.report(cerr);
+			if (!ngramFile.empty() && !ngramProfiler.save(ngramFile))
+				cerr << progName << ": unable to write " << ngramFile << "!\n";
+		}
+
 		if (verbose) cout << progName << ": Ending P after " << machine.cycles() << " machine cycles\n";
 	}
 
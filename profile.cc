@@ -0,0 +1,462 @@
+/********************************************************************************************//**
+ * @file profile.cc
+ *
+ * Sampling, heap allocation-site and opcode n-gram profilers for the P machine.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include <sys/time.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#include "profile.h"
+
+using namespace std;
+
+/********************************************************************************************//**
+ * class CodeIndex
+ ************************************************************************************************/
+
+/********************************************************************************************//**
+ * @param	addr	An instruction address
+ * @return	The source line number of addr, or zero if addr is out of range
+ ************************************************************************************************/
+unsigned CodeIndex::line(size_t addr) const {
+	return addr < index.size() ? index[addr] : 0;
+}
+
+/********************************************************************************************//**
+ * @param	addr	An instruction address
+ * @return	The subroutine containing addr, or end() if addr precedes all subroutines
+ ************************************************************************************************/
+SubrMap::const_iterator CodeIndex::subroutine(size_t addr) const {
+	auto it = subrs.upper_bound(addr);
+	return it == subrs.begin() ? subrs.end() : --it;
+}
+
+/********************************************************************************************//**
+ * @param	addr	An instruction address
+ * @return	The name of the subroutine containing addr, or "?" if addr precedes all subroutines
+ ************************************************************************************************/
+string CodeIndex::name(size_t addr) const {
+	auto it = subroutine(addr);
+	return it == subrs.end() ? "?" : it->second;
+}
+
+/********************************************************************************************//**
+ * Return the lines of the source file, if it can be read.
+ *
+ * @param	source	The source file name, or "-" for the standard input
+ * @return	The source lines
+ ************************************************************************************************/
+static vector<string> sourceText(const string& source) {
+	vector<string> text;
+	if (source != "-") {
+		ifstream ifile(source);
+		string line;
+		while (getline(ifile, line))
+			text.push_back(line);
+	}
+
+	return text;
+}
+
+/********************************************************************************************//**
+ * class Profiler
+ ************************************************************************************************/
+
+// private static
+
+volatile sig_atomic_t Profiler::pending = 0;
+
+/********************************************************************************************//**
+ * Just note that a sample is due; the interpreter takes it between instructions.
+ ************************************************************************************************/
+void Profiler::handler(int)							{	pending = 1;	}
+
+// public
+
+/********************************************************************************************//**
+ * @param	index	Source line numbers, indexed by instruction address
+ * @param	subrs	Subroutine names, by entry point
+ * @param	hz		Sampling rate, in samples per second
+ ************************************************************************************************/
+Profiler::Profiler(const vector<unsigned>& index, const SubrMap& subrs, unsigned hz)
+	: code{index, subrs}, hz{hz}, nsamples{0}, self(index.size(), 0)
+{
+	oldAction.sa_handler = SIG_DFL;
+	sigemptyset(&oldAction.sa_mask);
+	oldAction.sa_flags = 0;
+}
+
+/********************************************************************************************//**
+ * Stops the interval timer, if running
+ ************************************************************************************************/
+Profiler::~Profiler()								{	stop();			}
+
+/********************************************************************************************//**
+ * @return	false if the signal handler, or the interval timer, couldn't be set
+ ************************************************************************************************/
+bool Profiler::start() {
+	struct sigaction action;
+	action.sa_handler = handler;
+	sigemptyset(&action.sa_mask);
+	action.sa_flags = SA_RESTART;
+	if (sigaction(SIGPROF, &action, &oldAction) != 0)
+		return false;
+
+	const long usecs = 1000000L / (hz > 0 ? hz : 1);
+
+	struct itimerval timer;
+	timer.it_interval.tv_sec = usecs / 1000000L;
+	timer.it_interval.tv_usec = usecs % 1000000L;
+	timer.it_value = timer.it_interval;
+	pending = 0;
+
+	return setitimer(ITIMER_PROF, &timer, nullptr) == 0;
+}
+
+/********************************************************************************************//**
+ ************************************************************************************************/
+void Profiler::stop() {
+	struct itimerval timer = {};
+	setitimer(ITIMER_PROF, &timer, nullptr);
+	sigaction(SIGPROF, &oldAction, nullptr);
+	pending = 0;
+}
+
+/********************************************************************************************//**
+ * @param	pc		The current instruction address
+ * @param	returns	The return addresses, from the current activation frame up
+ ************************************************************************************************/
+void Profiler::sample(size_t pc, const vector<size_t>& returns) {
+	pending = 0;
+	++nsamples;
+
+	if (pc < self.size())
+		++self[pc];
+
+	vector<size_t> seen;					// count recursive subroutines just once
+	auto note = [&](size_t addr) {
+		auto it = code.subroutine(addr);
+		if (it != code.end() && find(seen.begin(), seen.end(), it->first) == seen.end()) {
+			seen.push_back(it->first);
+			++total[it->first];
+		}
+	};
+
+	note(pc);
+	for (auto addr : returns)
+		note(addr - 1);						// the call instruction
+}
+
+/********************************************************************************************//**
+ * Write subroutines, in decreasing total samples, and source lines, in line order, with non-zero
+ * sample counts.
+ *
+ * @param	out		Where to write the report
+ * @param	source	The source file name, or "-" for the standard input
+ ************************************************************************************************/
+void Profiler::report(ostream& out, const string& source) const {
+	const double pct = nsamples > 0 ? 100.0 / nsamples : 0.0;
+
+	out << "# profile: " << nsamples << " samples at " << hz << " Hz\n"
+		<< "#\n"
+		<< "#  total%   self%  subroutine\n";
+
+	map<size_t, unsigned> selfBySubr;		// self samples, by subroutine entry point
+	LineCounts lines;						// self samples, by source line
+	for (size_t addr = 0; addr < self.size(); ++addr) {
+		if (self[addr] == 0)
+			continue;
+
+		auto it = code.subroutine(addr);
+		if (it != code.end())
+			selfBySubr[it->first] += self[addr];
+		lines[code.line(addr)] += self[addr];
+	}
+
+	vector<pair<size_t, unsigned>> byTotal(total.begin(), total.end());
+	stable_sort(byTotal.begin(), byTotal.end(),
+		[](const pair<size_t, unsigned>& lhs, const pair<size_t, unsigned>& rhs) {
+			return lhs.second > rhs.second;
+		});
+
+	out << fixed << setprecision(1);
+	for (const auto& subr : byTotal) {
+		auto it = selfBySubr.find(subr.first);
+		const unsigned n = it == selfBySubr.end() ? 0 : it->second;
+		out << setw(9) << subr.second * pct << setw(8) << n * pct << "  " << code.name(subr.first) << "\n";
+	}
+
+	const vector<string> text = sourceText(source);
+
+	out << "#\n"
+		<< "#   line  samples   self%  source\n";
+	for (const auto& line : lines) {
+		out << setw(8) << line.first << setw(9) << line.second << setw(8) << line.second * pct;
+		if (line.first > 0 && line.first <= text.size())
+			out << "  " << text[line.first - 1];
+		out << "\n";
+	}
+}
+
+/********************************************************************************************//**
+ * class HeapProfiler
+ ************************************************************************************************/
+
+/********************************************************************************************//**
+ * @param	index	Source line numbers, indexed by instruction address
+ * @param	subrs	Subroutine names, by entry point
+ ************************************************************************************************/
+HeapProfiler::HeapProfiler(const vector<unsigned>& index, const SubrMap& subrs)
+	: code{index, subrs}, live{0}, peak{0}
+{
+}
+
+/********************************************************************************************//**
+ * @param	addr	Address of the allocated block
+ * @param	size	Size of the block, in Datums
+ * @param	pc		Address of the allocating instruction
+ ************************************************************************************************/
+void HeapProfiler::alloc(size_t addr, size_t size, size_t pc) {
+	Site& site = sites[pc];
+	++site.allocs;
+	site.total += size;
+	site.live += size;
+	site.peak = max(site.peak, site.live);
+
+	live += size;
+	peak = max(peak, live);
+
+	blocks[addr] = { size, pc };
+}
+
+/********************************************************************************************//**
+ * @param	addr	Address of the disposed block
+ ************************************************************************************************/
+void HeapProfiler::free(size_t addr) {
+	auto it = blocks.find(addr);
+	if (it != blocks.end()) {
+		Site& site = sites[it->second.pc];
+		++site.frees;
+		site.live -= it->second.size;
+		live -= it->second.size;
+		blocks.erase(it);
+	}
+}
+
+/********************************************************************************************//**
+ * @param	out		Where to write the report
+ * @param	source	The source file name, or "-" for the standard input
+ ************************************************************************************************/
+void HeapProfiler::report(ostream& out, const string& source) const {
+	const vector<string> text = sourceText(source);
+	auto where = [&](size_t pc) {
+		const unsigned ln = code.line(pc);
+		out << setw(6) << pc << setw(6) << ln << "  " << code.name(pc);
+		if (ln > 0 && ln <= text.size())
+			out << ": " << text[ln - 1];
+		out << "\n";
+	};
+
+	out << "# heap profile: " << sites.size() << " allocation sites, peak " << peak
+		<< " Datums, " << live << " Datums in " << blocks.size() << " blocks never disposed\n"
+		<< "#\n"
+		<< "#   allocs    frees    total     live     peak      pc  line  subroutine: source\n";
+
+	vector<pair<size_t, Site>> byTotal(sites.begin(), sites.end());
+	stable_sort(byTotal.begin(), byTotal.end(),
+		[](const pair<size_t, Site>& lhs, const pair<size_t, Site>& rhs) {
+			return lhs.second.total > rhs.second.total;
+		});
+
+	for (const auto& site : byTotal) {
+		const Site& s = site.second;
+		out << setw(10) << s.allocs << setw(9) << s.frees << setw(9) << s.total << setw(9) << s.live
+			<< setw(9) << s.peak << "  ";
+		where(site.first);
+	}
+
+	if (!blocks.empty()) {
+		out << "#\n"
+			<< "# never disposed:\n"
+			<< "#     addr     size      pc  line  subroutine: source\n";
+		for (const auto& block : blocks) {
+			out << setw(10) << block.first << setw(9) << block.second.size << "  ";
+			where(block.second.pc);
+		}
+	}
+}
+
+/********************************************************************************************//**
+ * class NgramProfiler
+ ************************************************************************************************/
+
+// private static
+
+/********************************************************************************************//**
+ * @param	key	A pattern of n instructions, 16 bits each, the first in the most significant
+ * @param	n	The number of instructions in key
+ * @return	key as text, e.g., "push 1; add"
+ ************************************************************************************************/
+string NgramProfiler::text(uint64_t key, unsigned n) {
+	ostringstream oss;
+	while (n-- > 0) {
+		const unsigned pattern = (key >> (16 * n)) & 0xffff;
+		oss << OpCodeInfo::info(static_cast<OpCode>(pattern >> 8)).name();
+		if ((pattern & 0xff) != 0)
+			oss << " " << static_cast<int>(pattern & 0xff) - 128;
+		if (n > 0)
+			oss << "; ";
+	}
+
+	return oss.str();
+}
+
+// private
+
+/********************************************************************************************//**
+ * @return	The counts merged by load(), plus those of this run
+ ************************************************************************************************/
+NgramProfiler::Counts NgramProfiler::totals() const {
+	Counts counts = merged;
+	for (const auto& gram : pairs)
+		counts[text(gram.first, 2)] += gram.second;
+	for (const auto& gram : triples)
+		counts[text(gram.first, 3)] += gram.second;
+
+	return counts;
+}
+
+// public
+
+/********************************************************************************************//**
+ * Construct an empty profile
+ ************************************************************************************************/
+NgramProfiler::NgramProfiler()
+	: runs{0}, ncycles{0}, depth{0}, next{numeric_limits<size_t>::max()}
+{
+	last[0] = last[1] = 0;
+}
+
+/********************************************************************************************//**
+ * @param	pc		The instruction's address
+ * @param	instr	The instruction
+ ************************************************************************************************/
+void NgramProfiler::note(size_t pc, const Instr& instr) {
+	uint64_t pattern = ordinal(instr.op) << 8;
+	if (instr.op == OpCode::PUSH && instr.value.kind() == Datum::Integer &&
+		instr.value.integer() > -128 && instr.value.integer() < 128)
+		pattern |= instr.value.integer() + 128;		// 1..255; 0 is no operand
+
+	if (pc != next)							// A control transfer; start a new sequence
+		depth = 0;
+
+	if (depth > 0)
+		++pairs[last[0] << 16 | pattern];
+	if (depth > 1)
+		++triples[last[1] << 32 | last[0] << 16 | pattern];
+
+	last[1] = last[0];
+	last[0] = pattern;
+	if (depth < 2)
+		++depth;
+
+	next = pc + 1;
+	++ncycles;
+}
+
+/********************************************************************************************//**
+ * A missing file isn't an error; there just aren't any previous runs.
+ *
+ * @param	fName	The file name
+ * @return	false if fName exists, but isn't an n-gram profile
+ ************************************************************************************************/
+bool NgramProfiler::load(const string& fName) {
+	ifstream ifile(fName);
+	string line;
+
+	while (getline(ifile, line)) {
+		unsigned n = 0;
+		unsigned long long cycles = 0;
+
+		if (line.empty())
+			continue;
+
+		else if (line[0] == '#') {
+			if (sscanf(line.c_str(), "# ngram profile: %u runs, %llu cycles", &n, &cycles) == 2) {
+				runs += n;
+				ncycles += cycles;
+			}
+
+		} else {
+			const size_t tab = line.find('\t');
+			if (tab == string::npos || tab == 0)
+				return false;
+
+			merged[line.substr(tab + 1)] += strtoull(line.c_str(), nullptr, 10);
+		}
+	}
+
+	return true;
+}
+
+/********************************************************************************************//**
+ * @param	fName	The file name
+ * @return	false if fName couldn't be written
+ ************************************************************************************************/
+bool NgramProfiler::save(const string& fName) const {
+	ofstream ofile(fName);
+
+	ofile << "# ngram profile: " << runs + 1 << " runs, " << ncycles << " cycles\n";
+	for (const auto& gram : totals())
+		ofile << gram.second << "\t" << gram.first << "\n";
+
+	return ofile.good();
+}
+
+/********************************************************************************************//**
+ * Write the n-grams in decreasing order of cycles saved if each was fused into a single
+ * instruction. Pairs, and triples, overlap, so the savings aren't additive.
+ *
+ * @param	out		Where to write the report
+ * @param	top		The number of n-grams to write
+ ************************************************************************************************/
+void NgramProfiler::report(ostream& out, unsigned top) const {
+	struct Gram {
+		uint64_t	saved;					///< Cycles saved by fusing
+		uint64_t	count;					///< Number of executions
+		string		pattern;				///< The pattern, as text
+	};
+
+	vector<Gram> grams;
+	for (const auto& gram : totals()) {
+		const uint64_t n = count(gram.first.begin(), gram.first.end(), ';') + 1;
+		grams.push_back({ gram.second * (n - 1), gram.second, gram.first });
+	}
+
+	stable_sort(grams.begin(), grams.end(),
+		[](const Gram& lhs, const Gram& rhs) {
+			return lhs.saved > rhs.saved;
+		});
+
+	const double pct = ncycles > 0 ? 100.0 / ncycles : 0.0;
+
+	out << "# ngram profile: " << runs + 1 << " runs, " << ncycles << " cycles\n"
+		<< "#\n"
+		<< "#      saved  cycles%       count  n-gram\n";
+
+	out << fixed << setprecision(1);
+	for (size_t i = 0; i < grams.size() && i < top; ++i)
+		out << setw(12) << grams[i].saved << setw(9) << grams[i].saved * pct
+			<< setw(12) << grams[i].count << "  " << grams[i].pattern << "\n";
+}
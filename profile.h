@@ -0,0 +1,200 @@
+/********************************************************************************************//**
+ * @file profile.h
+ *
+ * Sampling, heap allocation-site and opcode n-gram profilers for the P machine.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	PROFILE_H
+#define PROFILE_H
+
+#include <signal.h>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "instr.h"
+
+/********************************************************************************************//**
+ * A Code Index
+ *
+ * Maps instruction addresses to source lines, via the compiler's cross-index, and subroutines,
+ * via the subroutine entry points.
+ ************************************************************************************************/
+class CodeIndex {
+public:
+	/// Construct a code index from the compiler's cross-index and subroutine entry points
+	CodeIndex(const std::vector<unsigned>& index, const SubrMap& subrs)
+		: index{index}, subrs{subrs} {}
+	virtual ~CodeIndex() {}
+
+	/// Return the source line of the instruction at addr, or 0 if unknown
+	unsigned line(size_t addr) const;
+
+	/// Return the subroutine containing addr...
+	SubrMap::const_iterator subroutine(size_t addr) const;
+
+	/// Return the name of the subroutine containing addr...
+	std::string name(size_t addr) const;
+
+	/// Return subroutine(addr) value if addr preceeds all subroutines
+	SubrMap::const_iterator end() const		{	return subrs.end();	}
+
+	/// Return the number of instructions
+	size_t size() const						{	return index.size();	}
+
+private:
+	std::vector<unsigned>	index;			///< Source line numbers, by instruction address
+	SubrMap					subrs;			///< Subroutine names, by entry point
+};
+
+/********************************************************************************************//**
+ * A Sampling Profiler
+ *
+ * A POSIX interval timer (ITIMER_PROF) raises SIGPROF at the sampling rate; the handler just
+ * notes that a sample is due. The interpreter checks due() between instructions, and if set,
+ * passes the current pc, and the return addresses found by walking the activation frames, to
+ * sample().
+ *
+ * Samples are counted by instruction address, and later aggregated into source lines, via the
+ * compiler's cross-index, and subroutines, via the subroutine entry points. Self samples are
+ * those where the pc is in the subroutine, total samples are those where the subroutine is
+ * anywhere on the call stack.
+ ************************************************************************************************/
+class Profiler {
+public:
+	/// Construct a profiler for a program...
+	Profiler(	const	std::vector<unsigned>&	index,
+				const	SubrMap&				subrs,
+						unsigned				hz = 100);
+	virtual ~Profiler();
+
+	bool start();							///< Start the interval timer...
+	void stop();							///< Stop the interval timer
+
+	/// Is a sample due?
+	static bool due()						{	return pending != 0;	}
+
+	/// Take a sample; pc, and the return addresses from the current activation frame up
+	void sample(size_t pc, const std::vector<size_t>& returns);
+
+	/// Write a report...
+	void report(std::ostream& out, const std::string& source) const;
+
+private:
+	static volatile sig_atomic_t pending;	///< Set by handler(), cleared by sample()
+	static void handler(int);				///< SIGPROF handler
+
+	/// Per source line sample counts
+	typedef std::map<unsigned, unsigned> LineCounts;
+
+	CodeIndex				code;			///< Source lines and subroutines by address
+	unsigned				hz;				///< Sampling rate, in samples per second
+	unsigned				nsamples;		///< Total number of samples taken
+	std::vector<unsigned>	self;			///< Samples by instruction address
+	std::map<size_t, unsigned>	total;		///< Samples on the call stack by subroutine entry point
+	struct sigaction		oldAction;		///< The previous SIGPROF action
+};
+
+/********************************************************************************************//**
+ * A Heap Allocation-site Profiler
+ *
+ * The interpreter passes each successful NEW, along with the allocating instruction address, to
+ * alloc(), and each DISPOSE to free(). Allocations are tracked by site; the number of
+ * allocations, the total, and the live (not yet disposed), sizes. The report lists the sites, in
+ * decreasing order of Datums allocated, followed by the blocks that were never disposed.
+ *
+ * @note	Sizes are in Datums, the unit of P machine memory.
+ ************************************************************************************************/
+class HeapProfiler {
+public:
+	/// Construct a heap profiler for a program...
+	HeapProfiler(const std::vector<unsigned>& index, const SubrMap& subrs);
+	virtual ~HeapProfiler() {}
+
+	void alloc(size_t addr, size_t size, size_t pc);	///< Note an allocation
+	void free(size_t addr);					///< Note a disposal
+
+	/// Write a report...
+	void report(std::ostream& out, const std::string& source) const;
+
+private:
+	/// Statistics for a single allocation-site
+	struct Site {
+		size_t		allocs;					///< Number of allocations
+		size_t		frees;					///< Number of those allocations that were disposed
+		size_t		total;					///< Total Datums allocated
+		size_t		live;					///< Datums allocated, but not yet disposed
+		size_t		peak;					///< Largest value of live
+
+		Site() : allocs{0}, frees{0}, total{0}, live{0}, peak{0} {}
+	};
+
+	/// A live block; it's size and the allocating site
+	struct Block {
+		size_t		size;					///< Size of the block in Datums
+		size_t		pc;						///< Allocating instruction address
+	};
+
+	CodeIndex					code;		///< Source lines and subroutines by address
+	std::map<size_t, Site>		sites;		///< Allocation-sites, by instruction address
+	std::map<size_t, Block>		blocks;		///< Live blocks, by address
+	size_t						live;		///< Total live Datums
+	size_t						peak;		///< Largest value of live
+};
+
+/********************************************************************************************//**
+ * An Opcode N-gram Profiler
+ *
+ * The interpreter passes each instruction, along with its address, to note() before executing
+ * it. Pairs, and triples, of consecutive instructions are counted by pattern; the opcode, plus
+ * the operand of a PUSH of a small integer, e.g., "push 1; add". A sequence is broken by a
+ * control transfer, so only straight line sequences, those that could be fused into a single
+ * instruction, are counted.
+ *
+ * Counts may be merged with those of previous runs, kept in a file; one n-gram per line,
+ * "count<tab>pattern". The report ranks the n-grams by the cycles that fusing them would save;
+ * one dispatch for each instruction but the first, of each execution.
+ ************************************************************************************************/
+class NgramProfiler {
+public:
+	NgramProfiler();
+	virtual ~NgramProfiler() {}
+
+	void note(size_t pc, const Instr& instr);	///< Note the execution of an instruction
+
+	/// Merge the counts from a previous runs file...
+	bool load(const std::string& fName);
+
+	/// Write the merged counts...
+	bool save(const std::string& fName) const;
+
+	/// Write a report...
+	void report(std::ostream& out, unsigned top = 20) const;
+
+private:
+	/// N-gram counts, by pattern, as text
+	typedef std::map<std::string, uint64_t> Counts;
+
+	/// N-gram counts, by pattern; 16 bits per instruction
+	typedef std::unordered_map<uint64_t, uint64_t> Grams;
+
+	unsigned				runs;			///< Previous runs merged by load()
+	uint64_t				ncycles;		///< Instructions noted, including previous runs
+	Counts					merged;			///< Counts merged by load()
+	Grams					pairs;			///< Pair counts
+	Grams					triples;		///< Triple counts
+	uint64_t				last[2];		///< The last two patterns, most recent first
+	unsigned				depth;			///< Number of valid entries in last
+	size_t					next;			///< Address of the next instruction, in sequence
+
+	static std::string text(uint64_t key, unsigned n);	///< Return the text of a pattern
+	Counts totals() const;					///< Return the merged, and this run's, counts
+};
+
+#endif
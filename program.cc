@@ -0,0 +1,58 @@
+/********************************************************************************************//**
+ * @file program.cc
+ *
+ * class Program implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include "program.h"
+
+using namespace std;
+
+// private
+
+/********************************************************************************************//**
+ * A string is a character count, followed by the characters, in the constant segment. Strings
+ * that aren't in consts are Result::outOfRange, and those that aren't a count followed by
+ * characters Result::illegalOp; a machine reports either when it executes the instruction.
+ *
+ * @param	first	The first instruction
+ * @param	last	One past the last instruction
+ * @param	consts	The constant segment the instructions refer to
+ ************************************************************************************************/
+void Program::encode(InstrVector::const_iterator first, InstrVector::const_iterator last, const DatumVector& consts) {
+	for (; first != last; ++first) {
+		if (first->op != OpCode::PUTS && first->op != OpCode::PUTSLN)
+			continue;
+
+		size_t addr = 0;
+		try {
+			addr = first->value.natural();
+		} catch (Result) {
+			continue;							// Reported when the instruction is executed
+		}
+
+		if (literals.count(addr) != 0)
+			continue;
+
+		Literal& lit = literals[addr];
+		lit.result = Result::success;
+		try {
+			if (addr >= consts.size() || consts[addr].natural() > consts.size() - addr - 1) {
+				lit.result = Result::outOfRange;
+				continue;
+			}
+
+			const size_t n = consts[addr].natural();
+			lit.text.resize(n);
+			for (size_t i = 0; i < n; ++i)
+				lit.text[i] = consts[addr + 1 + i].character();
+
+		} catch (Result result) {
+			lit.result = result;
+			lit.text.clear();
+		}
+	}
+}
@@ -0,0 +1,87 @@
+/********************************************************************************************//**
+ * @file program.h
+ *
+ * A compiled P program, shared, read-only, by any number of P machines.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	PROGRAM_H
+#define PROGRAM_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "datum.h"
+#include "instr.h"
+#include "results.h"
+
+class Program;
+
+/// A reference counted pointer to an immutable program
+typedef std::shared_ptr<const Program> ProgramPtr;
+
+/// A reference counted pointer to a program whose code may be extended
+typedef std::shared_ptr<Program> ExtensiblePtr;
+
+/********************************************************************************************//**
+ * A Compiled Program
+ *
+ * The code segment, and the initial constant segment, of a program. Programs are immutable once
+ * made, so many PInterp instances may run the same program, without copying its code; each
+ * machine's state is limited to its registers and data segment. The exception is an
+ * extensible() program, for incremental compilers, whose owner may append code between runs.
+ *
+ * The strings written by PUTS, and PUTSLN, are encoded once, as the program is made, or code
+ * appended, rather than by each machine.
+ ************************************************************************************************/
+class Program {
+public:
+	/// A PUTSx operand's string, encoded, or why it couldn't be
+	struct Literal {
+		Result			result;				///< Result::success, or why the string is bad
+		std::string		text;				///< The encoded string
+	};
+
+	/// Make a shared program from its code, and constant segment
+	static ProgramPtr make(InstrVector code, DatumVector consts = DatumVector()) {
+		return ProgramPtr(new Program(std::move(code), std::move(consts)));
+	}
+
+	/// Make a program that may be extended by append()
+	static ExtensiblePtr extensible(InstrVector code = InstrVector(), DatumVector consts = DatumVector()) {
+		return ExtensiblePtr(new Program(std::move(code), std::move(consts)));
+	}
+
+	/// Append [first, last), whose strings are in consts, while no machine is running the program
+	void append(InstrVector::const_iterator first, InstrVector::const_iterator last, const DatumVector& consts) {
+		encode(first, last, consts);
+		instrs.insert(instrs.end(), first, last);
+	}
+
+	const InstrVector& code() const			{	return instrs;	}	///< Return the code segment
+	const DatumVector& consts() const		{	return values;	}	///< Return the constant segment
+
+	/// Return the string at addr, encoded, or nullptr if no PUTSx refers to it
+	const Literal* literal(size_t addr) const {
+		const auto it = literals.find(addr);
+		return it == literals.end() ? nullptr : &it->second;
+	}
+
+private:
+	InstrVector			instrs;				///< The code segment
+	const DatumVector	values;				///< The constant segment
+	std::unordered_map<size_t, Literal> literals;	///< PUTSx strings, encoded, by address
+
+	/// Construct a program from its code, and constant segment
+	Program(InstrVector code, DatumVector consts) : instrs(std::move(code)), values(std::move(consts)) {
+		encode(instrs.begin(), instrs.end(), values);
+	}
+
+	/// Encode the strings of the PUTSx instructions in [first, last), from consts
+	void encode(InstrVector::const_iterator first, InstrVector::const_iterator last, const DatumVector& consts);
+};
+
+#endif
@@ -0,0 +1,96 @@
+/********************************************************************************************//**
+ * @file repl.cc
+ *
+ * class Repl implementation.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#include <sstream>
+
+#include "repl.h"
+
+using namespace std;
+
+// private
+
+/********************************************************************************************//**
+ * @param	source	The input, so far
+ * @param	force	Report errors even if the input may be incomplete
+ * @param	out		Where to write errors
+ * @return	false if the input is incomplete, and should be continued
+ ************************************************************************************************/
+bool Repl::eval(const string& source, bool force, ostream& out) {
+	size_t	entry = 0;
+	bool	incomplete = false;
+
+	const int globals = comp.replFrame();		// Size of the globals before this input
+
+	ostringstream errors;						// Hold errors until we know the input is complete
+	streambuf* const err = cerr.rdbuf(errors.rdbuf());
+	const unsigned nErrors = comp.replInput(source, entry, incomplete);
+	cerr.rdbuf(err);
+
+	if (nErrors > 0) {
+		if (incomplete && !force)
+			return false;
+
+		out << errors.str();
+		++nFailed;
+		return true;
+	}
+
+	for (; loaded < consts.size(); ++loaded)	// Load new constants...
+		if (loaded >= constSize || !machine.write(loaded, consts[loaded])) {
+			out << "repl: constant segment is full\n";
+			++nFailed;
+			return true;
+		}
+
+	program->append(code.begin() + program->code().size(), code.end(), consts);	// Just this input's code
+	machine.jump(program, entry, frame, frame + FrameSize - 1 + globals);
+	if (Result::halted != machine.run())
+		++nFailed;							// run() has reported why
+
+	return true;
+}
+
+// public
+
+/********************************************************************************************//**
+ * @param	fstoreSz	Size of the free store, in Datums
+ * @param	huge		Use huge pages for the data segment if true
+ * @param	constSz		Size of the reserved constant segment, in Datums
+ ************************************************************************************************/
+Repl::Repl(unsigned fstoreSz, bool huge, size_t constSz)
+	: machine(1024, fstoreSz, huge), constSize{constSz}, loaded{0}, frame{0}, nFailed{0}
+{
+}
+
+/********************************************************************************************//**
+ * @param	in	Where to read inputs
+ * @param	out	Where to write prompts, and errors
+ * @return	The number of inputs that failed to compile, or run
+ ************************************************************************************************/
+unsigned Repl::operator()(istream& in, ostream& out) {
+	comp.replBegin(code, consts);
+	program = Program::extensible(code, DatumVector(constSize));
+	machine.load(program);
+	frame = machine.fpReg();
+
+	string source, line;
+	for (out << "p> " << flush; getline(in, line); out << (source.empty() ? "p> " : "... ") << flush) {
+		if (source.empty() && line == ":quit")
+			break;
+
+		else if (source.empty() && line.find_first_not_of(" \t") == string::npos)
+			continue;
+
+		source += line + '\n';
+		if (eval(source, line.find_first_not_of(" \t") == string::npos, out))
+			source.clear();
+	}
+
+	return nFailed;
+}
@@ -0,0 +1,57 @@
+/********************************************************************************************//**
+ * @file repl.h
+ *
+ * An interactive, read-eval-print, session with an incremental compiler and a live machine.
+ *
+ * @author Randy Merkel, Slowly but Surly Software.
+ * @copyright  (c) 2017 Slowly but Surly Software. All rights reserved.
+ ************************************************************************************************/
+
+#ifndef	REPL_H
+#define REPL_H
+
+#include <iostream>
+#include <string>
+
+#include "comp.h"
+#include "interp.h"
+
+/********************************************************************************************//**
+ * A Read-Eval-Print Loop
+ *
+ * Each input; declarations, statements, or both, as in the program block, is compiled by PComp
+ * onto the end of an append only code segment, appended to the session's extensible Program,
+ * and then run, from its entry point, on a machine that persists for the session. Global variables, and the heap, survive between inputs;
+ * each input's variables are allocated following those of previous inputs.
+ *
+ * An input continues over multiple lines, until it compiles, or fails before its end; a blank
+ * line ends it regardless. ":quit", or the end of input, ends the session.
+ *
+ * The constant segment is reserved up front, as it can't grow under a live stack; its pages
+ * are only faulted in as used.
+ ************************************************************************************************/
+class Repl {
+public:
+	/// Construct a session...
+	Repl(unsigned fstoreSz = 3*1024, bool huge = false, size_t constSz = 64*1024);
+	virtual ~Repl() {}
+
+	/// Run the session...
+	unsigned operator()(std::istream& in, std::ostream& out);
+
+private:
+	PComp			comp;					///< The incremental compiler
+	InstrVector		code;					///< The code segment, so far, as compiled
+	ExtensiblePtr	program;				///< The code segment, as run; code, as of the last input
+	DatumVector		consts;					///< The constant segment, so far
+	PInterp			machine;				///< The live machine
+	size_t			constSize;				///< Reserved constant segment size, in Datums
+	size_t			loaded;					///< Number of constants written to the machine
+	size_t			frame;					///< The program blocks frame pointer
+	unsigned		nFailed;				///< Number of inputs that failed to compile, or run
+
+	/// Compile, and run, an input...
+	bool eval(const std::string& source, bool force, std::ostream& out);
+};
+
+#endif
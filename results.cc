@@ -33,6 +33,9 @@ ostream& operator<<(std::ostream& os, const Result result) {
 	case Result::freeStoreError:	os << "free-store error";		break;
 	case Result::outOfRange:		os << "out-of-range";			break;
 	case Result::illegalOp:			os << "illegal operation";		break;
+	case Result::badImage:			os << "bad image";				break;
+	case Result::breakpoint:		os << "breakpoint";				break;
+	case Result::ready:				os << "ready";					break;
 	case Result::halted:			os << "halted";					break;
 	default:
 		return os << "undefined result!";
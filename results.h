@@ -27,6 +27,9 @@ enum class Result {
 	freeStoreError,							///< Allocation or free error
 	outOfRange,								///< Attempt to index object with out-of-range index
 	illegalOp,								///< Illegal operation
+	badImage,								///< Startup image doesn't fit the machine
+	breakpoint,								///< Stopped at a breakpoint
+	ready,									///< Stopped at ready, for a startup snapshot
 	halted									///< Machine has halted
 };
 
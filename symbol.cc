@@ -45,6 +45,40 @@ SymValue SymValue::makeVar(int level, int offset, TDescPtr type) {
 	return SymValue(SymValue::Variable, level, Datum(offset), type, TDescPtrVec());
 }
 
+/********************************************************************************************//**
+ * @brief return a constant segment variable symbol value
+ *
+ * ConstVars have a type and a location, as an absolute address in the constant segment.
+ *
+ * @param level		The base/frame level, e.g., 0 for "current frame..
+ * @param addr		The variables location in the constant segment
+ * @param type  	the variables type descriptor
+ *
+ * @return a constant segment variable symbol value
+ ************************************************************************************************/
+SymValue SymValue::makeConstVar(int level, size_t addr, TDescPtr type) {
+	return SymValue(SymValue::ConstVar, level, Datum(addr), type, TDescPtrVec());
+}
+
+/********************************************************************************************//**
+ * @brief return a with statement record field symbol value
+ *
+ * WithFields have a type and a location, as an offset from the record address that the with
+ * statement saved in a frame slot.
+ *
+ * @param level		The base/frame level, e.g., 0 for "current frame..
+ * @param slot		The record address location as a offset from the activation frame
+ * @param offset	The fields offset from the start of the record
+ * @param type  	the fields type descriptor
+ *
+ * @return a with statement field symbol value
+ ************************************************************************************************/
+SymValue SymValue::makeWithField(int level, int slot, size_t offset, TDescPtr type) {
+	SymValue value(SymValue::WithField, level, Datum(offset), type, TDescPtrVec());
+	value._slot = slot;
+	return value;
+}
+
 /********************************************************************************************//**
  * @brief return a partially defined sub-routine.
  *
@@ -81,7 +115,7 @@ SymValue SymValue::makeType(int level, TDescPtr type) {
 /********************************************************************************************//**
  * @note kind() == None, i.e., a place holder for a real symbol
  ************************************************************************************************/
-SymValue::SymValue() : _kind{Kind::None}, _returned(false), _level{0} {}
+SymValue::SymValue() : _kind{Kind::None}, _returned(false), _external(false), _level{0}, _slot{0} {}
 
 /********************************************************************************************//**
  * @brief Construct a symbol value from it's components
@@ -93,7 +127,8 @@ SymValue::SymValue() : _kind{Kind::None}, _returned(false), _level{0} {}
  * @param params	SubRoutine parameter type array
  ************************************************************************************************/
 SymValue::SymValue(Kind kind, int level, const Datum& value, TDescPtr type, const TDescPtrVec& params)
-	: _kind{kind}, _returned(false), _level{level}, _value{value}, _type{type}, _params{params}
+	: _kind{kind}, _returned(false), _external(false), _level{level}, _value{value}, _type{type},
+	  _params{params}, _slot{0}
 {
 }
 
@@ -117,6 +152,16 @@ bool SymValue::returned(bool r)						{	return _returned = r;	}
  ************************************************************************************************/
 bool SymValue::returned() const						{	return _returned;		}
 
+/********************************************************************************************//**
+ * @return my new external value
+ ************************************************************************************************/
+bool SymValue::external(bool e)						{	return _external = e;	}
+
+/********************************************************************************************//**
+ * @return true if I'm an external subroutine
+ ************************************************************************************************/
+bool SymValue::external() const						{	return _external;		}
+
 /********************************************************************************************//**
  * @param value	New value
  * @return My new value.
@@ -139,6 +184,11 @@ TDescPtr SymValue::type(TDescPtr type)				{	return _type = type;	}
  ************************************************************************************************/
 TDescPtr SymValue::type() const						{	return _type;			}
 
+/********************************************************************************************//**
+ * @return My record address frame slot
+ ************************************************************************************************/
+int SymValue::slot() const							{	return _slot;			}
+
 /********************************************************************************************//**
  * Return subrountine paramer kinds, in order of declaractions.
  *
@@ -169,6 +219,8 @@ ostream& operator<<(std::ostream& os, const SymValue::Kind& kind) {
 	case SymValue::None:		os << "None";		break;
 	case SymValue::Variable:	os << "Variable";	break;
 	case SymValue::Constant:	os << "ConsInt";	break;
+	case SymValue::ConstVar:	os << "ConstVar";	break;
+	case SymValue::WithField:	os << "WithField";	break;
 	case SymValue::Procedure:	os << "Procedure";	break;
 	case SymValue::Function:	os << "Function";	break;
 	case SymValue::Type:		os << "Type";		break;
@@ -24,8 +24,13 @@
  * addition:
  * - A Varaible is a location, as an offset from the block/frame, n levels down, and a type.
  * - A Constant is just a Datum value and its type
+ * - A ConstVar is a structured (array or record) constant; a read-only location, as an absolute
+ *   address in the constant segment, and a type.
+ * - A WithField is a record field named by a with statement; an offset from the record address,
+ *   that is cached in a frame slot, and a type.
  * - Subroutines, Functions and Procedures, have an absolute entry point address and a vector of
- *   formal parameter types. Funcitons have a return type while Procedures are untyped.
+ *   formal parameter types. Funcitons have a return type while Procedures are untyped. External
+ *   subroutines have an External binding index in place of the entry point.
  * - A Type is a type descriptor in the type system.
  ************************************************************************************************/
 class SymValue {
@@ -35,6 +40,8 @@ public:
 		None,									///< Placeholder for a valid kind...
 		Variable,		  						///< A variable location and type
 		Constant,								///< A constant value and type
+		ConstVar,								///< A constant segment location and type
+		WithField,								///< A with statement record field offset and type
 		Procedure,								///< A procedure entry point
 		Function,								///< A function entry point and return type
 		Type									///< Entry in the type system
@@ -44,6 +51,8 @@ public:
 	
 	static SymValue makeConst(int level, const Datum& value, TDescPtr type);
 	static SymValue makeVar(int level, int ofset, TDescPtr type);
+	static SymValue makeConstVar(int level, size_t addr, TDescPtr type);
+	static SymValue makeWithField(int level, int slot, size_t offset, TDescPtr type);
 	static SymValue makeSbr(Kind kind, int level);
 	static SymValue makeType(int level, TDescPtr);
 
@@ -58,6 +67,9 @@ public:
 	bool returned(bool r);						///< Set, and return, my returned value
 	bool returned() const;						///< Return my returned value
 
+	bool external(bool e);						///< Set, and return, my external value
+	bool external() const;						///< Is this an external subroutine?
+
 	Datum value(Datum value);					///< Set, and return, my value
 	Datum value() const;						///< Return my value
 
@@ -67,13 +79,18 @@ public:
 	TDescPtr type(TDescPtr type);				///< Set and return my type
 	TDescPtr type() const;						///< Return my type
 
+	int slot() const;							///< Return my record address frame slot
+
 private:
 	Kind			_kind;						///< None, Variable, Procedure, Function or Type
 	bool			_returned;					///< Did the function return a value?
+	bool			_external;					///< An external subroutine; value is its binding
 	int				_level;						///< Block level (scope) for all types
-	Datum			_value;						///< Variable frame offset, Constant value or Subroutine address
+	Datum			_value;						///< Variable frame offset, Constant value, ConstVar or Subroutine address,
+												///< or WithField offset
 	TDescPtr		_type;						///< Type, n/a for Procedures
 	TDescPtrVec		_params;					///< Subroutine parameter kinds
+	int				_slot;						///< WithField record address frame slot
 };
 
 std::ostream& operator<<(std::ostream& os, const SymValue::Kind& kind);
@@ -0,0 +1,22 @@
+{ sum(n) is replaced, when linked with test/asmkernel.p.pasm, by a hand written kernel }
+
+program asmkernel() is
+
+function twice(x : integer) : integer is
+	begin
+		return x * 2
+	endfunc
+
+function sum(n : integer) : integer is
+	begin
+		if n = 0 then
+			return 0
+		else
+			return twice(n + sum(n - 1)) / 2
+		endif
+	endfunc
+
+begin
+	putln(sum(10));
+	putln(sum(100))
+endprog
@@ -0,0 +1,28 @@
+{ Two assembly files linked in turn; test/asmlink.p.pasm replaces sum(n), and
+  test/asmlink.p.total.pasm replaces total(n) with one that calls the replaced sum(n) }
+
+program asmlink() is
+
+function twice(x : integer) : integer is
+	begin
+		return x * 2
+	endfunc
+
+function sum(n : integer) : integer is
+	begin
+		if n = 0 then
+			return 0
+		else
+			return twice(n + sum(n - 1)) / 2
+		endif
+	endfunc
+
+function total(n : integer) : integer is
+	begin
+		return 0
+	endfunc
+
+begin
+	putln(total(10));
+	putln(total(100))
+endprog
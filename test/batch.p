@@ -0,0 +1,16 @@
+{ Batch runs; each record is a pair of integers, a and b }
+program Batch() is
+var
+	a : integer;
+	b : integer;
+	p : ^integer;
+
+begin
+	new(p);							{ never disposed; each run starts with an empty heap }
+	get(a);
+	get(b);
+	p^ := a * b;
+	put(a + b, 6);
+	put(p^, 6);
+	putln(a / b, 6)
+endprog
@@ -0,0 +1,14 @@
+{ Batch runs are independent; seen is zero at the start of each, as in a single run }
+program BatchState() is
+var
+	seen : integer;
+	n : integer;
+
+begin
+	get(n);
+	if seen <> 0 then
+		putln(seen)
+	endif;
+	seen := n;
+	putln(n, 4)
+endprog
@@ -0,0 +1,45 @@
+{ A static code report; sizes, instruction mix, checks, frames and stack depth, per subroutine }
+program CodeReport() is
+type
+	Index is 1..10;
+	Vector is array [Index] of integer;
+	Node is record
+		key, value : integer
+	end;
+
+var
+	v : Vector;
+	i : Index;
+	p : ^Node;
+
+{ Sum of squares of v[lo..hi] }
+function sumsq(lo, hi : Index) : integer is
+var
+	k : integer;
+	s : integer;
+begin
+	s := 0;
+	k := lo;
+	while k <= hi loop
+		s := s + v[k] * v[k];
+		k := k + 1
+	endloop;
+	return s
+endfunc
+
+procedure show(n : integer; width : integer) is
+begin
+	putln(n, width + 2)
+endproc
+
+begin
+	for i in Index loop
+		v[i] := i
+	endloop;
+
+	new(p);
+	p^.key := 1;
+	p^.value := sumsq(1, 10);
+	show(p^.value, 4);
+	dispose(p)
+endprog
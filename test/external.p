@@ -0,0 +1,43 @@
+{ External, C library, subroutines }
+program Externals() is
+type
+	Name is array [1..5] of character;
+	Pair is array [1..2] of integer;
+
+var
+	e : integer;
+	m : real;
+	s : Name;
+	fds : Pair;
+
+function hypot(x, y : real) : real is external "libm.so.6"
+function power(x, y : real) : real is external "libm.so.6", "pow"
+function frexp(x : real; var ex : integer) : real is external "libm.so.6"
+function labs(n : longint) : longint is external ""
+function strlen(s : Name) : integer is external ""
+function toupper(c : character) : character is external ""
+function pipe(var fds : Pair) : integer is external ""
+function close(fd : integer) : integer is external ""
+
+begin
+	putln(hypot(3.0, 4.0), 8, 4);
+	putln(power(2, 10), 8, 1);
+
+	m := frexp(48.0, e);
+	put(m, 8, 4);
+	putln(e, 4);
+
+	putln(labs(-5000000000));
+
+	s := "hello";
+	putln(strlen(s));
+	putln(toupper('p'));
+
+	fds[1] := -1;
+	fds[2] := -1;
+	put(pipe(fds), 4);
+	put(fds[1] > 2, 6);
+	putln(fds[2] - fds[1], 4);
+	put(close(fds[1]), 4);
+	putln(close(fds[2]), 4)
+endprog
@@ -0,0 +1,42 @@
+{ Counted for loops over integer, character, boolean and enumeration ranges, up and down }
+program ForLoop() is
+type
+	Color is (Red, Green, Blue);
+	Digit is 0..9;
+var
+	c : character;
+	b : boolean;
+	k : Color;
+	l : longint;
+	i : integer;
+	n : integer;
+
+begin
+	n := 0;									{ every character, 'A' is the 65th }
+	for c in character loop
+		if n = 65 then put(c) endif;
+		if n = 122 then putln(c) endif;
+		n := n + 1
+	endloop;
+	putln(n);
+
+	for c in reverse character loop
+		n := n - 1;
+		if n = 90 then putln(c) endif
+	endloop;
+
+	for b in boolean loop putln(b) endloop;
+	for b in reverse boolean loop putln(b) endloop;
+
+	for k in Color loop put(ord(k), 2) endloop;
+	for k in reverse Color loop put(ord(k), 2) endloop;
+	putln(' ');
+
+	for l in 1..3 loop l := l * 2; put(l, 3) endloop;	{ the iterator may be assigned }
+	putln(' ');
+
+	for i in reverse Digit loop
+		for k in Color loop put(i * 10 + ord(k), 4) endloop
+	endloop;
+	putln(' ')
+endprog
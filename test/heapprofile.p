@@ -0,0 +1,40 @@
+{ A heap allocation-site profile; counts, and sizes, by site. Every block is disposed, as the
+  never disposed list gives heap addresses, which depend on the page size }
+program HeapProfile() is
+type
+	Pair is record
+		a, b : integer
+	end;
+	PairPtr is ^Pair;
+
+var
+	i : integer;
+	p : PairPtr;
+	keep : PairPtr;
+
+{ Allocations escape through the result, so they're made on the heap }
+function make(n : integer) : PairPtr is
+var
+	r : PairPtr;
+begin
+	new(r);
+	r^.a := n;
+	r^.b := n * n;
+	return r
+endfunc
+
+begin
+	for i in 1..10 loop
+		p := make(i);
+		dispose(p)
+	endloop;
+
+	keep := make(1);
+	for i in 2..3 loop
+		p := keep;
+		keep := make(i);
+		dispose(p)
+	endloop;
+	putln(keep^.b);
+	dispose(keep)
+endprog
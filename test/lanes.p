@@ -0,0 +1,41 @@
+{ Batch records run four at a time, in lockstep; each record takes its own path through the
+  loops, and the recursion, and a record that divides by zero stops just its own lane }
+program Lanes() is
+var
+	n, steps, i : integer;
+	k : 1..3;
+
+function fact(n : integer) : integer is
+begin
+	if n <= 1 then
+		return 1
+	else
+		return n * fact(n - 1)
+	endif
+endfunc
+
+begin
+	get(n);
+	steps := 0;
+	i := n;
+	while i > 1 loop
+		if i mod 2 = 0 then
+			i := i / 2
+		else
+			i := 3 * i + 1
+		endif;
+		steps := steps + 1
+	endloop;
+
+	put("collatz ");
+	put(n, 3);
+	put(steps, 4);
+	put(fact(n mod 8), 6);
+	for k in 1..3 loop
+		if k <= n mod 4 then
+			put('*')
+		endif
+	endloop;
+	putln(sqrt(n), 8, 3);
+	putln(100 / (n - 5))
+endprog
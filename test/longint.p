@@ -0,0 +1,38 @@
+program LongInts() is
+const
+	big = 10000000000;
+
+var
+	c : longint = 1;
+	s : longint;
+	i, n : integer;
+	r : real;
+
+begin
+	putln(big);
+	putln(longint`max);
+	putln(longint`min);
+
+	for i in 1..40 loop
+		c := c * 2
+	endloop;
+	putln(c);
+
+	s := 0;									{ a checksum, modulo a prime > 2^32 }
+	for i in 1..1000 loop
+		s := (s * 31 + i) mod 1000000000039
+	endloop;
+	putln(s);
+
+	putln(c > big);
+	putln(c bor 1);
+	putln(c sright 20);
+	putln(abs(-c));
+	putln(odd(c + 1));
+
+	r := c;
+	putln(r);
+
+	n := c sright 20;
+	putln(n)
+endprog
@@ -0,0 +1,28 @@
+{ Live metrics; published to objs/metrics.p.snapshot, without changing the output }
+program Metrics() is
+var
+	p : ^integer;
+	i : integer;
+	sum : integer;
+
+	function fib(n : integer) : integer is
+	begin
+		if n < 2 then
+			return n
+		else
+			return fib(n - 1) + fib(n - 2)
+		endif
+	endfunc
+
+begin
+	sum := 0;
+	for i in 1..10 loop
+		new(p);
+		p^ := fib(i);
+		put(p^, 4);
+		sum := sum + p^;
+		dispose(p)
+	endloop;
+	putln(' ');
+	putln(sum)
+endprog
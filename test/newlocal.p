@@ -0,0 +1,52 @@
+{ Frame allocation of new'd objects that don't escape their procedure }
+program NewLocal() is
+type
+	Node is record
+		key, value : integer
+	end;
+
+var
+	g : ^Node;
+	i : integer;
+
+{ t doesn't escape, so t^ is allocated in sum's activation frame }
+function sum(n : integer) : integer is
+var
+	t : ^Node;
+	j : integer;
+begin
+	new(t);
+	t^.key := 0;
+	t^.value := 0;
+	for j in 1..10 loop
+		with t^ do
+			key := key + 1;
+			value := value + key * n
+		end
+	endloop;
+	j := t^.value;
+	dispose(t);
+	return j
+endfunc
+
+{ u escapes via g, so u^ is allocated on the heap }
+procedure keep(n : integer) is
+var
+	u : ^Node;
+begin
+	new(u);
+	u^.key := n;
+	u^.value := n * n;
+	g := u
+endproc
+
+begin
+	for i in 1..3 loop
+		putln(sum(i))
+	endloop;
+
+	keep(7);
+	put(g^.key);
+	putln(g^.value);
+	dispose(g)
+endprog
@@ -0,0 +1,13 @@
+{ Opcode n-gram profile; sum the first 100 integers }
+program Ngrams() is
+var
+	i : integer;
+	sum : integer;
+
+begin
+	sum := 0;
+	for i in 1..100 loop
+		sum := sum + i
+	endloop;
+	putln(sum)
+endprog
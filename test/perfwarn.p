@@ -0,0 +1,58 @@
+program PerfWarnings() is
+type
+	Vector is array [1..20] of integer;
+	Ptr is ^integer;
+
+var
+	v : Vector;
+	i : integer;
+	r : real;
+	p, q, t : Ptr;
+
+function sum(a : Vector) : integer is
+var	s, j : integer;
+begin
+	s := 0;
+	for j in 1..20 loop
+		s := s + a[j]
+	endloop;
+	return s
+endfunc
+
+procedure outer() is
+	procedure middle() is
+		procedure inner() is
+		begin
+			for i in 1..3 loop
+				v[i] := v[i] + 1
+			endloop
+		endproc
+	begin
+		inner()
+	endproc
+begin
+	middle()
+endproc
+
+begin
+	for i in 1..20 loop
+		v[i] := i
+	endloop;
+
+	r := 0.0;
+	for i in 1..20 loop
+		r := r + i;
+		new(t);						{ allocated in the frame, so no warning }
+		t^ := i;
+		dispose(t);
+
+		new(q);						{ q escapes, so it's a free store allocation }
+		q^ := i;
+		p := q;
+		dispose(q)
+	endloop;
+
+	outer();
+	putln(sum(v));
+	putln(r)
+endprog
@@ -0,0 +1,44 @@
+{ Interprocedural constant, and range, propagation into subroutines }
+program Propagate() is
+type
+	Index is 1..8;
+
+var
+	table : array [Index] of integer;
+	i : integer;
+	sum : integer;
+
+{ Every call passes the same stride, so the multiply goes }
+function scale(n : integer; stride : integer) : integer is
+begin
+	return n * stride
+endfunc
+
+{ Every caller checks k, so the index checks go }
+function fetch(k : Index) : integer is
+begin
+	return table[k]
+endfunc
+
+{ Called with differing constants; cloned, and folded, for the common ones }
+function offset(base, step : integer) : integer is
+begin
+	return base * step + step * 2 - 1
+endfunc
+
+begin
+	for i in Index loop
+		table[i] := scale(i, 1)
+	endloop;
+
+	sum := 0;
+	for i in Index loop
+		sum := sum + fetch(i)
+	endloop;
+
+	putln(scale(sum, 1));
+	putln(offset(3, 4));
+	putln(offset(3, 4));
+	putln(offset(5, 10));
+	putln(offset(sum, 10))
+endprog
@@ -0,0 +1,58 @@
+{ Sieve a table of primes, on the heap, then mark the program ready; a startup image, taken
+  with --snapshot-at-ready, continues from there without sieving }
+program Ready() is
+const
+	Max = 100;
+
+type
+	Index is 2..100;
+	Table is record
+		prime : array [Index] of boolean;
+		count : integer
+	end;
+
+var
+	t : ^Table;
+	i, j, n : integer;
+
+begin
+	new(t);
+	for i in Index loop
+		t^.prime[i] := true
+	endloop;
+
+	i := 2;
+	while i * i <= Max loop
+		if t^.prime[i] then
+			j := i * i;
+			while j <= Max loop
+				t^.prime[j] := false;
+				j := j + i
+			endloop
+		endif;
+		i := i + 1
+	endloop;
+
+	t^.count := 0;
+	for i in Index loop
+		if t^.prime[i] then
+			t^.count := t^.count + 1
+		endif
+	endloop;
+
+	ready;
+
+	n := 0;
+	for i in Index loop
+		if t^.prime[i] then
+			n := n + 1;
+			if n mod 5 = 0 then
+				putln(i, 4)
+			else
+				put(i, 4)
+			endif
+		endif
+	endloop;
+	putln(t^.count);
+	dispose(t)
+endprog
@@ -0,0 +1,38 @@
+{ A startup image resumed for each record; externals are bound again, and neither the stack
+  above sp, nor the free blocks, keep the previous record's values }
+program Snapshot() is
+type
+	Cell is record
+		value : integer
+	end;
+	CellPtr is ^Cell;
+
+var
+	big : longint;
+	c : CellPtr;
+	n : integer;
+
+function labs(n : longint) : longint is external ""
+
+procedure show(n : integer) is
+var
+	local : integer;
+begin
+	put(local, 4);
+	local := n
+endproc
+
+begin
+	big := labs(-5000000000);
+	new(c);
+	dispose(c);
+	ready;
+
+	get(n);
+	new(c);
+	put(c^.value, 4);
+	c^.value := n;
+	show(n);
+	putln(labs(n - big), 12);
+	dispose(c)
+endprog
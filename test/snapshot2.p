@@ -0,0 +1,23 @@
+{ Two startup images; the first taken at the first ready, and the second from the first image,
+  at the second ready }
+program Snapshot2() is
+var
+	stage : integer;
+	total : integer;
+	n : integer;
+
+begin
+	putln("stage 1");
+	stage := 1;
+	total := 10;
+	ready;
+
+	putln("stage 2");
+	stage := 2;
+	total := total * 10;
+	ready;
+
+	get(n);
+	put(stage, 4);
+	putln(total + n, 6)
+endprog
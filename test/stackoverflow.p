@@ -0,0 +1,12 @@
+{ Unbounded recursion runs into the guard page following the stack }
+
+program stackoverflow() is
+
+function depth(n : integer) : integer is
+	begin
+		return depth(n + 1)
+	endfunc
+
+begin
+	putln(depth(0))
+endprog
@@ -0,0 +1,51 @@
+{ Typed constants, and initialized variables }
+program TypedConsts() is
+const
+	max : integer = 10;
+	pi : real = 3;
+	primes : array [1..4] of integer = (2, 3, 5, 7);
+	origin : record x, y : real end = (0.5, -1.5);
+	hello : array [1..5] of character = "hello";
+
+type
+	Vec is array [1..4] of integer;
+	Point is record
+		x, y : real
+	end;
+
+var
+	i : integer;
+	sum : integer = 0;
+	v : Vec = (1, 2, 3, 4);
+	p : Point = (1.0, 2.0);
+
+procedure show(n : integer) is
+var
+	k : integer = 5;
+begin
+	k := k + n;
+	putln(k)
+endproc
+
+begin
+	for i in 1..4 loop
+		sum := sum + primes[i] * v[i]
+	endloop;
+	putln(sum);
+
+	putln(origin.x, 6, 2);
+	putln(origin.y, 6, 2);
+	putln(pi, 8, 4);
+	putln(max);
+	putln(hello);
+
+	v[1] := 11;
+	putln(v[1]);
+	putln(primes[1]);
+
+	p.y := origin.y;
+	putln(p.y, 6, 2);
+
+	show(1);
+	show(2)
+endprog
@@ -0,0 +1,10 @@
+{ Variables that are never assigned read as zero; the data segment is zero filled }
+program Uninit() is
+var
+	n : integer;
+	x : integer;
+begin
+	x := 4;
+	n := n + x;
+	putln(n)
+endprog
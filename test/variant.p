@@ -0,0 +1,46 @@
+{ Test variant records; the variants share storage }
+program VariantTests() is
+type
+	Kind is (Leaf, Node);
+	Tree is record
+		kind : Kind;
+		case Kind of
+			Leaf : (value : integer);
+			Node : (left, right : integer; weight : real)
+	end;
+	Shape is record
+		name : character;
+		case tag : integer of
+			0 : ();
+			1, 2 : (radius : real);
+			3 : (width, height : integer)
+	end;
+
+var
+	t : Tree;
+	s : Shape;
+
+begin
+	t.kind := Leaf;
+	t.value := 42;
+	putln(t.value);
+	putln(t.left);					{ shares storage with value }
+
+	t.kind := Node;
+	t.left := 1;
+	t.right := 2;
+	t.weight := 0.5;
+	putln(t.value);
+	putln(t.right);
+	putln(t.weight, 8, 4);
+
+	with s do
+		name := 'r';
+		tag := 3;
+		width := 10;
+		height := 20
+	end;
+	putln(s.name);
+	putln(s.tag);
+	putln(s.width * s.height)
+endprog
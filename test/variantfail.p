@@ -0,0 +1,16 @@
+{ A variant field may not have the same name as the tag field }
+program VariantFail() is
+type
+	R is record
+		case k : integer of
+			0 : (k : real);
+			1 : (n : integer)
+	end;
+
+var
+	r : R;
+
+begin
+	r.k := 1;
+	putln(r.k)
+endprog
@@ -0,0 +1,59 @@
+{ With statement tests }
+program WithTest() is
+type
+	Point is record
+		x, y : integer
+	end;
+	Rect is record
+		tl, br : Point;
+		name : character
+	end;
+
+var
+	i, x : integer;
+	r : Rect;
+	t : array [0..2] of Rect;
+
+function area() : integer is
+var	w : integer;
+begin
+	with r.tl, r.br do
+		put(x); put(y); putln()
+	end;
+	with r.br do
+		w := x - r.tl.x;
+		return w * (y - r.tl.y)
+	end
+endfunc
+
+begin
+	x := 42;
+	with r do
+		name := 'r';
+		with tl do
+			x := 1;
+			y := 2
+		end;
+		with br do
+			x := 4;
+			y := 6
+		end
+	end;
+	putln(x);
+	putln(r.name);
+	putln(area());
+
+	for i in 0..2 loop
+		with t[i], t[i].tl, t[i].br do
+			name := 'a';
+			x := i;
+			y := i * 2
+		end
+	endloop;
+
+	for i in 0..2 loop
+		with t[i].br do
+			put(x); putln(y)
+		end
+	endloop
+endprog
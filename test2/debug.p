@@ -0,0 +1,15 @@
+{ Debug a program that reads its standard input; the debugger reads its commands from
+  debug.p.dbg, so the two don't interleave }
+program Debug() is
+var
+	i, sum : integer;
+	n : integer;
+
+begin
+	sum := 0;
+	for i in 1..3 loop
+		get(n);
+		sum := sum + n
+	endloop;
+	putln(sum)
+endprog
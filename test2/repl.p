@@ -0,0 +1,5 @@
+{ An interactive session; run with --repl, reading repl.p.in, rather than this program }
+program Repl() is
+begin
+	putln("see repl.p.in")
+endprog
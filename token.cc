@@ -12,6 +12,7 @@
 #include "token.h"
 
 #include <iostream>
+#include <limits>
 #include <sstream>
 
 using namespace std;
@@ -138,8 +139,14 @@ Token TokenStream::get() {
 		std::istringstream iss (ct.string_value);
 		if (Token::RealNum == ct.kind)
 			iss >> ct.real_value;
-		else
-			iss >> ct.integer_value;
+
+		else {								// An integer, unless it's too large
+			iss >> ct.longint_value;
+			if (ct.longint_value > std::numeric_limits<int>::max())
+				ct.kind = Token::LongIntNum;
+			else
+				ct.integer_value = ct.longint_value;
+		}
 		return ct;
 	}
 	
@@ -198,6 +205,8 @@ void TokenStream::set_input(std::istream& s) {
 	ip = &s;
 	owns = false;
 	lineNum = 1;
+	line.clear();							// Forget any of the previous stream's line
+	col = 0;
 }
 
 /**
@@ -209,6 +218,8 @@ void TokenStream::set_input(std::istream* p) {
 	ip = p;
 	owns = true;
 	lineNum = 1;
+	line.clear();							// Forget any of the previous stream's line
+	col = 0;
 }
 
 // privite static
@@ -223,8 +234,10 @@ TokenStream::KeywordTable	TokenStream::keywords = {
 	{	"bnot",			Token::BitNot		},
 	{	"bor",			Token::BitOr		},
 	{	"bxor",			Token::BitXor		},
+	{	"case",			Token::Case			},
 	{   "const",		Token::ConsDecl		},
 	{	"dispose",		Token::Dispose		},
+	{	"do",			Token::Do			},
 	{	"elif",			Token::Elif			},
 	{	"else",			Token::Else			},
 	{	"end",			Token::End			},
@@ -234,6 +247,7 @@ TokenStream::KeywordTable	TokenStream::keywords = {
 	{	"endproc",		Token::Endproc		},
 	{	"endprog",		Token::Endprog		},
 	{	"exp",			Token::Exp			},
+	{	"external",		Token::External		},
 	{	"function",		Token::FuncDecl		},
 	{	"get",			Token::Get			},
 	{	"if",			Token::If			},
@@ -250,6 +264,7 @@ TokenStream::KeywordTable	TokenStream::keywords = {
 	{	"program",		Token::ProgDecl		},
 	{	"procedure",	Token::ProcDecl		},
 	{	"pred",			Token::Pred			},
+	{	"ready",		Token::Ready		},
 	{	"record",		Token::Record		},
 	{	"repeat",		Token::Repeat		},
 	{	"return",		Token::Return		},
@@ -268,6 +283,7 @@ TokenStream::KeywordTable	TokenStream::keywords = {
 	{	"for",			Token::For			},
 	{	"var",			Token::VarDecl		},
 	{	"while",		Token::While		},
+	{	"with",			Token::With			},
 	{	"put",			Token::Put			},
 	{	"putln",		Token::Putln		}
 };
@@ -290,6 +306,7 @@ ostream& operator<<(std::ostream& os, const Token::Kind& kind) {
 	case Token::Character:	os << "character";		break;
 	case Token::String:		os << "string";			break;
 	case Token::IntegerNum:	os << "integernum";		break;
+	case Token::LongIntNum:	os << "longintnum";		break;
 	case Token::RealNum:	os << "RealNum";		break;
 
 	case Token::ConsDecl:	os << "const";			break;
@@ -319,6 +336,9 @@ ostream& operator<<(std::ostream& os, const Token::Kind& kind) {
 	case Token::Until:		os << "until";			break;
 	case Token::For:		os << "for";			break;
 	case Token::Is:			os << "is";				break;
+	case Token::External:	os << "external";		break;
+	case Token::With:		os << "with";			break;
+	case Token::Do:			os << "do";				break;
 
 	case Token::Ellipsis:	os << "..";				break;
 	case Token::Caret:		os << "^";				break;
@@ -326,6 +346,7 @@ ostream& operator<<(std::ostream& os, const Token::Kind& kind) {
 	case Token::Array:		os << "array";			break;
 	case Token::Of:			os << "of";				break;
 	case Token::Record:		os << "record";			break;
+	case Token::Case:		os << "case";			break;
 
 	case Token::LT:			os << "<";				break;
 	case Token::LTE:		os << "<=";				break;
@@ -378,6 +399,7 @@ ostream& operator<<(std::ostream& os, const Token::Kind& kind) {
 	case Token::Putln:		os << "putln";			break;
 	case Token::New:		os << "new";			break;
 	case Token::Dispose:	os << "dispose";		break;
+	case Token::Ready:		os << "ready";			break;
 
 	case Token::EOS:		os << "EOS";			break;
 
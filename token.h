@@ -40,6 +40,7 @@ struct Token {
 		Character,						///< A single character, e.g., string_value[0] = 'c'
 		String,							///< A string (string_value), "string"
 		IntegerNum,						///< Integer literal number (integer_value)
+		LongIntNum,						///< Long integer literal number (longint_value)
 		RealNum,						///< Real literal number (real_value)
 
 		ConsDecl,						///< "const" constant declaration
@@ -69,6 +70,9 @@ struct Token {
 		Until,							///< "until"
 		For,							///< "for"
 		Is,								///< "is"
+		External,						///< "is" "external"
+		With,							///< "with" ... "do"
+		Do,								///< "do"
 
 		Ellipsis,						///< ".."
 		Caret,							///< "^"
@@ -76,6 +80,7 @@ struct Token {
 		Array,							///< "array"
 		Of,								///< "of"
 		Record,							///< "record ... end"
+		Case,							///< "case" ... "of", a record variant part
 
 		LT,								///< Less than
 		LTE,							///< Less than or equal? (<=)
@@ -133,6 +138,7 @@ struct Token {
 		Putln,							///< Write on standard output, plus newline
 		New,							///< Allocate dynamic store
 		Dispose,						///< Free allocated dynamic store
+		Ready,							///< Initialized; take a startup snapshot here
 
 		Assign,							///< Assignment (:=)
 		Mod,							///< Modulus (remainder)
@@ -147,10 +153,11 @@ struct Token {
 	Kind			kind;				///< Token type
 	std::string		string_value;		///< kind == Identifier, or String or Character
 	int				integer_value;      ///< Kind == IntegerNum
+	int64_t			longint_value;		///< Kind == LongIntNum
 	double			real_value;			///< Kind == RealNum
 
 	/// Construct a token of type k, stirng value "", number value 0.
-	Token(Kind k) : kind{k}, integer_value{0}, real_value{0.0} {}
+	Token(Kind k) : kind{k}, integer_value{0}, longint_value{0}, real_value{0.0} {}
 	virtual ~Token() {}					///< Destructor
 };
 
@@ -20,9 +20,10 @@ using namespace std;
  * @brief Constructor
  * @param	name	The fields name
  * @param	type	The fields type, e.g., "Integer" or "T"
+ * @param	offset	The fields offset from the start of its record
  ****************************************************************************/
-Field::Field(const std::string& name, TDescPtr type)
-	: _name{name}, _type{type} {
+Field::Field(const std::string& name, TDescPtr type, size_t offset)
+	: _name{name}, _type{type}, _offset{offset} {
 }
 
 /********************************************************************************************//**
@@ -35,6 +36,11 @@ const std::string& Field::name() const			{	return _name;	}
  ************************************************************************************************/
 TDescPtr Field::type() const					{	return _type;	}
 
+/********************************************************************************************//**
+ * @return my offset, in Datums, from the start of my record
+ ************************************************************************************************/
+size_t Field::offset() const					{	return _offset;	}
+
 // operators
 
 /********************************************************************************************//**
@@ -59,8 +65,9 @@ bool operator<(const Field& lhs, const Field& rhs) {
  * @return true if lhs == rhs
  ************************************************************************************************/
 bool operator==(const Field& lhs, const Field& rhs) {
-	return	lhs.name()	== rhs.name()	&&
-			lhs.type()	== rhs.type();
+	return	lhs.name()		== rhs.name()	&&
+			lhs.type()		== rhs.type()	&&
+			lhs.offset()	== rhs.offset();
 }
 
 /********************************************************************************************//**
@@ -131,6 +138,25 @@ TDescPtr TypeDesc::newIntDesc(const Subrange& range, bool ref) {
 								ref));
 }
 
+/********************************************************************************************//**
+ * Long integers are 64-bit, so they're not ordinals, whose ranges are limited to those of an
+ * Integer.
+ *
+ * @param	ref			Type is passed by reference
+ *
+ * @return TDescPtr to a new LongDesc
+ ************************************************************************************************/
+TDescPtr TypeDesc::newLongDesc(bool ref) {
+	return TDescPtr(new TypeDesc(LongInt,
+								1,
+								Subrange(),
+								TDescPtr(),
+								FieldVec(),
+								TDescPtr(),
+								false,
+								ref));
+}
+
 /********************************************************************************************//**
  * @param	ref			Type is passed by reference
  *
@@ -385,6 +411,7 @@ std::ostream& operator<<(std::ostream& os, TypeDesc::TypeClass tclass) {
 	case TypeDesc::Character:	os << "character";		break;
 	case TypeDesc::Enumeration:	os << "enumeration";	break;
 	case TypeDesc::Integer:		os << "integer";		break;
+	case TypeDesc::LongInt:		os << "longint";		break;
 	case TypeDesc::Pointer:		os << "pointer";		break;
 	case TypeDesc::Real:		os << "real";			break;
 	case TypeDesc::Record:		os << "record";			break;
@@ -41,19 +41,26 @@ typedef std::vector<TDescPtr>			TDescPtrVec;
 class Field {
 	std::string	_name;					///< The fields name
 	TDescPtr	_type;					///< The fields type
+	size_t		_offset;				///< The fields offset into its record
 
 public:
-	Field() {}							///< Default constructor
-	Field(const std::string& name, TDescPtr type);
+	Field() : _offset{0} {}				///< Default constructor
+	Field(const std::string& name, TDescPtr type, size_t offset = 0);
 	virtual ~Field() {}					///< Destructor
 
 	const std::string& name() const;	///< Return the field name
 	TDescPtr type() const;				///< Return the field type
+	size_t offset() const;				///< Return the field offset
 
 	/// Set my name...
 	void name(const std::string& name) {
 		_name = name;
 	}
+
+	/// Set my offset...
+	void offset(size_t offset) {
+		_offset = offset;
+	}
 };
 
 bool operator<(const Field& lhs, const Field& rhs);
@@ -78,6 +85,7 @@ typedef std::vector<Field>	FieldVec;
  * | Character  | 1  |      0..127    |  -  |  - |  -   |   Y   |
  * | Enumeration| 1  |      X..Y      |  -  |  - |  -   |   Y   |
  * | Integer	| 1  |INT_MIN..INT_MAX|  -  |  - |  -   |   Y   |
+ * | LongInt    | 1  |       -        |  -  |  - |  -   |   N   |
  * | Pointer    | 1  |       -        |  -  |  T |  -   |   N   |
  * | Real       | 1  |       -        |  -  |  - |  -   |   N   |
  * | Record     | N  |       -        |  -  |  - |Fields|   N   |
@@ -96,6 +104,7 @@ public:
 		Character,
 		Enumeration,
 		Integer,
+		LongInt,
 		Pointer,
 		Real,
 		Record
@@ -109,6 +118,9 @@ public:
 	/// Create, and return, a TDescPtr to a new IntDesc
 	static TDescPtr newIntDesc(const Subrange& range = maxRange, bool ref = false);
 
+	/// Create, and return, a TDescPtr to a new LongDesc
+	static TDescPtr newLongDesc(bool ref = false);
+
 	/// Create, and return, a TDescPtr to a new RealDesc
 	static TDescPtr newRealDesc(bool ref = false);
 
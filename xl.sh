@@ -0,0 +1,18 @@
+#!/bin/bash
+# Run every test program in lockstep, optimized against unoptimized, stopping at the first divergence,
+# or failure; programs whose listing shows a compile error are expected to fail
+for i in $( ls test/*.p test2/*.p ); do
+	if [ -f $i.in ]; then in=$i.in; else in=/dev/null; fi
+	opts=""
+	if [ -f $i.pasm ]; then opts="--asm=$i.pasm"; fi
+	./p --lockstep $opts $i < $in &> objs/lockstep.out
+	status=$?
+	if [ "$status" != "0" ] && grep "^$i: .* near line [0-9]*$" $i.lst | grep -qv ": performance: "; then
+		continue
+	fi
+	if [ "$status" != "0" ] || grep -q "diverged" objs/lockstep.out; then
+		echo "$i: exit status $status"
+		cat objs/lockstep.out
+		exit 1
+	fi
+done
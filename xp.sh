@@ -1,11 +1,31 @@
 #!/bin/bash
 for i in $( ls test/*.p ); do
 	s=$(basename $i)
-	./p -l $i &> objs/$s.lst
+	opts=""
+	if [ -f $i.pasm ]; then opts="--asm=$i.pasm"; fi
+	if [ -f $i.opts ]; then opts="$opts $(cat $i.opts)"; fi
+	./p -l $opts $i &> objs/$s.lst
 	cmp objs/$s.lst $i.lst
 	if [ "$?" != "0" ]; then
 		diff objs/$s.lst $i.lst
 		exit
 	fi
+	if [ -f $i.snap ]; then
+		./p --snapshot-at-ready=objs/$s.img $i > /dev/null
+		./p $(cat $i.snap) objs/$s.img &> objs/$s.img.lst
+		cmp objs/$s.img.lst $i.img.lst
+		if [ "$?" != "0" ]; then
+			diff objs/$s.img.lst $i.img.lst
+			exit
+		fi
+		if [ -f $i.snap2 ]; then
+			./p --snapshot-at-ready=objs/$s.2.img objs/$s.img > /dev/null
+			./p $(cat $i.snap2) objs/$s.2.img &> objs/$s.img2.lst
+			cmp objs/$s.img2.lst $i.img2.lst
+			if [ "$?" != "0" ]; then
+				diff objs/$s.img2.lst $i.img2.lst
+				exit
+			fi
+		fi
+	fi
 done
-